@@ -0,0 +1,630 @@
+/**
+ * @file    bench.c
+ * @brief   性能对比测试程序
+ *
+ * 本文件用于在目标板上对比各模块优化前后的性能，独立于 main 程序编译：
+ *   make bench && ./bench [测试文件路径]
+ *
+ * 当前包含：
+ *  - bench_file_read : _file_read/_file_pread 默认模式、缓存模式（FILE_OP_CACHE）、
+ *                      映射模式（_file_view）与裸 read() 的对比；
+ *  - bench_log       : 原 _log_write 实现（access + _file_write）与当前同步/异步/分线程暂存模式、
+ *                      二进制格式的每秒日志行数对比，以及被限速调用点的单次开销；
+ *  - bench_steal     : fork-join 求和在 work-stealing 执行器（递归 spawn/sync）与
+ *                      互斥锁任务队列线程池（按块提交 + future 等待）上的耗时对比；
+ *  - bench_stack     : 线程创建 + join 的耗时与每线程缺页次数，glibc 分配栈与栈池栈的对比。
+ *
+ * @note
+ * - 默认模式每次调用都会打印 PRINT_FILE_INFO，测试期间标准输出被重定向到 /dev/null；
+ * - 计时使用 _time_get_timestamp()（CLOCK_MONOTONIC）。
+ */
+#include "file.h"
+#include "log.h"
+#include "thread_pool.h"
+#include "thread_steal.h"
+#include <sys/resource.h>
+
+#define BENCH_FILE        ("./bench.dat")     ///< 默认测试文件
+#define BENCH_FILE_SIZE   (4 * 1024 * 1024)   ///< 测试文件大小
+#define BENCH_BLOCK       (4096)              ///< 单次读写块大小
+#define BENCH_LOG_FILE    ("./bench.log")     ///< 日志测试文件
+#define BENCH_LOG_LINES   (100000)            ///< 日志测试行数
+#define BENCH_TASK_ELEMS  (1 << 22)           ///< fork-join 测试数组元素数
+#define BENCH_TASK_REPS   (5)                 ///< fork-join 测试重复次数
+#define BENCH_TASK_WORKERS (4)                ///< 两种执行器的工作线程数
+#define BENCH_STACK_SIZE  (2 * 1024 * 1024)   ///< 线程创建测试的栈大小
+#define BENCH_STACK_TOUCH (512 * 1024)        ///< 每个线程实际使用的栈深度
+#define BENCH_STACK_THREADS (2000)            ///< 线程创建测试的线程数
+
+static int __stdout_fd = -1;
+
+/**
+ * @func   bench_quiet
+ * @brief  屏蔽/恢复标准输出，避免被测函数的打印淹没测试结果
+ *
+ * @param[in] __on  1：重定向到 /dev/null；0：恢复
+ */
+static void bench_quiet(int __on)
+{
+    fflush(stdout);
+    if(__on)
+    {
+        int __nfd = open("/dev/null" ,O_WRONLY);
+        if(__nfd == -1)
+            return;
+        __stdout_fd = dup(STDOUT_FILENO);
+        dup2(__nfd ,STDOUT_FILENO);
+        close(__nfd);
+    }
+    else if(__stdout_fd != -1)
+    {
+        dup2(__stdout_fd ,STDOUT_FILENO);
+        close(__stdout_fd);
+        __stdout_fd = -1;
+    }
+}
+
+/**
+ * @func   bench_report
+ * @brief  打印单项测试结果（每次操作耗时与吞吐量）
+ */
+static void bench_report(const char *__name ,long __ops ,size_t __bytes ,double __sec)
+{
+    fprintf(stdout ,"  %-28s %10ld ops %10.0f ns/op %10.1f MB/s\n",
+        __name ,__ops ,__sec * 1e9 / __ops ,__bytes / __sec / (1024.0 * 1024.0));
+}
+
+/**
+ * @func   bench_make_file
+ * @brief  生成指定大小的测试文件
+ */
+static int bench_make_file(const char *__path ,size_t __size)
+{
+    char __buf[BENCH_BLOCK];
+    int __fd = open(__path ,O_WRONLY | O_CREAT | O_TRUNC ,0644);
+    if(__fd == -1)
+        return -1;
+
+    for(size_t __i = 0; __i < sizeof(__buf); __i++)
+        __buf[__i] = 'a' + (__i % 26);
+
+    for(size_t __n = 0; __n < __size; __n += sizeof(__buf))
+    {
+        if(write(__fd ,__buf ,sizeof(__buf)) != sizeof(__buf))
+        {
+            close(__fd);
+            return -1;
+        }
+    }
+    close(__fd);
+    return 0;
+}
+
+/**
+ * @func   bench_file_read_loop
+ * @brief  以指定模式顺序读取整个文件，返回耗时（秒）
+ */
+static double bench_file_read_loop(const char *__path ,int __op ,int __pread ,long *__ops ,size_t *__bytes)
+{
+    _file_t *__pf = _file_init((char *)__path);
+    if(__pf == NULL)
+        return -1;
+
+    __pf->op = __op;
+    if(_file_open(__pf ,O_RDONLY ,0) == -FILE_ERROR)
+    {
+        FILE_CLOSE(__pf);
+        return -1;
+    }
+
+    *__ops = 0;
+    *__bytes = 0;
+    double __t = _time_get_timestamp();
+    for(off_t __ofs = 0; __ofs < BENCH_FILE_SIZE; __ofs += BENCH_BLOCK)
+    {
+        int __ret = __pread ? _file_pread(__pf ,__ofs ,BENCH_BLOCK)
+                            : _file_read(__pf ,0 ,SEEK_CUR ,BENCH_BLOCK);
+        if(__ret <= 0)
+            break;
+        (*__ops)++;
+        *__bytes += __ret;
+    }
+    __t = _time_get_timestamp() - __t;
+
+    FILE_CLOSE(__pf);
+    return __t;
+}
+
+/**
+ * @func   bench_file_view_loop
+ * @brief  以映射模式顺序扫描整个文件（逐块获取视图并累加校验和），返回耗时（秒）
+ */
+static double bench_file_view_loop(const char *__path ,long *__ops ,size_t *__bytes)
+{
+    _file_t *__pf = _file_init((char *)__path);
+    if(__pf == NULL)
+        return -1;
+
+    if(_file_mmap_open(__pf ,O_RDONLY ,0) == -FILE_ERROR)
+    {
+        FILE_CLOSE(__pf);
+        return -1;
+    }
+    _file_madvise(__pf ,0 ,0 ,FILE_ADVICE_SEQUENTIAL);
+
+    _file_view_t __v;
+    volatile unsigned long __sum = 0;
+    *__ops = 0;
+    *__bytes = 0;
+    double __t = _time_get_timestamp();
+    while(_file_view(__pf ,&__v ,0 ,SEEK_CUR ,BENCH_BLOCK) > 0)
+    {
+        const unsigned char *__p = __v.ptr;
+        for(size_t __i = 0; __i < __v.len; __i += 64)
+            __sum += __p[__i];
+        (*__ops)++;
+        *__bytes += __v.len;
+    }
+    __t = _time_get_timestamp() - __t;
+
+    FILE_CLOSE(__pf);
+    return __t;
+}
+
+/**
+ * @func   bench_file_read
+ * @brief  对比 _file_read/_file_pread 在默认模式与缓存模式下的开销
+ */
+static void bench_file_read(const char *__path)
+{
+    long __ops;
+    size_t __bytes;
+    double __t;
+
+    fprintf(stdout ,"[bench] file read, %d bytes per call, file %d KB\n",
+        BENCH_BLOCK ,BENCH_FILE_SIZE / 1024);
+
+    /* 基准：裸 read() */
+    char __buf[BENCH_BLOCK];
+    int __fd = open(__path ,O_RDONLY);
+    if(__fd != -1)
+    {
+        ssize_t __n;
+        __ops = 0;
+        __bytes = 0;
+        __t = _time_get_timestamp();
+        while((__n = read(__fd ,__buf ,sizeof(__buf))) > 0)
+        {
+            __ops++;
+            __bytes += __n;
+        }
+        __t = _time_get_timestamp() - __t;
+        close(__fd);
+        bench_report("read()" ,__ops ,__bytes ,__t);
+    }
+
+    bench_quiet(1);
+    __t = bench_file_read_loop(__path ,FILE_OP_DEFAULT ,0 ,&__ops ,&__bytes);
+    bench_quiet(0);
+    if(__t > 0)
+        bench_report("_file_read (default)" ,__ops ,__bytes ,__t);
+
+    __t = bench_file_read_loop(__path ,FILE_OP_CACHE ,0 ,&__ops ,&__bytes);
+    if(__t > 0)
+        bench_report("_file_read (cache)" ,__ops ,__bytes ,__t);
+
+    bench_quiet(1);
+    __t = bench_file_read_loop(__path ,FILE_OP_DEFAULT ,1 ,&__ops ,&__bytes);
+    bench_quiet(0);
+    if(__t > 0)
+        bench_report("_file_pread (default)" ,__ops ,__bytes ,__t);
+
+    __t = bench_file_read_loop(__path ,FILE_OP_CACHE ,1 ,&__ops ,&__bytes);
+    if(__t > 0)
+        bench_report("_file_pread (cache)" ,__ops ,__bytes ,__t);
+
+    __t = bench_file_view_loop(__path ,&__ops ,&__bytes);
+    if(__t > 0)
+        bench_report("_file_view (mmap)" ,__ops ,__bytes ,__t);
+}
+
+/**
+ * @func   bench_log_write_old
+ * @brief  原 _log_write 的写入路径：每行 access + 格式化 + _file_write(SEEK_END)
+ */
+static int bench_log_write_old(_file_t *__pf ,char *__str ,const char *__name ,const char *__fmt_str ,...)
+{
+    if(__ACCESS_MODE(__pf->__pathname ,F_OK) == -1)
+        return -1;
+
+    time_t __timer;
+    char __tim_str[32] = {0};
+    if(_time_get_local_str(&__timer ,__tim_str) == 0)
+        return -1;
+
+    char __msg_buf[192] = {0};
+    va_list args;
+    va_start(args ,__fmt_str);
+    int __msg_len = vsnprintf(__msg_buf ,sizeof(__msg_buf) ,__fmt_str ,args);
+    va_end(args);
+    if(__msg_len < 0 || __msg_len >= sizeof(__msg_buf))
+        return -1;
+
+    snprintf(__str ,256 ,"%s %s %s\n" ,__tim_str ,__name ,__msg_buf);
+    int __len = strlen(__str);
+    if(_file_write(__pf ,__str ,0 ,SEEK_END ,__len) == -1)
+        return -1;
+    return __len;
+}
+
+/**
+ * @func   bench_log_report
+ * @brief  打印日志测试结果（每秒行数）
+ */
+static void bench_log_report(const char *__name ,long __lines ,double __sec)
+{
+    fprintf(stdout ,"  %-28s %10ld lines %10.0f ns/line %12.0f lines/s\n",
+        __name ,__lines ,__sec * 1e9 / __lines ,__lines / __sec);
+}
+
+/**
+ * @func   bench_log
+ * @brief  对比原日志写入路径与当前同步/异步模式的吞吐
+ */
+static void bench_log(void)
+{
+    double __t;
+
+    fprintf(stdout ,"[bench] log write, %d lines\n" ,BENCH_LOG_LINES);
+
+    /* 原实现 */
+    _file_t *__pf = _file_init(BENCH_LOG_FILE);
+    char __str[256];
+    if(__pf != NULL && _file_open(__pf ,O_RDWR | O_APPEND | O_CREAT | O_TRUNC ,0644) != -FILE_ERROR)
+    {
+        bench_quiet(1);
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            bench_log_write_old(__pf ,__str ,"[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        __t = _time_get_timestamp() - __t;
+        bench_quiet(0);
+        bench_log_report("_log_write (old)" ,BENCH_LOG_LINES ,__t);
+    }
+    if(__pf != NULL)
+        FILE_CLOSE(__pf);
+    unlink(BENCH_LOG_FILE);
+
+    /* 同步模式 */
+    if(_log_open(BENCH_LOG_FILE) == 0)
+    {
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            _log_write("[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        __t = _time_get_timestamp() - __t;
+        _log_free();
+        bench_log_report("_log_write (sync)" ,BENCH_LOG_LINES ,__t);
+    }
+    unlink(BENCH_LOG_FILE);
+
+    /* 异步模式：计入等待刷写完成的时间 */
+    if(_log_open(BENCH_LOG_FILE) == 0)
+    {
+        _log_async_start(0 ,LOG_POLICY_BLOCK);
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            _log_write("[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        _log_flush();
+        __t = _time_get_timestamp() - __t;
+        _log_free();
+        bench_log_report("_log_write (async)" ,BENCH_LOG_LINES ,__t);
+    }
+    unlink(BENCH_LOG_FILE);
+
+    /* 分线程暂存模式：计入写出全部暂存内容的时间 */
+    if(_log_open(BENCH_LOG_FILE) == 0)
+    {
+        _log_stage_start(0 ,0);
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            _log_write("[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        _log_flush();
+        __t = _time_get_timestamp() - __t;
+        _log_free();
+        bench_log_report("_log_write (staged)" ,BENCH_LOG_LINES ,__t);
+    }
+    unlink(BENCH_LOG_FILE);
+
+    /* 二进制格式（LOG_PRINT 调用点编号，同步写入） */
+    if(_log_open(BENCH_LOG_FILE) == 0)
+    {
+        static struct _log_site __site;
+        struct stat __st;
+        _log_set_format(LOG_FORMAT_BINARY);
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            _log_print(&__site ,"[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        __t = _time_get_timestamp() - __t;
+        _log_free();
+        bench_log_report("_log_print (binary)" ,BENCH_LOG_LINES ,__t);
+        if(stat(BENCH_LOG_FILE ,&__st) == 0)
+            fprintf(stdout ,"  %-28s %10.1f bytes/line\n" ,"binary record size" ,(double)__st.st_size / BENCH_LOG_LINES);
+    }
+    unlink(BENCH_LOG_FILE);
+
+    /* 调用点限速：同一调用点持续超出速率时，被丢弃的调用的开销 */
+    if(_log_open(BENCH_LOG_FILE) == 0)
+    {
+        static struct _log_site __site;
+        _log_set_ratelimit(LOG_RATE_PER_SEC ,LOG_RATE_BURST);
+        __t = _time_get_timestamp();
+        for(long __i = 0; __i < BENCH_LOG_LINES; __i++)
+            if(_log_rate_allow(&__site))
+                _log_print(&__site ,"[INFO]" ,"[%s][%s]: bench line %ld" ,"proc1" ,"main" ,__i);
+        __t = _time_get_timestamp() - __t;
+        _log_set_ratelimit(0 ,0);
+        _log_free();
+        bench_log_report("LOG_PRINT (rate limited)" ,BENCH_LOG_LINES ,__t);
+    }
+    unlink(BENCH_LOG_FILE);
+}
+
+/**
+ * @struct bench_range
+ * @brief  fork-join 求和的一段区间
+ */
+struct bench_range
+{
+    const uint32_t *__p;
+    long __n;
+    long __grain;
+    uint64_t __sum;
+};
+
+static __tsteal_t *__bench_ws = NULL;
+
+/**
+ * @func   bench_sum_leaf
+ * @brief  顺序求和（叶子任务）
+ */
+static void bench_sum_leaf(struct bench_range *__r)
+{
+    uint64_t __s = 0;
+    for(long __i = 0; __i < __r->__n; __i++)
+        __s += __r->__p[__i];
+    __r->__sum = __s;
+}
+
+/**
+ * @func   bench_sum_steal
+ * @brief  递归二分：后半段 spawn，前半段就地计算，再 sync 合并
+ */
+static void bench_sum_steal(void *__arg)
+{
+    struct bench_range *__r = (struct bench_range *)__arg;
+    if(__r->__n <= __r->__grain)
+    {
+        bench_sum_leaf(__r);
+        return;
+    }
+
+    long __half = __r->__n / 2;
+    struct bench_range __lo = { __r->__p ,__half ,__r->__grain ,0 };
+    struct bench_range __hi = { __r->__p + __half ,__r->__n - __half ,__r->__grain ,0 };
+    __tsteal_task_t __task;
+    __tsteal_task_init(&__task ,bench_sum_steal ,&__hi);
+    __tsteal_spawn(__bench_ws ,&__task);
+    bench_sum_steal(&__lo);
+    __tsteal_sync(__bench_ws ,&__task);
+    __r->__sum = __lo.__sum + __hi.__sum;
+}
+
+/**
+ * @func   bench_sum_pool
+ * @brief  线程池任务：对一个块顺序求和
+ */
+static void *bench_sum_pool(void *__arg)
+{
+    bench_sum_leaf((struct bench_range *)__arg);
+    return NULL;
+}
+
+/**
+ * @func   bench_steal
+ * @brief  对比 work-stealing 执行器与互斥锁队列线程池在不同任务粒度下的 fork-join 耗时
+ *
+ * @note
+ * 线程池一侧无法在任务内等待子任务（会占满工作线程而死锁），因此由提交线程按粒度切块后
+ * 逐块提交、逐个等待 future，这正是单一共享队列的典型用法。
+ */
+static void bench_steal(void)
+{
+    static const long __grains[] = { 65536 ,4096 ,256 };
+    uint32_t *__buf = (uint32_t *)malloc(BENCH_TASK_ELEMS * sizeof(uint32_t));
+    if(__buf == NULL)
+        return;
+
+    uint64_t __expect = 0;
+    for(long __i = 0; __i < BENCH_TASK_ELEMS; __i++)
+    {
+        __buf[__i] = (uint32_t)(__i * 2654435761u);
+        __expect += __buf[__i];
+    }
+
+    __bench_ws = __tsteal_init("bws" ,BENCH_TASK_WORKERS ,NULL);
+    __tpool_t *__pool = __tpool_init("bpool" ,BENCH_TASK_WORKERS ,TPOOL_QUEUE_DEFAULT ,NULL);
+    if(__bench_ws == NULL || __pool == NULL)
+    {
+        __tsteal_free(&__bench_ws);
+        __tpool_free(&__pool);
+        free(__buf);
+        return;
+    }
+
+    fprintf(stdout ,"[bench] fork-join sum, %d elements, %d workers\n" ,BENCH_TASK_ELEMS ,BENCH_TASK_WORKERS);
+    for(size_t __g = 0; __g < sizeof(__grains) / sizeof(__grains[0]); __g++)
+    {
+        long __grain = __grains[__g];
+        long __nchunks = (BENCH_TASK_ELEMS + __grain - 1) / __grain;
+        char __name[64];
+        double __t;
+        int __ok = 1;
+
+        /* work-stealing：一个根任务递归切分 */
+        __t = _time_get_timestamp();
+        for(int __k = 0; __k < BENCH_TASK_REPS; __k++)
+        {
+            struct bench_range __root = { __buf ,BENCH_TASK_ELEMS ,__grain ,0 };
+            __tsteal_run(__bench_ws ,bench_sum_steal ,&__root);
+            __ok &= (__root.__sum == __expect);
+        }
+        __t = _time_get_timestamp() - __t;
+        snprintf(__name ,sizeof(__name) ,"steal grain=%ld%s" ,__grain ,__ok ? "" : " (BAD)");
+        bench_report(__name ,__nchunks * BENCH_TASK_REPS ,(size_t)BENCH_TASK_ELEMS * sizeof(uint32_t) * BENCH_TASK_REPS ,__t);
+
+        /* 互斥锁队列：逐块提交，逐个等待 */
+        struct bench_range *__rs = (struct bench_range *)calloc(__nchunks ,sizeof(struct bench_range));
+        __tpool_future_t **__fs = (__tpool_future_t **)calloc(__nchunks ,sizeof(__tpool_future_t *));
+        if(__rs == NULL || __fs == NULL)
+        {
+            free(__rs);
+            free(__fs);
+            continue;
+        }
+        __ok = 1;
+        __t = _time_get_timestamp();
+        for(int __k = 0; __k < BENCH_TASK_REPS; __k++)
+        {
+            uint64_t __sum = 0;
+            for(long __c = 0; __c < __nchunks; __c++)
+            {
+                long __ofs = __c * __grain;
+                __rs[__c].__p = __buf + __ofs;
+                __rs[__c].__n = (BENCH_TASK_ELEMS - __ofs < __grain) ? BENCH_TASK_ELEMS - __ofs : __grain;
+                __fs[__c] = __tpool_submit(__pool ,bench_sum_pool ,&__rs[__c] ,-1);
+            }
+            for(long __c = 0; __c < __nchunks; __c++)
+            {
+                __tpool_future_wait(__fs[__c] ,NULL);
+                __tpool_future_free(&__fs[__c]);
+                __sum += __rs[__c].__sum;
+            }
+            __ok &= (__sum == __expect);
+        }
+        __t = _time_get_timestamp() - __t;
+        snprintf(__name ,sizeof(__name) ,"mutex queue grain=%ld%s" ,__grain ,__ok ? "" : " (BAD)");
+        bench_report(__name ,__nchunks * BENCH_TASK_REPS ,(size_t)BENCH_TASK_ELEMS * sizeof(uint32_t) * BENCH_TASK_REPS ,__t);
+
+        free(__rs);
+        free(__fs);
+    }
+
+    __tsteal_stat_t __st;
+    __tsteal_stat(__bench_ws ,&__st);
+    fprintf(stdout ,"  %-28s %10llu stolen %10llu parked\n" ,"steal counters" ,
+        (unsigned long long)__st.__stolen ,(unsigned long long)__st.__parked);
+
+    __tsteal_free(&__bench_ws);
+    __tpool_free(&__pool);
+    free(__buf);
+}
+
+/**
+ * @func   bench_stack_touch
+ * @brief  线程入口：逐页写 BENCH_STACK_TOUCH 字节的栈，模拟较深的调用栈
+ */
+static void *bench_stack_touch(void *__arg)
+{
+    volatile char __buf[BENCH_STACK_TOUCH];
+    for(size_t __i = 0; __i < sizeof(__buf); __i += 4096)
+        __buf[__i] = (char)__i;
+    return (void *)(uintptr_t)__buf[0];
+}
+
+/**
+ * @func   bench_minflt
+ * @brief  进程累计的次缺页数
+ */
+static long bench_minflt(void)
+{
+    struct rusage __ru;
+    getrusage(RUSAGE_SELF ,&__ru);
+    return __ru.ru_minflt;
+}
+
+/**
+ * @func   bench_stack
+ * @brief  对比 glibc 分配栈与栈池栈的线程创建 + join 耗时和每线程缺页次数
+ *
+ * @note
+ * glibc 在线程退出时会对缓存栈 madvise(MADV_DONTNEED)，下一个线程重新缺页；
+ * 栈池复用的栈页面保持驻留，实时线程的栈在取出前已全部预触碰。
+ */
+static void bench_stack(void)
+{
+    pthread_attr_t __attr;
+    double __t;
+    long __flt;
+
+    fprintf(stdout ,"[bench] thread create + join, %d KB stack, %d KB touched\n" ,
+        BENCH_STACK_SIZE / 1024 ,BENCH_STACK_TOUCH / 1024);
+
+    /* glibc 分配栈 */
+    pthread_attr_init(&__attr);
+    pthread_attr_setstacksize(&__attr ,BENCH_STACK_SIZE);
+    __flt = bench_minflt();
+    __t = _time_get_timestamp();
+    for(int __i = 0; __i < BENCH_STACK_THREADS; __i++)
+    {
+        pthread_t __id;
+        if(pthread_create(&__id ,&__attr ,bench_stack_touch ,NULL) == 0)
+            pthread_join(__id ,NULL);
+    }
+    __t = _time_get_timestamp() - __t;
+    __flt = bench_minflt() - __flt;
+    pthread_attr_destroy(&__attr);
+    bench_report("pthread_create (glibc)" ,BENCH_STACK_THREADS ,0 ,__t);
+    fprintf(stdout ,"  %-28s %10.1f faults/thread\n" ,"" ,(double)__flt / BENCH_STACK_THREADS);
+
+    /* 栈池：THREAD_OP_STACKSIZE 且未指定 __stack_addr */
+    __flt = bench_minflt();
+    __t = _time_get_timestamp();
+    for(int __i = 0; __i < BENCH_STACK_THREADS; __i++)
+    {
+        __thd_t __thd;
+        memset(&__thd ,0 ,sizeof(__thd));
+        __thd.__op = THREAD_OP_STACKSIZE;
+        __thd.__stack_sz = BENCH_STACK_SIZE;
+        __thd.__start_routine = bench_stack_touch;
+        if(__thread_create(&__thd) == 0)
+            __thread_join(&__thd ,NULL);
+        __thread_attr_destroy(&__thd);
+    }
+    __t = _time_get_timestamp() - __t;
+    __flt = bench_minflt() - __flt;
+    bench_report("__thread_create (stack pool)" ,BENCH_STACK_THREADS ,0 ,__t);
+    fprintf(stdout ,"  %-28s %10.1f faults/thread\n" ,"" ,(double)__flt / BENCH_STACK_THREADS);
+
+    __tstack_stat_t __st;
+    __tstack_stat(&__st);
+    fprintf(stdout ,"  %-28s %10llu hits %10llu misses\n" ,"stack pool counters" ,
+        (unsigned long long)__st.__hits ,(unsigned long long)__st.__misses);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *__path = (argc > 1) ? argv[1] : BENCH_FILE;
+
+    if(bench_make_file(__path ,BENCH_FILE_SIZE) == -1)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    bench_file_read(__path);
+    bench_log();
+    bench_steal();
+    bench_stack();
+
+    unlink(__path);
+    return 0;
+}
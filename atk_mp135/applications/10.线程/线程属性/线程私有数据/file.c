@@ -183,6 +183,84 @@ size_t _time_get_local_str(time_t *__timer, char *__buf)
     return strftime(__buf, 100, "%Y-%m-%d %H:%M:%S", &_tm);
 }
 
+/**
+ * @name    _time_get_local_str_frac
+ * @brief   格式化当前本地时间，带毫秒/微秒（格式："YYYY-MM-DD HH:MM:SS.mmm" 或 ".uuuuuu"）
+ *
+ * 每个线程缓存一份已格式化的 "YYYY-MM-DD HH:MM:SS" 前缀，只有秒数变化时才调用
+ * localtime_r/strftime 重新生成；秒内的调用只需一次 clock_gettime（vDSO，不陷入内核）、
+ * 一次 memcpy 和手工拼接的小数位。缓存为线程私有，无需加锁。
+ *
+ * @param[out] __buf    输出缓冲区，至少 TIME_STR_FRAC_MAX 字节，结果以 '\0' 结尾。
+ * @param[in]  __frac   小数位数：0（仅到秒）、3（毫秒）或 6（微秒），其它值按 6 处理。
+ *
+ * @return     写入 __buf 的字符数（不含 '\0'），失败返回 0。
+ *
+ * @note
+ * - 毫秒精度在 CLOCK_REALTIME_COARSE 分辨率不超过 1 毫秒时使用该时钟（开销更低），
+ *   否则与微秒精度一样使用 CLOCK_REALTIME；
+ * - 与 _time_get_local_str 不同，本函数不修改调用者的 time_t。
+ */
+size_t _time_get_local_str_frac(char *__buf ,int __frac)
+{
+    static __thread time_t __cache_sec = -1;
+    static __thread char __cache_str[20];
+    static __thread size_t __cache_len = 0;
+    static int __coarse_ok = -1;
+
+    if(__buf == NULL)
+        return 0;
+
+    clockid_t __clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    if(__frac == 3)
+    {
+        if(__coarse_ok == -1)
+        {
+            struct timespec __res;
+            __coarse_ok = (clock_getres(CLOCK_REALTIME_COARSE ,&__res) == 0 &&
+                           __res.tv_sec == 0 && __res.tv_nsec <= 1000000L);
+        }
+        if(__coarse_ok)
+            __clk = CLOCK_REALTIME_COARSE;
+    }
+#endif
+
+    struct timespec __ts;
+    if(clock_gettime(__clk ,&__ts) == -1)
+        return 0;
+
+    /* 秒数变化时重建前缀 */
+    if(__ts.tv_sec != __cache_sec)
+    {
+        struct tm _tm;
+        if(localtime_r(&__ts.tv_sec ,&_tm) == NULL)
+            return 0;
+        __cache_len = strftime(__cache_str ,sizeof(__cache_str) ,"%Y-%m-%d %H:%M:%S" ,&_tm);
+        if(__cache_len == 0)
+            return 0;
+        __cache_sec = __ts.tv_sec;
+    }
+
+    memcpy(__buf ,__cache_str ,__cache_len);
+    size_t __len = __cache_len;
+    if(__frac != 0)
+    {
+        int __n = (__frac == 3) ? 3 : 6;
+        unsigned long __v = (__n == 3) ? (unsigned long)__ts.tv_nsec / 1000000UL
+                                       : (unsigned long)__ts.tv_nsec / 1000UL;
+        __buf[__len] = '.';
+        for(int __i = __n; __i > 0; __i--)
+        {
+            __buf[__len + __i] = '0' + (__v % 10);
+            __v /= 10;
+        }
+        __len += __n + 1;
+    }
+    __buf[__len] = '\0';
+    return __len;
+}
+
 /**
  * @func    _time_get_timestamp
  * @brief   获取当前高精度单调时间戳（单位：秒）
@@ -250,6 +328,22 @@ static int _file_get_pw(struct passwd **ppw ,uid_t uid)
     return FILE_EOK;
 }
 
+/**
+ * @name  _file_parse_properties
+ * @brief 根据 fst->st 解析文件类型、权限、时间字符串及属主信息。
+ *
+ * @param[in,out] fst  指向已填充 st 成员的 `__file_stat` 结构体。
+ */
+static void _file_parse_properties(struct __file_stat *fst)
+{
+    _file_get_type(&fst->st ,&fst->type);
+    _file_get_rwx(&fst->st ,&fst->rwx);
+    _time_get_local_str(&fst->st.st_atim.tv_sec ,fst->atim);
+    _time_get_local_str(&fst->st.st_mtim.tv_sec ,fst->mtim);
+    _time_get_local_str(&fst->st.st_ctim.tv_sec ,fst->ctim);
+    _file_get_pw(&fst->pw ,fst->st.st_uid);
+}
+
 /**
  * @name  _file_get_properties
  * @brief 获取并更新指定文件的属性信息，包括类型、权限及时间戳。
@@ -272,62 +366,111 @@ int _file_get_properties(char *__pathname ,struct __file_stat *fst)
 {
     if(__pathname == NULL || fst == NULL)
         return -FILE_ERROR;
-#if 0
-    if(fstat(pf->fd ,&pf->st) == -1){
+    if(stat(__pathname ,&fst->st) == -1){
         perror("get file size error.");
         return -FILE_ERROR;
     }
-#else
-    if(stat(__pathname ,&fst->st) == -1){
-        perror("get file size error.");
+
+    _file_parse_properties(fst);
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_get_fproperties
+ * @brief 通过已打开的文件描述符获取并更新文件属性信息。
+ *
+ * 与 `_file_get_properties()` 相同，但使用 `fstat()`，不再进行路径解析，
+ * 也不受文件被重命名/删除的影响。
+ *
+ * @param[in]  fd   已打开的文件描述符。
+ * @param[out] fst  指向 `__file_stat` 结构体的有效指针。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR
+ */
+static int _file_get_fproperties(int fd ,struct __file_stat *fst)
+{
+    if(fd < 0 || fst == NULL)
+        return -FILE_ERROR;
+
+    if(fstat(fd ,&fst->st) == -1){
+        PRINT_ERROR();
         return -FILE_ERROR;
     }
-#endif
-    _file_get_type(&fst->st ,&fst->type);
-    _file_get_rwx(&fst->st ,&fst->rwx);
-    _time_get_local_str(&fst->st.st_atim.tv_sec ,fst->atim);
-    _time_get_local_str(&fst->st.st_mtim.tv_sec ,fst->mtim);
-    _time_get_local_str(&fst->st.st_ctim.tv_sec ,fst->ctim);
-    _file_get_pw(&fst->pw ,fst->st.st_uid);
+
+    _file_parse_properties(fst);
     return FILE_EOK;
 }
 
 /**
- * @name  _file_data_init
- * @brief 初始化或重置数据缓冲区。
+ * @name  _file_data_reserve
+ * @brief 确保数据缓冲区容量不小于指定大小，容量不足时按 2 倍几何增长。
  *
- * 该函数用于初始化或重新初始化指针所指向的数据缓冲区。若指针当前非空，
- * 会先释放已有内存，防止内存泄漏。随后分配指定大小的缓冲区，并将其内容清零。
+ * 该函数用于替代每次读取都 free/calloc 的做法：缓冲区在对象生命周期内复用，
+ * 只有请求长度超过当前容量时才重新分配，紧凑的读循环中不再产生 malloc/free。
+ * 扩容时旧内容不保留（读操作会整体覆盖），因此使用 free + malloc 而非 realloc。
  *
- * @param[in,out] pptr 指向需要初始化的指针的地址（即二级指针），
- *                     函数将修改该指针指向新分配的缓冲区。
- * @param[in]     size 需要分配的缓冲区大小（单位：字节）。
+ * @param[in,out] pptr 指向缓冲区指针的地址（即二级指针）。
+ * @param[in,out] pcap 指向缓冲区当前容量的指针，扩容后更新。
+ * @param[in]     size 需要的数据长度（单位：字节）。
  *
  * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
  *
- * @note  - 如果输入指针为空或 size 为 0，函数直接返回失败。
- *        - 分配失败时，会打印错误信息，但不会终止程序。
- *        - 调用前应确保 pptr 指向有效地址。
+ * @note  - 额外预留 1 字节用于结尾 '\0'，兼容把 data 当作字符串使用的调用者；
+ *        - 如果输入指针为空或 size 为 0，函数直接返回失败；
+ *        - 缓冲区内容不再清零。
  */
-static int _file_data_init(void **pptr ,size_t size)
+static int _file_data_reserve(void **pptr ,size_t *pcap ,size_t size)
 {
-    if(pptr == NULL || size == 0)
+    if(pptr == NULL || pcap == NULL || size == 0 || size >= SIZE_MAX / 2)
         return -FILE_ERROR;
 
-    if(*pptr != NULL){
-        free(*pptr);
-        *pptr = NULL;
-    }
+    size += 1;
+    if(*pptr != NULL && *pcap >= size)
+        return FILE_EOK;
 
-    *pptr = calloc(size ,sizeof(char));
+    size_t __cap = (*pcap > 0) ? *pcap : FILE_DATA_MIN_CAP;
+    while(__cap < size)
+        __cap <<= 1;
+
+    free(*pptr);
+    *pptr = malloc(__cap);
     if(*pptr == NULL){
-        printf("calloc error...\n");
+        *pcap = 0;
+        printf("malloc error...\n");
         return -FILE_ERROR;
     }
 
+    *pcap = __cap;
     return FILE_EOK;
 }
 
+/**
+ * @name  _file_read_dst
+ * @brief 选择读取目标缓冲区：调用者提供的缓冲区，或 _file_t 内部的复用缓冲区。
+ *
+ * @return 目标缓冲区地址，失败返回 NULL。
+ */
+static void *_file_read_dst(_file_t *pf ,void *buf ,size_t len)
+{
+    if(buf != NULL)
+        return buf;
+
+    if(_file_data_reserve(&pf->data ,&pf->cap ,len) == -FILE_ERROR)
+        return NULL;
+
+    return pf->data;
+}
+
+/**
+ * @name  _file_read_end
+ * @brief 读取完成后为内部缓冲区补齐结尾 '\0'（调用者缓冲区不做修改）。
+ */
+static void _file_read_end(_file_t *pf ,void *dst)
+{
+    if(dst == pf->data && pf->ret >= 0)
+        ((char *)pf->data)[pf->ret] = '\0';
+}
+
 /**
  * @name  __file_chown
  * @brief 修改指定路径文件的属主和属组。
@@ -649,8 +792,145 @@ static int _file_get_info(_file_t *pf)
     if(_file_status_fcntl(pf ,F_GETFL) == -FILE_ERROR)
         return -FILE_ERROR;
 
+    pf->stale = 0;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_refresh_info
+ * @brief 立即刷新文件的全部元信息（fstat + 时间格式化 + 偏移 + 状态标志）。
+ *
+ * 缓存模式（FILE_OP_CACHE）下读写路径不再刷新 `fst`，调用者需要完整信息
+ * （如打印 PRINT_FILE_INFO）时调用本函数；默认模式下也可用于主动同步。
+ *
+ * @param[in,out] __pf  已打开的文件结构体指针。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR
+ */
+int _file_refresh_info(_file_t *__pf)
+{
+    if(__pf == NULL || __pf->fd < 0)
+        return -FILE_ERROR;
+
+    if(_file_get_fproperties(__pf->fd ,__pf->fst) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    if(_file_get_offset(__pf) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    if(_file_status_fcntl(__pf ,F_GETFL) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    __pf->stale = 0;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_check_change
+ * @brief 缓存模式下检测文件是否被外部修改。
+ *
+ * 仅执行一次 fstat，不做时间格式化与用户名查询。若 inode、大小或修改时间
+ * 与缓存不一致，则更新缓存的 st 并设置 stale 标志，格式化信息留待
+ * `_file_refresh_info()` 按需刷新。
+ *
+ * @param[in,out] pf  已打开的文件结构体指针。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR
+ */
+static int _file_check_change(_file_t *pf)
+{
+    struct stat __st;
+
+    if(fstat(pf->fd ,&__st) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    if(__st.st_ino != pf->fst->st.st_ino || __st.st_size != pf->fst->st.st_size ||
+       __st.st_mtim.tv_sec != pf->fst->st.st_mtim.tv_sec ||
+       __st.st_mtim.tv_nsec != pf->fst->st.st_mtim.tv_nsec)
+    {
+        pf->fst->st = __st;
+        pf->stale = 1;
+    }
+
     return FILE_EOK;
 }
+
+/**
+ * @name  _file_seek_cached
+ * @brief 缓存模式下设置文件偏移，目标位置与缓存偏移相同时不发起 lseek。
+ *
+ * SEEK_SET/SEEK_CUR 的目标位置由缓存偏移直接计算；SEEK_END 依赖真实文件大小，
+ * 交由内核计算，并顺带校正缓存的文件大小。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR
+ */
+static int _file_seek_cached(_file_t *pf ,off_t ofs ,int whence)
+{
+    off_t __pos;
+
+    if(whence == SEEK_END)
+    {
+        if(_file_set_offset(pf ,ofs ,SEEK_END) == -FILE_ERROR)
+            return -FILE_ERROR;
+
+        if(pf->fst->st.st_size != pf->ofs - ofs){
+            pf->fst->st.st_size = pf->ofs - ofs;
+            pf->stale = 1;
+        }
+        return FILE_EOK;
+    }
+
+    __pos = (whence == SEEK_SET) ? ofs : (pf->ofs + ofs);
+    if(__pos == pf->ofs)
+        return FILE_EOK;
+
+    return _file_set_offset(pf ,__pos ,SEEK_SET);
+}
+
+/**
+ * @name  _file_clamp_cached
+ * @brief 缓存模式下根据缓存的文件大小裁剪读取长度。
+ *
+ * 只有请求越过缓存的文件尾时才执行一次 fstat，确认文件是否已被外部追加，
+ * 顺序读取整个文件时仅最后一次读取会产生额外的系统调用。
+ *
+ * @return 裁剪后的可读长度，0 表示已到文件尾。
+ */
+static size_t _file_clamp_cached(_file_t *pf ,off_t pos ,size_t len)
+{
+    off_t __avail = pf->fst->st.st_size - pos;
+
+    if((off_t)len > __avail)
+    {
+        if(_file_check_change(pf) == -FILE_ERROR)
+            return 0;
+        __avail = pf->fst->st.st_size - pos;
+    }
+
+    if(__avail <= 0)
+        return 0;
+
+    return ((off_t)len > __avail) ? (size_t)__avail : len;
+}
+
+/**
+ * @name  _file_update_size_cached
+ * @brief 缓存模式下写入完成后更新缓存的文件大小。
+ *
+ * @param[in,out] pf   文件结构体指针。
+ * @param[in]     end  本次写入结束位置（非追加写入时有效）。
+ */
+static void _file_update_size_cached(_file_t *pf ,off_t end)
+{
+    if((pf->fg & O_APPEND) == O_APPEND)
+        pf->fst->st.st_size += pf->ret;
+    else if(end > pf->fst->st.st_size)
+        pf->fst->st.st_size = end;
+
+    pf->stale = 1;
+}
  
 /**
  * @name    _file_close
@@ -675,6 +955,13 @@ void _file_close(_file_t *pf)
     printf("%s file close.\n" ,pf->__pathname);
 #endif
 
+    if(pf->map != NULL){
+        munmap(pf->map ,pf->map_len);
+        pf->map = NULL;
+        pf->map_len = 0;
+        pf->map_ofs = 0;
+    }
+
     if(pf->fd >= 0)
         close(pf->fd);
     
@@ -688,6 +975,11 @@ void _file_close(_file_t *pf)
         pf->data = NULL;
     }
 
+    if(pf->dio_buf != NULL){
+        free(pf->dio_buf);
+        pf->dio_buf = NULL;
+    }
+
     if(pf->fst != NULL){
         free(pf->fst);
         pf->fst = NULL;
@@ -733,6 +1025,12 @@ _file_t* _file_init(char *__pathname)
 
     pf->fd = -1;
     pf->data = NULL;
+    pf->cap = 0;
+    pf->map = NULL;
+    pf->map_len = 0;
+    pf->map_ofs = 0;
+    pf->dio_buf = NULL;
+    pf->dio_cap = 0;
     pf->fg = 0;
     pf->ofs = 0;
     pf->ret = 0;
@@ -749,6 +1047,193 @@ _file_t* _file_init(char *__pathname)
     return pf;
 }
 
+/**
+ * @name  _file_dio_probe
+ * @brief 获取直接 I/O 的对齐要求。
+ *
+ * 优先使用 statx(STATX_DIOALIGN)（Linux 6.1+）取得偏移/长度对齐与内存对齐；
+ * 不支持时退回 st_blksize（通常为文件系统块大小，是逻辑块大小的整数倍，满足对齐要求），
+ * 仍无法获取时使用 512。
+ */
+static void _file_dio_probe(_file_t *pf)
+{
+#ifdef STATX_DIOALIGN
+    struct statx __stx;
+    if(statx(pf->fd ,"" ,AT_EMPTY_PATH ,STATX_DIOALIGN ,&__stx) == 0 &&
+            (__stx.stx_mask & STATX_DIOALIGN) && __stx.stx_dio_offset_align != 0)
+    {
+        pf->dio_align = __stx.stx_dio_offset_align;
+        pf->dio_mem_align = __stx.stx_dio_mem_align;
+        if(pf->dio_mem_align < sizeof(void *))
+            pf->dio_mem_align = sizeof(void *);
+        return;
+    }
+#endif
+    pf->dio_align = (pf->fst->st.st_blksize > 0) ? (size_t)pf->fst->st.st_blksize : 512;
+    pf->dio_mem_align = pf->dio_align;
+}
+
+/**
+ * @name  _file_dio_reserve
+ * @brief 确保对齐的中转（bounce）缓冲区容量不小于 size，使用 posix_memalign 分配。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+static int _file_dio_reserve(_file_t *pf ,size_t size)
+{
+    if(pf->dio_buf != NULL && pf->dio_cap >= size)
+        return FILE_EOK;
+
+    free(pf->dio_buf);
+    pf->dio_buf = NULL;
+    pf->dio_cap = 0;
+
+    int __ret = posix_memalign(&pf->dio_buf ,pf->dio_mem_align ,size);
+    if(__ret != 0){
+        errno = __ret;
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    pf->dio_cap = size;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_dio_aligned
+ * @brief 判断缓冲区地址、偏移与长度是否都满足直接 I/O 对齐要求。
+ */
+static int _file_dio_aligned(_file_t *pf ,const void *buf ,off_t ofs ,size_t len)
+{
+    return ((uintptr_t)buf % pf->dio_mem_align) == 0 &&
+           ((size_t)ofs % pf->dio_align) == 0 && (len % pf->dio_align) == 0;
+}
+
+/**
+ * @name  _file_dio_sync_offset
+ * @brief 直接 I/O 读写按 pf->ofs 执行 pread/pwrite，不移动内核偏移；读写后将内核偏移同步为 pf->ofs，
+ *        之后的 readv/writev/_file_copy 等依赖内核偏移的接口才能从正确位置继续。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+static int _file_dio_sync_offset(_file_t *pf)
+{
+    if(lseek(pf->fd ,pf->ofs ,SEEK_SET) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_pread_direct
+ * @brief 直接 I/O 读取：对齐的请求直接读入调用者缓冲区，未对齐的请求经对齐中转缓冲区读取后拷贝。
+ *
+ * 中转时将 [ofs, ofs + len) 扩展到对齐边界，每次最多 FILE_DIO_BOUNCE 字节。
+ *
+ * @return 实际读取的字节数（0 表示文件尾），失败返回 -1（errno 保留）。
+ */
+static ssize_t _file_pread_direct(_file_t *pf ,void *buf ,size_t len ,off_t ofs)
+{
+    if(_file_dio_aligned(pf ,buf ,ofs ,len))
+        return pread(pf->fd ,buf ,len ,ofs);
+
+    size_t __a = pf->dio_align;
+    if(_file_dio_reserve(pf ,FILE_DIO_BOUNCE) == -FILE_ERROR)
+        return -1;
+
+    char *__dst = (char *)buf;
+    ssize_t __total = 0;
+    while(len > 0)
+    {
+        off_t __start = ofs - (off_t)((size_t)ofs % __a);
+        size_t __head = (size_t)(ofs - __start);
+        size_t __span = (__head + len > FILE_DIO_BOUNCE) ? FILE_DIO_BOUNCE : (__head + len);
+        size_t __alen = (__span + __a - 1) / __a * __a;
+
+        ssize_t __n = pread(pf->fd ,pf->dio_buf ,__alen ,__start);
+        if(__n < 0)
+            return (__total > 0) ? __total : -1;
+
+        size_t __avail = ((size_t)__n > __head) ? ((size_t)__n - __head) : 0;
+        size_t __take = (__avail < __span - __head) ? __avail : (__span - __head);
+        memcpy(__dst ,(char *)pf->dio_buf + __head ,__take);
+
+        __dst += __take;
+        ofs += __take;
+        len -= __take;
+        __total += __take;
+        if((size_t)__n < __alen || __take == 0)
+            break;      /* 文件尾 */
+    }
+    return __total;
+}
+
+/**
+ * @name  _file_pwrite_direct
+ * @brief 直接 I/O 写入：对齐的请求直接写出，未对齐的头/尾块经中转缓冲区读-改-写。
+ *
+ * 对齐范围超出原文件尾时，写入后用 ftruncate 将文件大小还原为实际写入终点。
+ *
+ * @return 实际写入的字节数，失败返回 -1（errno 保留）。
+ *
+ * @note 读-改-写不是原子操作，多个写者并发修改同一对齐块时需自行加锁。
+ */
+static ssize_t _file_pwrite_direct(_file_t *pf ,const void *data ,size_t len ,off_t ofs)
+{
+    if(_file_dio_aligned(pf ,data ,ofs ,len))
+        return pwrite(pf->fd ,data ,len ,ofs);
+
+    size_t __a = pf->dio_align;
+    if(_file_dio_reserve(pf ,FILE_DIO_BOUNCE) == -FILE_ERROR)
+        return -1;
+
+    struct stat __st;
+    if(fstat(pf->fd ,&__st) == -1)
+        return -1;
+    off_t __size = __st.st_size;
+
+    const char *__src = (const char *)data;
+    ssize_t __total = 0;
+    while(len > 0)
+    {
+        off_t __start = ofs - (off_t)((size_t)ofs % __a);
+        size_t __head = (size_t)(ofs - __start);
+        size_t __take = (len > FILE_DIO_BOUNCE - __head) ? (FILE_DIO_BOUNCE - __head) : len;
+        size_t __alen = (__head + __take + __a - 1) / __a * __a;
+        char *__b = (char *)pf->dio_buf;
+
+        /* 读出未完全覆盖的头块与尾块（超出文件尾的部分补 0） */
+        if(__head != 0 || __take != __alen)
+        {
+            memset(__b ,0 ,__a);
+            memset(__b + __alen - __a ,0 ,__a);
+            if(__head != 0 && pread(pf->fd ,__b ,__a ,__start) < 0)
+                return (__total > 0) ? __total : -1;
+            if((__head + __take) % __a != 0 && (__alen > __a || __head == 0) &&
+                    pread(pf->fd ,__b + __alen - __a ,__a ,__start + (off_t)(__alen - __a)) < 0)
+                return (__total > 0) ? __total : -1;
+        }
+
+        memcpy(__b + __head ,__src ,__take);
+        ssize_t __n = pwrite(pf->fd ,__b ,__alen ,__start);
+        if(__n < (ssize_t)(__head + __take))
+            return (__total > 0) ? __total : -1;
+
+        __src += __take;
+        ofs += __take;
+        len -= __take;
+        __total += __take;
+    }
+
+    /* 对齐填充使文件超出了实际写入终点 */
+    off_t __end = (ofs > __size) ? ofs : __size;
+    off_t __aend = ofs + (off_t)((__a - (size_t)ofs % __a) % __a);
+    if(__aend > __end && ftruncate(pf->fd ,__end) == -1)
+        return -1;
+
+    return __total;
+}
+
 /**
  * @name _file_open
  * @brief 打开或创建文件，并初始化 _file_t 结构体中的相关字段。
@@ -774,54 +1259,211 @@ int _file_open(_file_t *__pf ,int __fg ,mode_t __md)
     if(__pf == NULL || __fg < 0)
         return -FILE_ERROR;
     
-    __pf->fg = __fg;
-    
-    __pf->fd = open(__pf->__pathname ,__pf->fg ,__md);
-    if(__pf->fd == -1)
+    if((__pf->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
     {
-        PRINT_ERROR();
-        return -FILE_ERROR;
+        /* 未对齐写入的读-改-写按块边界 pwrite，O_APPEND 会使其落到文件尾 */
+        if((__fg & O_APPEND) == O_APPEND)
+        {
+            printf("%s: O_APPEND is not supported with FILE_OP_DIRECT\n" ,__pf->__pathname);
+            errno = EINVAL;
+            return -FILE_ERROR;
+        }
+        /* 直接 I/O 模式隐含缓存模式：读写路径不 stat，大小由封装层维护 */
+        __pf->op |= FILE_OP_CACHE;
+        __fg |= O_DIRECT;
     }
 
-    if(_file_get_properties(__pf->__pathname ,__pf->fst) == -FILE_ERROR)
-        return -FILE_ERROR;
-
-    if(_file_get_offset(__pf) == -FILE_ERROR)
+    int __fd = open(__pf->__pathname ,__fg ,__md);
+    if(__fd == -1 && errno == EINVAL && (__fg & O_DIRECT) == O_DIRECT)
+    {
+        /* 文件系统不支持 O_DIRECT（如 tmpfs）：退回普通缓存 I/O */
+        printf("%s: O_DIRECT not supported, fall back to buffered I/O\n" ,__pf->__pathname);
+        __pf->op &= ~FILE_OP_DIRECT;
+        __fg &= ~O_DIRECT;
+        __fd = open(__pf->__pathname ,__fg ,__md);
+    }
+    if(__fd == -1)
+    {
+        PRINT_ERROR();
         return -FILE_ERROR;
+    }
 
-    if(_file_data_init(&__pf->data ,1) == -FILE_ERROR)
+    if(_file_attach_fd(__pf ,__fd ,__fg) == -FILE_ERROR)
         return -FILE_ERROR;
 
-#ifdef PIRNT
-    PRINT_FILE_INFO("open" ,__pf);
-#endif
+    if((__pf->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
+        _file_dio_probe(__pf);
+
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_attach_fd
+ * @brief 将一个已打开的文件描述符关联到 _file_t，并完成与 _file_open 相同的初始化。
+ *
+ * 用于描述符不是由 _file_open 打开的场景，例如异步引擎中由 io_uring 完成的打开请求。
+ *
+ * @param[in,out] __pf  由 _file_init 创建的文件结构体指针。
+ * @param[in]     __fd  已打开的文件描述符，关联后由 _file_close 负责关闭。
+ * @param[in]     __fg  打开该描述符时使用的标志。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_attach_fd(_file_t *__pf ,int __fd ,int __fg)
+{
+    if(__pf == NULL || __fd < 0)
+        return -FILE_ERROR;
+
+    __pf->fd = __fd;
+    __pf->fg = __fg;
+
+    if((__pf->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+    {
+        /* 缓存模式：通过 fd 获取一次完整属性，新打开的文件偏移恒为 0 */
+        if(_file_get_fproperties(__pf->fd ,__pf->fst) == -FILE_ERROR)
+            return -FILE_ERROR;
+        __pf->ofs = 0;
+        __pf->stale = 0;
+    }
+    else
+    {
+        if(_file_get_properties(__pf->__pathname ,__pf->fst) == -FILE_ERROR)
+            return -FILE_ERROR;
+
+        if(_file_get_offset(__pf) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    if(_file_data_reserve(&__pf->data ,&__pf->cap ,1) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+#ifdef PIRNT
+    PRINT_FILE_INFO("open" ,__pf);
+#endif
 
     return FILE_EOK;
 }
  
+/**
+ * @name  _file_read_cached
+ * @brief _file_read 的缓存模式实现。
+ *
+ * 偏移在缓存中计算，仅在目标位置变化时 lseek；读取长度按缓存的文件大小裁剪，
+ * 读取后只累加缓存偏移，不再执行 stat/lseek/fcntl 与信息打印。
+ *
+ * @return 实际读取的字节数（>=0，0 表示文件尾），失败返回 -FILE_ERROR。
+ */
+static int _file_read_cached(_file_t *pfr ,void *buf ,off_t ofs ,int whence ,size_t len)
+{
+    if(_file_seek_cached(pfr ,ofs ,whence) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    len = _file_clamp_cached(pfr ,pfr->ofs ,len);
+    if(len == 0){
+        pfr->ret = 0;
+        return 0;
+    }
+
+    void *__dst = _file_read_dst(pfr ,buf ,len);
+    if(__dst == NULL)
+        return -FILE_ERROR;
+
+    if((pfr->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
+        pfr->ret = _file_pread_direct(pfr ,__dst ,len ,pfr->ofs);
+    else
+        pfr->ret = read(pfr->fd ,__dst ,len);
+    if(pfr->ret < 0){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    _file_read_end(pfr ,__dst);
+    pfr->ofs += pfr->ret;
+    if((pfr->op & FILE_OP_DIRECT) == FILE_OP_DIRECT && _file_dio_sync_offset(pfr) == -FILE_ERROR)
+        return -FILE_ERROR;
+    return pfr->ret;
+}
+
+/**
+ * @name  _file_write_cached
+ * @brief _file_write 的缓存模式实现。
+ *
+ * 以 O_APPEND 打开时写入位置由内核决定，不再设置偏移；否则仅在目标位置变化时 lseek。
+ * 写入后由封装层累加偏移并更新缓存的文件大小。
+ *
+ * @return 成功返回实际写入的字节数，失败返回 -FILE_ERROR。
+ */
+static int _file_write_cached(_file_t *pfw ,void *data ,off_t ofs ,int whence ,size_t len)
+{
+    if((pfw->fg & O_APPEND) != O_APPEND)
+    {
+        if(_file_seek_cached(pfw ,ofs ,whence) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    /* 直接 I/O 模式不允许 O_APPEND（见 _file_open），写入位置即 pf->ofs */
+    if((pfw->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
+        pfw->ret = _file_pwrite_direct(pfw ,data ,len ,pfw->ofs);
+    else
+        pfw->ret = write(pfw->fd ,data ,len);
+    if(pfw->ret == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    _file_update_size_cached(pfw ,pfw->ofs + pfw->ret);
+    pfw->ofs = ((pfw->fg & O_APPEND) == O_APPEND) ? pfw->fst->st.st_size : (pfw->ofs + pfw->ret);
+    if((pfw->op & FILE_OP_DIRECT) == FILE_OP_DIRECT && _file_dio_sync_offset(pfw) == -FILE_ERROR)
+        return -FILE_ERROR;
+    return pfw->ret;
+}
+
+/**
+ * @name  _file_pread_cached
+ * @brief _file_pread 的缓存模式实现，按缓存的文件大小裁剪后直接 pread。
+ *
+ * @return 实际读取的字节数（>=0，0 表示文件尾），失败返回 -FILE_ERROR。
+ */
+static int _file_pread_cached(_file_t *pfr ,void *buf ,off_t ofs ,size_t len)
+{
+    len = _file_clamp_cached(pfr ,ofs ,len);
+    if(len == 0){
+        pfr->ret = 0;
+        return 0;
+    }
+
+    void *__dst = _file_read_dst(pfr ,buf ,len);
+    if(__dst == NULL)
+        return -FILE_ERROR;
+
+    if((pfr->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
+        pfr->ret = _file_pread_direct(pfr ,__dst ,len ,ofs);
+    else
+        pfr->ret = pread(pfr->fd ,__dst ,len ,ofs);
+    if(pfr->ret < 0){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    _file_read_end(pfr ,__dst);
+    return pfr->ret;
+}
+
  /**
-  * @name _file_read
-  * @brief 从指定偏移位置开始，读取数据到 _file_t 的 data 缓冲区中。
-  *
-  * 本函数会根据传入的偏移量和 whence 参数，先调用 lseek 设置读取起始位置，
-  * 然后计算实际可读长度（防止越界），初始化缓冲区大小，最后读取数据。
-  *
-  * @param pfr     指向 _file_t 文件结构体的指针，必须已打开文件并分配 fd。
-  * @param ofs     偏移量，表示从文件哪个位置开始读。
-  * @param whence  lseek 的方式：SEEK_SET / SEEK_CUR / SEEK_END。
-  * @param len     想要读取的最大字节数。
-  *
-  * @return 实际读取的字节数（>=0），失败返回 -FILE_ERROR。
+  * @name _file_read_common
+  * @brief _file_read/_file_read_into 的公共实现。
   *
-  * @note 若 len 超过剩余文件大小，会自动缩减至剩余部分。
+  * @param buf  目标缓冲区，NULL 表示读入 _file_t 内部的复用缓冲区 data。
   */
- 
- int _file_read(_file_t *pfr ,off_t ofs ,int whence ,size_t len)
+ static int _file_read_common(_file_t *pfr ,void *buf ,off_t ofs ,int whence ,size_t len)
  {
      if(pfr == NULL || pfr->data == NULL || len <= 0 ||
              (whence != SEEK_CUR && whence != SEEK_SET && whence != SEEK_END))
          return -FILE_ERROR;
  
+     if((pfr->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+         return _file_read_cached(pfr ,buf ,ofs ,whence ,len);
+
      if(_file_set_offset(pfr ,ofs ,whence) == -FILE_ERROR)
          return -FILE_ERROR;
      printf("set %s file read offset: %ld bytes\n" ,pfr->__pathname ,pfr->ofs);
@@ -831,14 +1473,16 @@ int _file_open(_file_t *__pf ,int __fg ,mode_t __md)
      
      len = (len > (pfr->fst->st.st_size - pfr->ofs))?  (pfr->fst->st.st_size - pfr->ofs): len;
  
-     if(_file_data_init(&pfr->data ,len) == -FILE_ERROR)
+     void *__dst = _file_read_dst(pfr ,buf ,len);
+     if(__dst == NULL)
          return -FILE_ERROR;
  
-     pfr->ret = read(pfr->fd ,pfr->data ,len);    
+     pfr->ret = read(pfr->fd ,__dst ,len);    
      if(pfr->ret < 0){
          PRINT_ERROR();
          return -FILE_ERROR;
      }
+     _file_read_end(pfr ,__dst);
      
      if(_file_get_info(pfr) == -FILE_ERROR)
          return -FILE_ERROR;
@@ -846,6 +1490,51 @@ int _file_open(_file_t *__pf ,int __fg ,mode_t __md)
      PRINT_FILE_INFO("read" ,pfr);
      return pfr->ret;
  }
+
+ /**
+  * @name _file_read
+  * @brief 从指定偏移位置开始，读取数据到 _file_t 的 data 缓冲区中。
+  *
+  * 本函数会根据传入的偏移量和 whence 参数，先调用 lseek 设置读取起始位置，
+  * 然后计算实际可读长度（防止越界），按需扩容复用缓冲区，最后读取数据。
+  *
+  * @param pfr     指向 _file_t 文件结构体的指针，必须已打开文件并分配 fd。
+  * @param ofs     偏移量，表示从文件哪个位置开始读。
+  * @param whence  lseek 的方式：SEEK_SET / SEEK_CUR / SEEK_END。
+  * @param len     想要读取的最大字节数。
+  *
+  * @return 实际读取的字节数（>=0），失败返回 -FILE_ERROR。
+  *
+  * @note
+  * - 若 len 超过剩余文件大小，会自动缩减至剩余部分；
+  * - data 缓冲区在多次调用间复用，数据后补 '\0'，但不再整体清零。
+  */
+ int _file_read(_file_t *pfr ,off_t ofs ,int whence ,size_t len)
+ {
+     return _file_read_common(pfr ,NULL ,ofs ,whence ,len);
+ }
+
+ /**
+  * @name _file_read_into
+  * @brief 与 _file_read 相同，但数据直接读入调用者提供的缓冲区。
+  *
+  * 读取结果不经过 pfr->data 中转，省去一次拷贝；偏移、大小等记账与 _file_read 一致。
+  *
+  * @param pfr     指向已打开的 _file_t 文件结构体的指针。
+  * @param buf     目标缓冲区，容量不小于 len，不能为 NULL。
+  * @param ofs     偏移量。
+  * @param whence  lseek 的方式：SEEK_SET / SEEK_CUR / SEEK_END。
+  * @param len     想要读取的最大字节数。
+  *
+  * @return 实际读取的字节数（>=0），失败返回 -FILE_ERROR。
+  */
+ int _file_read_into(_file_t *pfr ,void *buf ,off_t ofs ,int whence ,size_t len)
+ {
+     if(buf == NULL)
+         return -FILE_ERROR;
+
+     return _file_read_common(pfr ,buf ,ofs ,whence ,len);
+ }
   
 /**
  * @name  _file_write
@@ -872,6 +1561,9 @@ int _file_write(_file_t *__pfw ,void *__data ,off_t __ofs ,int __whence ,size_t
         (__whence != SEEK_CUR && __whence != SEEK_SET && __whence != SEEK_END))
         return -FILE_ERROR;
 
+    if((__pfw->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+        return _file_write_cached(__pfw ,__data ,__ofs ,__whence ,__len);
+
     if(_file_set_offset(__pfw ,__ofs ,__whence) == -FILE_ERROR)
         return -FILE_ERROR;
 #ifdef PRINT
@@ -895,29 +1587,12 @@ int _file_write(_file_t *__pfw ,void *__data ,off_t __ofs ,int __whence ,size_t
 }
  
 /**
- * @func   _file_pread
- * @brief  从文件中按指定偏移读取数据（不影响文件当前偏移）。
- *
- * @details
- *  使用 pread() 系统调用从文件描述符指定的偏移处读取 `len` 字节数据，
- *  读取内容保存至 `pfr->data` 缓冲区。该操作不会改变文件描述符的当前偏移量。
- *
- *  若读取超出文件末尾，读取长度将被自动裁剪为：`文件大小 - ofs`。
- *  若读取失败、参数非法或元信息更新失败，返回 -FILE_ERROR。
+ * @func   _file_pread_common
+ * @brief  _file_pread/_file_pread_into 的公共实现。
  *
- * @param[in,out] __pfr   指向目标文件结构体 _file_t 的指针，必须已打开。
- * @param[in]     __ofs   起始读取偏移（文件内的位置）。
- * @param[in]     __len   要读取的字节数（> 0）。
- *
- * @retval >0          实际成功读取的字节数。
- * @retval -FILE_ERROR 出现错误（如文件未打开、偏移非法、IO失败等）。
- *
- * @note
- *  - `pfr->data` 将由本函数内部重新分配，请确保调用前已释放旧内存（如有）。
- *  - 本函数会更新 `pfr` 中的元信息（如大小、偏移、权限等）。
- *  - 与 `read()` 不同，`pread()` 是线程安全的，不影响进程共享文件偏移。
+ * @param buf  目标缓冲区，NULL 表示读入 _file_t 内部的复用缓冲区 data。
  */
-int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
+static int _file_pread_common(_file_t *__pfr ,void *__buf ,off_t __ofs ,size_t __len)
 {
     if(__pfr == NULL || __pfr->data == NULL || __len <= 0)
         return -1;
@@ -929,21 +1604,26 @@ int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
     printf("get %s file offset: %ld bytes\n" ,pfr->__pathname ,pfr->ofs);    
 #endif
 
+    if((__pfr->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+        return _file_pread_cached(__pfr ,__buf ,__ofs ,__len);
+
     if(_file_get_properties(__pfr->__pathname ,__pfr->fst) == -FILE_ERROR)
         return -FILE_ERROR;
 
     __len = (__len > (__pfr->fst->st.st_size - __ofs)) ?  
                                          (__pfr->fst->st.st_size - __ofs): __len;
 
-    if(_file_data_init(&__pfr->data ,__len) == -FILE_ERROR)
+    void *__dst = _file_read_dst(__pfr ,__buf ,__len);
+    if(__dst == NULL)
         return -FILE_ERROR;
 
-    __pfr->ret = pread(__pfr->fd ,__pfr->data ,__len ,__ofs);    
+    __pfr->ret = pread(__pfr->fd ,__dst ,__len ,__ofs);    
     if(__pfr->ret < 0)
     {
         PRINT_ERROR();
         return -FILE_ERROR;
     }
+    _file_read_end(__pfr ,__dst);
 
     if(_file_get_info(__pfr) == -FILE_ERROR)
         return -FILE_ERROR;
@@ -954,6 +1634,53 @@ int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
 
     return __pfr->ret;
 }
+
+/**
+ * @func   _file_pread
+ * @brief  从文件中按指定偏移读取数据（不影响文件当前偏移）。
+ *
+ * @details
+ *  使用 pread() 系统调用从文件描述符指定的偏移处读取 `len` 字节数据，
+ *  读取内容保存至 `pfr->data` 缓冲区。该操作不会改变文件描述符的当前偏移量。
+ *
+ *  若读取超出文件末尾，读取长度将被自动裁剪为：`文件大小 - ofs`。
+ *  若读取失败、参数非法或元信息更新失败，返回 -FILE_ERROR。
+ *
+ * @param[in,out] __pfr   指向目标文件结构体 _file_t 的指针，必须已打开。
+ * @param[in]     __ofs   起始读取偏移（文件内的位置）。
+ * @param[in]     __len   要读取的字节数（> 0）。
+ *
+ * @retval >0          实际成功读取的字节数。
+ * @retval -FILE_ERROR 出现错误（如文件未打开、偏移非法、IO失败等）。
+ *
+ * @note
+ *  - `pfr->data` 为复用缓冲区，容量不足时按 2 倍扩容，调用者无需释放旧内存。
+ *  - 本函数会更新 `pfr` 中的元信息（如大小、偏移、权限等）。
+ *  - 与 `read()` 不同，`pread()` 是线程安全的，不影响进程共享文件偏移。
+ */
+int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
+{
+    return _file_pread_common(__pfr ,NULL ,__ofs ,__len);
+}
+
+/**
+ * @func   _file_pread_into
+ * @brief  与 _file_pread 相同，但数据直接读入调用者提供的缓冲区。
+ *
+ * @param[in,out] __pfr   指向目标文件结构体 _file_t 的指针，必须已打开。
+ * @param[out]    __buf   目标缓冲区，容量不小于 __len，不能为 NULL。
+ * @param[in]     __ofs   起始读取偏移。
+ * @param[in]     __len   要读取的字节数（> 0）。
+ *
+ * @return 实际读取的字节数，失败返回 -FILE_ERROR。
+ */
+int _file_pread_into(_file_t *__pfr ,void *__buf ,off_t __ofs ,size_t __len)
+{
+    if(__buf == NULL)
+        return -FILE_ERROR;
+
+    return _file_pread_common(__pfr ,__buf ,__ofs ,__len);
+}
  
  /**
   * @name  _file_pwrite
@@ -987,11 +1714,21 @@ int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
      printf("get %s file offset: %ld bytes\n" ,pfw->__pathname ,pfw->ofs);
  #endif
  
-     pfw->ret = pwrite(pfw->fd ,data ,len ,ofs);
+     if((pfw->op & FILE_OP_DIRECT) == FILE_OP_DIRECT)
+         pfw->ret = _file_pwrite_direct(pfw ,data ,len ,ofs);
+     else
+         pfw->ret = pwrite(pfw->fd ,data ,len ,ofs);
      if(pfw->ret == -1){
          PRINT_ERROR();
          return -FILE_ERROR;
      }
+
+     /* 缓存模式：仅更新缓存的文件大小，偏移量不受 pwrite 影响 */
+     if((pfw->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+     {
+         _file_update_size_cached(pfw ,ofs + pfw->ret);
+         return pfw->ret;
+     }
      
      if(_file_get_info(pfw) == -FILE_ERROR)
          return -FILE_ERROR;
@@ -1000,6 +1737,174 @@ int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
      return pfw->ret;
  }
  
+/**
+ * @name  _file_iov_check
+ * @brief 校验 iovec 数组参数。
+ */
+static int _file_iov_check(_file_t *pf ,const struct iovec *iov ,int iovcnt)
+{
+    if(pf == NULL || pf->fd < 0 || iov == NULL || iovcnt <= 0 || iovcnt > IOV_MAX)
+        return -FILE_ERROR;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_iov_error
+ * @brief 向量 I/O 失败处理：RWF_NOWAIT 下的 EAGAIN 属于正常情况，不打印错误。
+ */
+static int _file_iov_error(_file_t *pf)
+{
+    pf->ret = -1;
+    if(errno != EAGAIN)
+        PRINT_ERROR();
+    return -FILE_ERROR;
+}
+
+/**
+ * @name  _file_readv
+ * @brief 从指定位置分散读取数据到多个缓冲区（readv）。
+ *
+ * 定位规则与 _file_read 相同，读取后累加 pf->ofs。与缓存模式一样，偏移由封装层维护，
+ * 每次调用不再执行 stat/lseek/fcntl，也不打印文件信息。
+ *
+ * @param[in,out] pf      已打开的文件结构体指针。
+ * @param[in]     iov     缓冲区数组。
+ * @param[in]     iovcnt  缓冲区个数（1 ~ IOV_MAX）。
+ * @param[in]     ofs     偏移量。
+ * @param[in]     whence  SEEK_SET / SEEK_CUR / SEEK_END。
+ *
+ * @return 实际读取的总字节数（0 表示文件尾），失败返回 -FILE_ERROR。
+ */
+int _file_readv(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int whence)
+{
+    if(_file_iov_check(pf ,iov ,iovcnt) == -FILE_ERROR ||
+            (whence != SEEK_CUR && whence != SEEK_SET && whence != SEEK_END))
+        return -FILE_ERROR;
+
+    if(_file_seek_cached(pf ,ofs ,whence) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    pf->ret = readv(pf->fd ,iov ,iovcnt);
+    if(pf->ret < 0)
+        return _file_iov_error(pf);
+
+    pf->ofs += pf->ret;
+    return pf->ret;
+}
+
+/**
+ * @name  _file_writev
+ * @brief 将多个缓冲区的数据一次性聚集写入文件（writev）。
+ *
+ * 用于由头部、负载、尾部等多段组成的记录，省去拼接时的 memcpy 或多次系统调用。
+ * 偏移与文件大小的维护与缓存模式的 _file_write 一致：O_APPEND 时不设置偏移，
+ * 写入后累加 pf->ofs 并更新 fst->st.st_size，不执行 stat。
+ *
+ * @param[in,out] pf      已打开的文件结构体指针。
+ * @param[in]     iov     缓冲区数组。
+ * @param[in]     iovcnt  缓冲区个数（1 ~ IOV_MAX）。
+ * @param[in]     ofs     偏移量（O_APPEND 打开时忽略）。
+ * @param[in]     whence  SEEK_SET / SEEK_CUR / SEEK_END。
+ *
+ * @return 实际写入的总字节数，失败返回 -FILE_ERROR。
+ */
+int _file_writev(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int whence)
+{
+    if(_file_iov_check(pf ,iov ,iovcnt) == -FILE_ERROR ||
+            (whence != SEEK_CUR && whence != SEEK_SET && whence != SEEK_END))
+        return -FILE_ERROR;
+
+    if((pf->fg & O_APPEND) != O_APPEND)
+    {
+        if(_file_seek_cached(pf ,ofs ,whence) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    pf->ret = writev(pf->fd ,iov ,iovcnt);
+    if(pf->ret < 0)
+        return _file_iov_error(pf);
+
+    _file_update_size_cached(pf ,pf->ofs + pf->ret);
+    pf->ofs = ((pf->fg & O_APPEND) == O_APPEND) ? pf->fst->st.st_size : (pf->ofs + pf->ret);
+    return pf->ret;
+}
+
+/**
+ * @name  _file_preadv2
+ * @brief 按指定偏移分散读取（preadv2），支持 RWF_* 标志。
+ *
+ * @param[in,out] pf      已打开的文件结构体指针。
+ * @param[in]     iov     缓冲区数组。
+ * @param[in]     iovcnt  缓冲区个数（1 ~ IOV_MAX）。
+ * @param[in]     ofs     文件偏移；-1 表示使用并推进当前偏移（同 readv）。
+ * @param[in]     flags   RWF_NOWAIT（数据不在页缓存时立即返回 EAGAIN）、RWF_HIPRI 等，0 为普通读取。
+ *
+ * @return 实际读取的总字节数，失败返回 -FILE_ERROR（RWF_NOWAIT 未就绪时 errno 为 EAGAIN）。
+ *
+ * @note 内核不支持 preadv2（ENOSYS）且 flags 为 0 时自动退回 preadv/readv。
+ */
+int _file_preadv2(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int flags)
+{
+    if(_file_iov_check(pf ,iov ,iovcnt) == -FILE_ERROR || ofs < -1)
+        return -FILE_ERROR;
+
+    pf->ret = preadv2(pf->fd ,iov ,iovcnt ,ofs ,flags);
+    if(pf->ret < 0 && errno == ENOSYS && flags == 0)
+        pf->ret = (ofs == -1) ? readv(pf->fd ,iov ,iovcnt) : preadv(pf->fd ,iov ,iovcnt ,ofs);
+    if(pf->ret < 0)
+        return _file_iov_error(pf);
+
+    if(ofs == -1)
+        pf->ofs += pf->ret;
+    return pf->ret;
+}
+
+/**
+ * @name  _file_pwritev2
+ * @brief 按指定偏移聚集写入（pwritev2），支持 RWF_APPEND/RWF_DSYNC/RWF_NOWAIT 等标志。
+ *
+ * - RWF_APPEND：本次写入追加到文件尾（忽略 ofs），无需以 O_APPEND 打开；
+ * - RWF_DSYNC ：本次写入按 O_DSYNC 语义完成后返回，无需对整个 fd 设置同步标志；
+ * - RWF_NOWAIT：会阻塞时立即返回 EAGAIN。
+ *
+ * 写入后只更新缓存的文件大小；ofs 为 -1 时使用并推进当前偏移。
+ *
+ * @param[in,out] pf      已打开的文件结构体指针。
+ * @param[in]     iov     缓冲区数组。
+ * @param[in]     iovcnt  缓冲区个数（1 ~ IOV_MAX）。
+ * @param[in]     ofs     文件偏移；-1 表示使用当前偏移。
+ * @param[in]     flags   RWF_* 按位组合，0 为普通写入。
+ *
+ * @return 实际写入的总字节数，失败返回 -FILE_ERROR（RWF_NOWAIT 未就绪时 errno 为 EAGAIN）。
+ *
+ * @note 内核不支持 pwritev2（ENOSYS）且 flags 为 0 时自动退回 pwritev/writev。
+ */
+int _file_pwritev2(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int flags)
+{
+    if(_file_iov_check(pf ,iov ,iovcnt) == -FILE_ERROR || ofs < -1)
+        return -FILE_ERROR;
+
+    pf->ret = pwritev2(pf->fd ,iov ,iovcnt ,ofs ,flags);
+    if(pf->ret < 0 && errno == ENOSYS && flags == 0)
+        pf->ret = (ofs == -1) ? writev(pf->fd ,iov ,iovcnt) : pwritev(pf->fd ,iov ,iovcnt ,ofs);
+    if(pf->ret < 0)
+        return _file_iov_error(pf);
+
+    /* RWF_APPEND 与 O_APPEND 一样写在文件尾：新大小由原大小累加，与 pf->ofs 无关 */
+    int __append = ((flags & RWF_APPEND) == RWF_APPEND) || ((pf->fg & O_APPEND) == O_APPEND);
+    if(__append){
+        pf->fst->st.st_size += pf->ret;
+        pf->stale = 1;
+    }
+    else
+        _file_update_size_cached(pf ,((ofs == -1) ? pf->ofs : ofs) + pf->ret);
+
+    /* 追加写入后内核把当前偏移移到文件尾 */
+    if(ofs == -1)
+        pf->ofs = __append ? pf->fst->st.st_size : (pf->ofs + pf->ret);
+    return pf->ret;
+}
+ 
  /**
   * @name  _file_cpfd
   * @brief 复制源文件结构体的文件描述符到目标结构体，支持 dup/dup2/fcntl 模式。
@@ -1051,6 +1956,431 @@ int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len)
      }
      return FILE_EOK;
  }
+
+/**
+ * @enum  _file_copy_method
+ * @brief _file_copy 内部使用的拷贝方式，按优先级从高到低排列，失败时依次降级
+ */
+enum _file_copy_method
+{
+    FILE_COPY_RANGE = 0,    ///< copy_file_range：同一文件系统内由内核（或文件系统 reflink）完成
+    FILE_COPY_SENDFILE,     ///< sendfile：源可 mmap，目标为任意 fd（文件/socket/管道）
+    FILE_COPY_SPLICE,       ///< splice：源或目标为管道
+    FILE_COPY_RW            ///< read/write 循环，使用可复用缓冲区
+};
+
+/**
+ * @name  _file_copy_unsupported
+ * @brief 判断错误码是否表示"当前拷贝方式不适用"，是则降级到下一种方式。
+ */
+static int _file_copy_unsupported(int err)
+{
+    return (err == EXDEV || err == EINVAL || err == ENOSYS || err == EOPNOTSUPP ||
+            err == EBADF || err == ESPIPE);
+}
+
+/**
+ * @name  _file_copy_write_all
+ * @brief 将缓冲区完整写入 fd，处理部分写入；非阻塞目标返回 EAGAIN 时等待可写。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR（errno 保留）。
+ */
+static int _file_copy_write_all(int fd ,const char *buf ,size_t len)
+{
+    while(len > 0)
+    {
+        ssize_t __w = write(fd ,buf ,len);
+        if(__w < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno == EAGAIN)
+            {
+                struct pollfd __pfd = {.fd = fd ,.events = POLLOUT};
+                poll(&__pfd ,1 ,-1);
+                continue;
+            }
+            return -FILE_ERROR;
+        }
+        buf += __w;
+        len -= __w;
+    }
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_copy_step
+ * @brief 以指定方式拷贝一段数据。
+ *
+ * @param[in]     method  拷贝方式（enum _file_copy_method）。
+ * @param[in]     src     源文件对象，FILE_COPY_RW 时其 data 缓冲区用作中转。
+ * @param[in,out] off     源偏移，NULL 表示源不可定位（管道/socket），使用当前位置。
+ * @param[in]     out     目标 fd。
+ * @param[in]     n       本次最多拷贝的字节数。
+ *
+ * @return 拷贝的字节数，0 表示源已到文件尾，-1 表示失败（errno 保留）。
+ */
+static ssize_t _file_copy_step(int method ,_file_t *src ,loff_t *off ,int out ,size_t n)
+{
+    ssize_t __r = -1;
+
+    switch(method)
+    {
+        case FILE_COPY_RANGE:
+            __r = copy_file_range(src->fd ,off ,out ,NULL ,n ,0);
+            break;
+
+        case FILE_COPY_SENDFILE:
+            if(off == NULL)
+                __r = sendfile(out ,src->fd ,NULL ,n);
+            else
+            {
+                off_t __o = (off_t)*off;
+                __r = sendfile(out ,src->fd ,&__o ,n);
+                *off = __o;
+            }
+            break;
+
+        case FILE_COPY_SPLICE:
+            __r = splice(src->fd ,off ,out ,NULL ,n ,SPLICE_F_MOVE);
+            break;
+
+        case FILE_COPY_RW:
+            if(n > FILE_COPY_BUF_SIZE)
+                n = FILE_COPY_BUF_SIZE;
+            if(_file_data_reserve(&src->data ,&src->cap ,n) == -FILE_ERROR){
+                errno = ENOMEM;
+                return -1;
+            }
+            __r = (off == NULL) ? read(src->fd ,src->data ,n) : pread(src->fd ,src->data ,n ,*off);
+            if(__r > 0)
+            {
+                if(_file_copy_write_all(out ,src->data ,__r) == -FILE_ERROR)
+                    return -1;
+                if(off != NULL)
+                    *off += __r;
+            }
+            break;
+    }
+
+    return __r;
+}
+
+/**
+ * @name  _file_copy
+ * @brief 将源文件 [off, off + len) 范围的数据拷贝到目标（文件、管道或 socket）。
+ *
+ * 数据尽量不经过用户空间，依次尝试：
+ *  1. copy_file_range：源、目标均为普通文件（目标非 O_APPEND）；同一文件系统上可由
+ *     文件系统直接完成（reflink/服务端拷贝），跨文件系统时内核内部拷贝；
+ *  2. sendfile：源支持 mmap（普通文件），目标可为文件、socket 或管道；
+ *  3. splice：源或目标为管道；
+ *  4. read/write 循环：使用源对象的 data 缓冲区（FILE_COPY_BUF_SIZE，跨调用复用）中转。
+ * 某种方式返回"不支持"类错误（EXDEV/EINVAL/ENOSYS/EOPNOTSUPP/EBADF/ESPIPE）时自动降级。
+ *
+ * @param[in,out] src  源文件对象（需可读）。按 pread 语义读取，源的偏移 ofs 不变；
+ *                     源为管道/socket 时忽略 off，从当前位置读取。
+ * @param[in,out] dst  目标对象（需可写），从其当前偏移写入并推进偏移。
+ *                     管道/socket 等非路径对象可用 FILE_OP_CACHE + _file_attach_fd 关联。
+ * @param[in]     off  源起始偏移。
+ * @param[in]     len  拷贝长度，0 表示拷贝到源文件尾。
+ *
+ * @return 实际拷贝的字节数（同时保存在 dst->ret），失败返回 -FILE_ERROR。
+ *
+ * @note 目标为非阻塞 socket/管道时，遇到 EAGAIN 即结束并返回已拷贝字节数；
+ *       第一块就 EAGAIN 时返回 0，errno 保持为 EAGAIN，调用者可据此与源文件尾区分。
+ */
+ssize_t _file_copy(_file_t *src ,_file_t *dst ,off_t off ,size_t len)
+{
+    if(src == NULL || dst == NULL || src->fd < 0 || dst->fd < 0 || off < 0)
+        return -FILE_ERROR;
+
+    struct stat __sst ,__dst;
+    if(fstat(src->fd ,&__sst) == -1 || fstat(dst->fd ,&__dst) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    int __seekable = S_ISREG(__sst.st_mode) || S_ISBLK(__sst.st_mode);
+    int __method = FILE_COPY_SENDFILE;
+    if(S_ISREG(__sst.st_mode) && S_ISREG(__dst.st_mode) && (dst->fg & O_APPEND) != O_APPEND)
+        __method = FILE_COPY_RANGE;
+    else if(!__seekable)
+        __method = FILE_COPY_SPLICE;
+
+    loff_t __off = off;
+    size_t __left = len;
+    ssize_t __total = 0;
+    int __again = 0;
+
+    while(len == 0 || __left > 0)
+    {
+        size_t __n = (len == 0 || __left > FILE_COPY_CHUNK) ? FILE_COPY_CHUNK : __left;
+        ssize_t __r = _file_copy_step(__method ,src ,__seekable ? &__off : NULL ,dst->fd ,__n);
+        if(__r < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno == EAGAIN){
+                __again = 1;
+                break;
+            }
+            if(__method != FILE_COPY_RW && _file_copy_unsupported(errno)){
+                __method++;
+                continue;
+            }
+            PRINT_ERROR();
+            return -FILE_ERROR;
+        }
+        if(__r == 0)
+            break;
+
+        __total += __r;
+        __left -= (__left >= (size_t)__r) ? (size_t)__r : __left;
+    }
+
+    dst->ret = __total;
+    if(S_ISREG(__dst.st_mode) && __total > 0)
+    {
+        if((dst->op & FILE_OP_CACHE) == FILE_OP_CACHE)
+        {
+            _file_update_size_cached(dst ,dst->ofs + __total);
+            dst->ofs = ((dst->fg & O_APPEND) == O_APPEND) ? dst->fst->st.st_size : (dst->ofs + __total);
+        }
+        else if(_file_get_info(dst) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    if(__again)
+        errno = EAGAIN;
+    return __total;
+}
+
+/**
+ * @name  _file_extent_begin
+ * @brief 初始化数据区段迭代器，用于按 SEEK_DATA/SEEK_HOLE 跳过稀疏文件中的空洞。
+ *
+ * @param[in]  __pf     已打开的文件对象。
+ * @param[out] __it     迭代器。
+ * @param[in]  __start  起始偏移。
+ * @param[in]  __end    结束偏移（不含），0 表示文件尾。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_extent_begin(_file_t *__pf ,_file_extent_iter_t *__it ,off_t __start ,off_t __end)
+{
+    if(__pf == NULL || __it == NULL || __pf->fd < 0 || __start < 0 || __end < 0)
+        return -FILE_ERROR;
+
+    struct stat __st;
+    if(fstat(__pf->fd ,&__st) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    __it->pf = __pf;
+    __it->pos = __start;
+    __it->end = (__end == 0 || __end > __st.st_size) ? __st.st_size : __end;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_extent_next
+ * @brief 获取下一个数据区段（非空洞部分）。
+ *
+ * 通过 lseek(SEEK_DATA) 找到下一段数据的起点，再用 lseek(SEEK_HOLE) 找到其终点；
+ * 文件系统不支持 SEEK_DATA 时，剩余范围整体作为一个数据区段返回。
+ * 迭代过程中会临时移动内核文件偏移，返回前恢复为 pf->ofs。
+ *
+ * @param[in,out] __it   迭代器。
+ * @param[out]    __ext  数据区段。
+ *
+ * @return 1 表示取得一个区段，0 表示已无数据区段，失败返回 -FILE_ERROR。
+ */
+int _file_extent_next(_file_extent_iter_t *__it ,_file_extent_t *__ext)
+{
+    if(__it == NULL || __ext == NULL || __it->pf == NULL)
+        return -FILE_ERROR;
+
+    if(__it->pos >= __it->end)
+        return 0;
+
+    _file_t *__pf = __it->pf;
+    int __ret = 1;
+
+    off_t __data = lseek(__pf->fd ,__it->pos ,SEEK_DATA);
+    off_t __hole;
+    if(__data == -1)
+    {
+        if(errno == ENXIO){
+            /* 剩余部分全部是空洞 */
+            __it->pos = __it->end;
+            __ret = 0;
+            goto restore;
+        }
+        if(errno != EINVAL && errno != EOPNOTSUPP){
+            PRINT_ERROR();
+            return -FILE_ERROR;
+        }
+        /* 不支持 SEEK_DATA：视为全部是数据 */
+        __data = __it->pos;
+        __hole = __it->end;
+    }
+    else
+    {
+        __hole = lseek(__pf->fd ,__data ,SEEK_HOLE);
+        if(__hole == -1){
+            PRINT_ERROR();
+            return -FILE_ERROR;
+        }
+    }
+
+    if(__data >= __it->end){
+        __it->pos = __it->end;
+        __ret = 0;
+        goto restore;
+    }
+
+    if(__hole > __it->end)
+        __hole = __it->end;
+
+    __ext->ofs = __data;
+    __ext->len = __hole - __data;
+    __it->pos = __hole;
+
+restore:
+    if(lseek(__pf->fd ,__pf->ofs ,SEEK_SET) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    return __ret;
+}
+
+/**
+ * @name  _file_fallocate
+ * @brief fallocate 封装：为文件预分配或释放磁盘空间。
+ *
+ * @param[in,out] __pf    已打开的文件对象（需可写）。
+ * @param[in]     __mode  0（预分配并在需要时扩展文件大小）或 FALLOC_FL_* 组合。
+ * @param[in]     __ofs   起始偏移。
+ * @param[in]     __len   长度。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ *
+ * @note 预分配可避免循环存储文件在运行中因空间不足写入失败，并减少碎片。
+ */
+int _file_fallocate(_file_t *__pf ,int __mode ,off_t __ofs ,off_t __len)
+{
+    if(__pf == NULL || __pf->fd < 0 || __ofs < 0 || __len <= 0)
+        return -FILE_ERROR;
+
+    if(fallocate(__pf->fd ,__mode ,__ofs ,__len) == -1){
+        if(errno != EOPNOTSUPP)
+            PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    if((__mode & FALLOC_FL_KEEP_SIZE) != FALLOC_FL_KEEP_SIZE && __ofs + __len > __pf->fst->st.st_size)
+        __pf->fst->st.st_size = __ofs + __len;
+    __pf->stale = 1;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_punch_hole
+ * @brief 在文件中打洞：释放 [ofs, ofs + len) 的磁盘块，读取时返回 0，文件大小不变。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_punch_hole(_file_t *__pf ,off_t __ofs ,off_t __len)
+{
+    return _file_fallocate(__pf ,FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE ,__ofs ,__len);
+}
+
+/**
+ * @name  _file_zero_range
+ * @brief 将 [ofs, ofs + len) 置零，不写入数据块（FALLOC_FL_ZERO_RANGE）。
+ *
+ * 文件系统不支持 ZERO_RANGE 时退回打洞，范围超出文件尾的部分再用 ftruncate 扩展。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_zero_range(_file_t *__pf ,off_t __ofs ,off_t __len)
+{
+    if(_file_fallocate(__pf ,FALLOC_FL_ZERO_RANGE ,__ofs ,__len) == FILE_EOK)
+        return FILE_EOK;
+
+    if(__pf == NULL || errno != EOPNOTSUPP)
+        return -FILE_ERROR;
+
+    if(_file_punch_hole(__pf ,__ofs ,__len) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    if(__ofs + __len > __pf->fst->st.st_size)
+    {
+        if(ftruncate(__pf->fd ,__ofs + __len) == -1){
+            PRINT_ERROR();
+            return -FILE_ERROR;
+        }
+        __pf->fst->st.st_size = __ofs + __len;
+    }
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_sparse_copy
+ * @brief 保留空洞的整文件拷贝：只拷贝数据区段，空洞在目标中保持为空洞。
+ *
+ * 先将目标截断为空，再逐个遍历源文件的数据区段，将目标定位到相同偏移后调用
+ * _file_copy 拷贝，最后将目标扩展到源文件大小，以还原末尾的空洞。
+ * 目标中原有的数据全部丢弃，源文件空洞处不会残留旧内容。
+ *
+ * @param[in,out] src  源文件对象（需可读）。
+ * @param[in,out] dst  目标文件对象（普通文件，需可写，不能以 O_APPEND 打开）。
+ *
+ * @return 实际拷贝的数据字节数（不含空洞），失败返回 -FILE_ERROR。
+ */
+ssize_t _file_sparse_copy(_file_t *src ,_file_t *dst)
+{
+    if(src == NULL || dst == NULL || (dst->fg & O_APPEND) == O_APPEND)
+        return -FILE_ERROR;
+
+    _file_extent_iter_t __it;
+    _file_extent_t __ext;
+    ssize_t __total = 0;
+    int __ret;
+
+    if(_file_extent_begin(src ,&__it ,0 ,0) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    if(ftruncate(dst->fd ,0) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    dst->fst->st.st_size = 0;
+
+    while((__ret = _file_extent_next(&__it ,&__ext)) == 1)
+    {
+        if(_file_set_offset(dst ,__ext.ofs ,SEEK_SET) == -FILE_ERROR)
+            return -FILE_ERROR;
+
+        ssize_t __n = _file_copy(src ,dst ,__ext.ofs ,__ext.len);
+        if(__n == -FILE_ERROR)
+            return -FILE_ERROR;
+        __total += __n;
+    }
+    if(__ret == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    if(ftruncate(dst->fd ,__it.end) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    dst->fst->st.st_size = __it.end;
+    dst->stale = 1;
+    dst->ret = __total;
+    return __total;
+}
  
 /**
  * @name  _file_status_fcntl
@@ -1236,118 +2566,688 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
 }
 
  /**
-  * @name _file_print
-  * @brief 从指定偏移位置开始读取并打印文件内容（以文本形式输出）。
+  * @name _file_dump_hex_digits
+  * @brief 十六进制编码查表，每个字节通过高/低 4 位各查一次表得到两个字符。
+  */
+ static const char _file_dump_hex_digits[] = "0123456789abcdef";
+ static const char _file_dump_HEX_digits[] = "0123456789ABCDEF";
+
+ /**
+  * @name _file_dump_hex
+  * @brief FILE_DUMP_HEX 格式：每字节输出 "0xXX "（与原 _file_print_u16 一致）。
   *
-  * 该函数会先保存当前文件偏移位置，然后从指定偏移 `ofs` 开始，最多读取 `len` 字节内容。
-  * 内容读取成功后，按字符方式输出到标准输出（适用于打印文本类文件）。
-  * 最后恢复原始偏移位置，并打印基本信息（读取字节数、文件大小、最终偏移）。
+  * @return 写入 out 的字符数（每字节 5 个）。
+  */
+ static size_t _file_dump_hex(char *out ,const unsigned char *in ,size_t n)
+ {
+     char *__o = out;
+     for(size_t __i = 0; __i < n; __i++)
+     {
+         __o[0] = '0';
+         __o[1] = 'x';
+         __o[2] = _file_dump_HEX_digits[in[__i] >> 4];
+         __o[3] = _file_dump_HEX_digits[in[__i] & 0x0f];
+         __o[4] = ' ';
+         __o += 5;
+     }
+     return (size_t)(__o - out);
+ }
+
+ /**
+  * @name _file_dump_xxd_line
+  * @brief FILE_DUMP_XXD 格式：输出一行（最多 16 字节），布局与 xxd 相同：
+  *        "00000010: 6865 6c6c 6f20 776f 726c 640a 0000 0000  hello world.....\n"
   *
-  * @param pfp   指向已打开的 _file_t 结构体的指针。
-  * @param ofs   从该偏移位置开始读取（相对于文件开头，SEEK_SET）。
-  * @param len   要读取并打印的最大字节数。
+  * @return 写入 out 的字符数（不超过 FILE_DUMP_XXD_LINE）。
+  */
+ static size_t _file_dump_xxd_line(char *out ,off_t ofs ,const unsigned char *in ,size_t n)
+ {
+     char *__o = out;
+     unsigned long long __a = (unsigned long long)ofs;
+
+     for(int __i = 7; __i >= 0; __i--)
+         __o[7 - __i] = _file_dump_hex_digits[(__a >> (__i * 4)) & 0x0f];
+     __o += 8;
+     *__o++ = ':';
+
+     for(size_t __i = 0; __i < 16; __i++)
+     {
+         if((__i & 1) == 0)
+             *__o++ = ' ';
+         if(__i < n){
+             *__o++ = _file_dump_hex_digits[in[__i] >> 4];
+             *__o++ = _file_dump_hex_digits[in[__i] & 0x0f];
+         }else{
+             *__o++ = ' ';
+             *__o++ = ' ';
+         }
+     }
+
+     *__o++ = ' ';
+     *__o++ = ' ';
+     for(size_t __i = 0; __i < n; __i++)
+         *__o++ = (in[__i] >= 0x20 && in[__i] < 0x7f) ? (char)in[__i] : '.';
+     *__o++ = '\n';
+
+     return (size_t)(__o - out);
+ }
+
+ /**
+  * @name _file_dump
+  * @brief 流式转储引擎：从 ofs 开始读取最多 len 字节，按指定格式输出到 out_fd。
   *
-  * @return 成功返回 FILE_EOK;，失败返回 -FILE_ERROR。
+  * 输入按 FILE_DUMP_IN_BLOCK 分块 pread（不改变文件偏移），格式化结果写入 FILE_DUMP_OUT_BLOCK
+  * 大小的输出块，块满后一次 write 输出；输入与输出块共用 pf->data 复用缓冲区，
+  * 任意长度的转储都不会按总长度分配内存。
   *
-  * @note
-  * - 如果请求打印的长度超过文件末尾，则会自动调整为剩余可读字节数；
-  * - 如果读取失败，函数将立即返回错误，不会修改原文件偏移；
-  * - 适用于文本内容打印，如需打印二进制建议使用十六进制打印方式；
-  * - 打印完成后恢复原始偏移位置，避免影响后续读写。
+  * @param pf      指向已打开的 _file_t 结构体的指针。
+  * @param ofs     起始偏移（相对于文件开头）。
+  * @param len     最多转储的字节数，0 表示到文件尾；超出文件尾时自动截止。
+  * @param mode    输出格式：
+  *                - FILE_DUMP_TEXT：原样输出（文本文件）；
+  *                - FILE_DUMP_HEX ：每字节 "0xXX "；
+  *                - FILE_DUMP_XXD ：xxd 风格，每行 16 字节，含偏移与 ASCII 列。
+  * @param out_fd  输出文件描述符（如 STDOUT_FILENO）。
+  *
+  * @return 实际转储的输入字节数（同时保存在 pf->ret），失败返回 -FILE_ERROR。
+  *
+  * @note 输出使用 write 直接写 fd，若之前通过 stdio 输出到同一 fd，调用前需 fflush。
   */
- int _file_print(_file_t *pfp ,off_t ofs ,size_t len)
+ ssize_t _file_dump(_file_t *pf ,off_t ofs ,size_t len ,int mode ,int out_fd)
  {
-     if(pfp == NULL)
-         return -FILE_ERROR;
- 
-     off_t ofs_k = pfp->ofs;
- 
-     if(_file_set_offset(pfp ,ofs ,SEEK_SET) == -FILE_ERROR)
+     if(pf == NULL || pf->fd < 0 || ofs < 0 || out_fd < 0 ||
+             (mode != FILE_DUMP_TEXT && mode != FILE_DUMP_HEX && mode != FILE_DUMP_XXD))
          return -FILE_ERROR;
-     
-    if(_file_get_properties(pfp->__pathname ,pfp->fst)  == -FILE_ERROR)
-         return -FILE_ERROR;
-     
-     len = (len > (pfp->fst->st.st_size - pfp->ofs))?  (pfp->fst->st.st_size - pfp->ofs): len;
- 
-     if(_file_data_init(&pfp->data ,len) == -FILE_ERROR)
+
+     if(_file_data_reserve(&pf->data ,&pf->cap ,FILE_DUMP_IN_BLOCK + FILE_DUMP_OUT_BLOCK) == -FILE_ERROR)
          return -FILE_ERROR;
- 
-     pfp->ret = read(pfp->fd ,pfp->data ,len);    
-     if(pfp->ret < 0){
+
+     unsigned char *__in = (unsigned char *)pf->data;
+     char *__out = (char *)pf->data + FILE_DUMP_IN_BLOCK;
+     size_t __used = 0;
+     size_t __total = 0;
+
+     while(len == 0 || __total < len)
+     {
+         size_t __want = FILE_DUMP_IN_BLOCK;
+         if(len != 0 && len - __total < __want)
+             __want = len - __total;
+
+         ssize_t __n = pread(pf->fd ,__in ,__want ,ofs + (off_t)__total);
+         if(__n < 0){
+             if(errno == EINTR)
+                 continue;
+             PRINT_ERROR();
+             return -FILE_ERROR;
+         }
+         if(__n == 0)
+             break;
+
+         if(mode == FILE_DUMP_TEXT)
+         {
+             if(_file_copy_write_all(out_fd ,(const char *)__in ,__n) == -FILE_ERROR){
+                 PRINT_ERROR();
+                 return -FILE_ERROR;
+             }
+             __total += __n;
+             continue;
+         }
+
+         /* FILE_DUMP_IN_BLOCK 为 16 的倍数，XXD 的行只会在文件尾不满 16 字节 */
+         for(size_t __i = 0; __i < (size_t)__n; )
+         {
+             size_t __step = (mode == FILE_DUMP_XXD) ? 16 : FILE_DUMP_HEX_STEP;
+             if(__step > (size_t)__n - __i)
+                 __step = (size_t)__n - __i;
+
+             size_t __need = (mode == FILE_DUMP_XXD) ? FILE_DUMP_XXD_LINE : (__step * 5);
+             if(__used + __need > FILE_DUMP_OUT_BLOCK)
+             {
+                 if(_file_copy_write_all(out_fd ,__out ,__used) == -FILE_ERROR){
+                     PRINT_ERROR();
+                     return -FILE_ERROR;
+                 }
+                 __used = 0;
+             }
+
+             if(mode == FILE_DUMP_XXD)
+                 __used += _file_dump_xxd_line(__out + __used ,ofs + (off_t)(__total + __i) ,__in + __i ,__step);
+             else
+                 __used += _file_dump_hex(__out + __used ,__in + __i ,__step);
+             __i += __step;
+         }
+         __total += __n;
+     }
+
+     if(__used > 0 && _file_copy_write_all(out_fd ,__out ,__used) == -FILE_ERROR){
          PRINT_ERROR();
          return -FILE_ERROR;
      }
- 
+
+     pf->ret = __total;
+     return (ssize_t)__total;
+ }
+
+ /**
+  * @name _file_print_mode
+  * @brief _file_print/_file_print_u16 的公共实现：打印标题、转储内容并打印文件信息。
+  */
+ static int _file_print_mode(_file_t *pfp ,off_t ofs ,size_t len ,int mode)
+ {
+     if(pfp == NULL || len == 0)
+         return -FILE_ERROR;
+
      printf("---------- print the contents of file: %s ----------\n", pfp->__pathname);
-     for (int i = 0; i < pfp->ret; ++i) {
-         putchar((char)((unsigned char *)pfp->data)[i]);
-     }
- 
-     printf("\n");
-     if(_file_set_offset(pfp ,ofs_k ,SEEK_SET) == -FILE_ERROR)
+     fflush(stdout);
+
+     if(_file_dump(pfp ,ofs ,len ,mode ,STDOUT_FILENO) == -FILE_ERROR)
          return -FILE_ERROR;
-     
+
+     printf("\n");
+     if((pfp->op & FILE_OP_CACHE) != FILE_OP_CACHE)
+     {
+         if(_file_get_properties(pfp->__pathname ,pfp->fst) == -FILE_ERROR)
+             return -FILE_ERROR;
+     }
+
      PRINT_FILE_INFO("print" ,pfp);
      return FILE_EOK;
  }
+
+ /**
+  * @name _file_print
+  * @brief 从指定偏移位置开始读取并打印文件内容（以文本形式输出）。
+  *
+  * 基于 _file_dump(FILE_DUMP_TEXT) 实现：分块读取、整块输出，文件偏移不受影响，
+  * 不再按打印长度分配缓冲区。打印完成后输出基本信息（读取字节数、文件大小、偏移）。
+  *
+  * @param pfp   指向已打开的 _file_t 结构体的指针。
+  * @param ofs   从该偏移位置开始读取（相对于文件开头，SEEK_SET）。
+  * @param len   要读取并打印的最大字节数。
+  *
+  * @return 成功返回 FILE_EOK;，失败返回 -FILE_ERROR。
+  *
+  * @note
+  * - 如果请求打印的长度超过文件末尾，则打印到文件末尾为止；
+  * - 适用于文本内容打印，二进制内容请使用 _file_print_u16 或 _file_dump(FILE_DUMP_XXD)。
+  */
+ int _file_print(_file_t *pfp ,off_t ofs ,size_t len)
+ {
+     return _file_print_mode(pfp ,ofs ,len ,FILE_DUMP_TEXT);
+ }
  
  /**
   * @name _file_print_u16
   * @brief 以十六进制格式打印文件中指定位置的数据（按字节输出）。
   *
-  * 该函数从指定偏移位置开始读取文件内容，并以十六进制形式（0xXX）逐字节打印，适用于调试二进制文件内容。
-  * 打印完成后会恢复文件原始偏移位置，确保调用前后的状态一致。
+  * 基于 _file_dump(FILE_DUMP_HEX) 实现，逐字节以 “0xXX ” 形式输出，适用于调试二进制文件内容。
+  * 查表编码后整块 write，文件偏移不受影响。
   *
   * @param pfp  指向 _file_t 文件结构体的指针，需确保文件已打开。
   * @param ofs  打印起始偏移位置（从 ofs 字节处开始读取）。
   * @param len  要读取并打印的最大字节数（若超出文件剩余大小则截断）。
   *
-  * @return FILE_EOK 成功；-FILE_ERROR 失败（包括偏移设置失败、读取失败等）。
-  *
-  * @note
-  * - 本函数不改变文件内容，仅用于打印查看。
-  * - 打印格式为 “0xXX”，每字节占一个输出项。
-  * - 文件偏移在打印后会被还原，确保后续读写操作不受影响。
+  * @return FILE_EOK 成功；-FILE_ERROR 失败。
   */
- 
  int _file_print_u16(_file_t *pfp ,off_t ofs ,size_t len)
  {
-     if(pfp == NULL)
-         return -FILE_ERROR;
- 
-     off_t ofs_k = pfp->ofs;
- 
-     if(_file_set_offset(pfp ,ofs ,SEEK_SET) == -FILE_ERROR)
-         return -FILE_ERROR;
-     
-     if(_file_get_properties(pfp->__pathname ,pfp->fst)  == -FILE_ERROR)
-        return -FILE_ERROR;
-     
-     len = (len > (pfp->fst->st.st_size - pfp->ofs))?  (pfp->fst->st.st_size - pfp->ofs): len;
- 
-     if(_file_data_init(&pfp->data ,len) == -FILE_ERROR)
-         return -FILE_ERROR;
- 
-     pfp->ret = read(pfp->fd ,pfp->data ,len);    
-     if(pfp->ret < 0){
-         PRINT_ERROR();
-         return -FILE_ERROR;
-     }
- 
-     printf("---------- print the contents of file: %s ----------\n", pfp->__pathname);
-     unsigned char *p = (unsigned char *)pfp->data;
-     for (int i = 0; i < pfp->ret; ++i)
-         printf("0x%02X ", p[i]);
- 
-     printf("\n");
-     if(_file_set_offset(pfp ,ofs_k ,SEEK_SET) == -FILE_ERROR)
-         return -FILE_ERROR;
-     
-     PRINT_FILE_INFO("print" ,pfp);
-     return FILE_EOK;
+     return _file_print_mode(pfp ,ofs ,len ,FILE_DUMP_HEX);
  }
  
+/******************************************************************************************************************/
+/**
+ * @name  _file_mmap_page_size
+ * @brief 获取系统页大小（首次调用后缓存）。
+ */
+static size_t _file_mmap_page_size(void)
+{
+    static size_t __page = 0;
+    if(__page == 0){
+        long __sz = sysconf(_SC_PAGESIZE);
+        __page = (__sz > 0) ? (size_t)__sz : 4096;
+    }
+    return __page;
+}
+
+/**
+ * @name  _file_mmap_remap
+ * @brief 按文件当前大小重建映射区（文件增长或缩短后调用）。
+ *
+ * 通过一次 fstat 获取最新大小：大小未变化时直接返回；首次映射使用 mmap，
+ * 已有映射使用 mremap(MREMAP_MAYMOVE) 原地扩展或迁移，文件变为空时解除映射。
+ *
+ * @param[in,out] __pf  已通过 _file_mmap_open 打开的文件结构体指针。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ *
+ * @note 映射地址可能改变，之前通过 _file_view 获取的视图全部失效。
+ */
+int _file_mmap_remap(_file_t *__pf)
+{
+    if(__pf == NULL || __pf->fd < 0 || (__pf->op & FILE_OP_MMAP) != FILE_OP_MMAP)
+        return -FILE_ERROR;
+
+    if(fstat(__pf->fd ,&__pf->fst->st) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    __pf->stale = 1;
+
+    size_t __len = (size_t)__pf->fst->st.st_size;
+    if(__len == __pf->map_len)
+        return FILE_EOK;
+
+    if(__len == 0){
+        munmap(__pf->map ,__pf->map_len);
+        __pf->map = NULL;
+        __pf->map_len = 0;
+        return FILE_EOK;
+    }
+
+    void *__map;
+    if(__pf->map == NULL){
+        int __prot = PROT_READ;
+        if((__pf->fg & O_ACCMODE) == O_RDWR)
+            __prot |= PROT_WRITE;
+        __map = mmap(NULL ,__len ,__prot ,MAP_SHARED ,__pf->fd ,0);
+    }
+    else
+        __map = mremap(__pf->map ,__pf->map_len ,__len ,MREMAP_MAYMOVE);
+
+    if(__map == MAP_FAILED){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    __pf->map = __map;
+    __pf->map_len = __len;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_mmap_open
+ * @brief 以内存映射模式打开文件。
+ *
+ * 在 _file_open 的基础上将整个文件以 MAP_SHARED 方式映射到进程地址空间，
+ * 之后通过 _file_view 获取指向映射区的视图，数据不再经过 read() 拷贝到 pf->data，
+ * 页缓存直接被进程共享，扫描大文件时省去一次拷贝和等量的堆内存。
+ *
+ * @param[in,out] __pf  由 _file_init 创建的文件结构体指针。
+ * @param[in]     __fg  打开标志，访问模式须为 O_RDONLY 或 O_RDWR（O_RDWR 时映射可写）。
+ * @param[in]     __md  创建文件时的权限，同 _file_open。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ *
+ * @note
+ * - 自动启用 FILE_OP_CACHE，文件大小由封装层维护；
+ * - 空文件不建立映射（map == NULL），写入或外部增长后由 _file_view/_file_mmap_write 自动映射；
+ * - 关闭时由 _file_close 解除映射。
+ */
+int _file_mmap_open(_file_t *__pf ,int __fg ,mode_t __md)
+{
+    if(__pf == NULL || (__fg & O_ACCMODE) == O_WRONLY)
+        return -FILE_ERROR;
+
+    __pf->op |= (FILE_OP_MMAP | FILE_OP_CACHE);
+    if(_file_open(__pf ,__fg ,__md) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    return _file_mmap_remap(__pf);
+}
+
+/**
+ * @name  _file_view
+ * @brief 获取映射区中一段数据的视图（零拷贝读取）。
+ *
+ * 定位规则与 _file_read 相同，但 SEEK_CUR 相对的是视图游标 pf->map_ofs：根据 __whence
+ * 计算起始位置，取得视图后游标前移 len，因此连续调用 _file_view(pf ,&v ,0 ,SEEK_CUR ,n)
+ * 即可顺序扫描整个文件。
+ * 请求超出当前映射长度或使用 SEEK_END 时会先 _file_mmap_remap，以便看到文件新增的数据。
+ *
+ * @param[in,out] __pf      映射模式打开的文件结构体指针。
+ * @param[out]    __v       输出视图，不能为 NULL。
+ * @param[in]     __ofs     偏移量。
+ * @param[in]     __whence  SEEK_SET / SEEK_CUR / SEEK_END。
+ * @param[in]     __len     期望的视图长度，超出文件尾时自动截短。
+ *
+ * @return 视图实际长度（>=0，0 表示文件尾），失败返回 -FILE_ERROR。
+ *
+ * @note 本函数只维护视图游标，不修改 pf->ofs 与内核中的文件偏移，
+ *       与 _file_read/_file_readv/_file_copy 等按偏移读取的接口互不影响。
+ */
+int _file_view(_file_t *__pf ,_file_view_t *__v ,off_t __ofs ,int __whence ,size_t __len)
+{
+    if(__pf == NULL || __v == NULL || (__pf->op & FILE_OP_MMAP) != FILE_OP_MMAP)
+        return -FILE_ERROR;
+
+    off_t __pos;
+    switch(__whence)
+    {
+        case SEEK_SET: __pos = __ofs; break;
+        case SEEK_CUR: __pos = __pf->map_ofs + __ofs; break;
+        case SEEK_END:
+            /* 相对文件尾定位需要最新大小，与 lseek(SEEK_END) 一样代价为一次系统调用 */
+            if(_file_mmap_remap(__pf) == -FILE_ERROR)
+                return -FILE_ERROR;
+            __pos = (off_t)__pf->map_len + __ofs;
+            break;
+        default:       return -FILE_ERROR;
+    }
+    if(__pos < 0)
+        return -FILE_ERROR;
+
+    if((size_t)__pos + __len > __pf->map_len)
+    {
+        if(_file_mmap_remap(__pf) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    if((size_t)__pos >= __pf->map_len)
+        __len = 0;
+    else if(__len > __pf->map_len - (size_t)__pos)
+        __len = __pf->map_len - (size_t)__pos;
+
+    __v->ptr = (__len > 0) ? (const char *)__pf->map + __pos : NULL;
+    __v->len = __len;
+    __v->ofs = __pos;
+
+    __pf->map_ofs = __pos + __len;
+    __pf->ret = __len;
+    return (int)__len;
+}
+
+/**
+ * @name  _file_madvise
+ * @brief 为映射区的一段范围设置访问模式提示。
+ *
+ * @param[in] __pf      映射模式打开的文件结构体指针。
+ * @param[in] __ofs     起始偏移，内部向下对齐到页边界。
+ * @param[in] __len     范围长度，0 表示到映射区末尾。
+ * @param[in] __advice  file_advice_t 取值。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_madvise(_file_t *__pf ,off_t __ofs ,size_t __len ,int __advice)
+{
+    if(__pf == NULL || __ofs < 0 || (__pf->op & FILE_OP_MMAP) != FILE_OP_MMAP)
+        return -FILE_ERROR;
+
+    if(__pf->map == NULL || (size_t)__ofs >= __pf->map_len)
+        return FILE_EOK;
+
+    size_t __page = _file_mmap_page_size();
+    size_t __start = (size_t)__ofs & ~(__page - 1);
+    size_t __end = (__len == 0 || __len > __pf->map_len - (size_t)__ofs) ?
+                        __pf->map_len : (size_t)__ofs + __len;
+
+    if(madvise((char *)__pf->map + __start ,__end - __start ,__advice) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    return FILE_EOK;
+}
+
+/**
+ * @name  _file_mmap_write
+ * @brief 通过映射区写入数据（memcpy），写入范围超出文件尾时先扩展文件并重建映射。
+ *
+ * 与 _file_pwrite 语义相同：按绝对偏移写入，不改变 pf->ofs。数据写入映射区后即对
+ * 其他进程可见，落盘时机由内核决定，需要持久化时调用 _file_msync。
+ *
+ * @param[in,out] __pf    以 O_RDWR 映射模式打开的文件结构体指针。
+ * @param[in]     __data  待写入数据。
+ * @param[in]     __len   写入长度。
+ * @param[in]     __ofs   文件中的写入偏移。
+ *
+ * @return 实际写入的字节数，失败返回 -FILE_ERROR。
+ */
+int _file_mmap_write(_file_t *__pf ,const void *__data ,size_t __len ,off_t __ofs)
+{
+    if(__pf == NULL || __data == NULL || __ofs < 0 ||
+            (__pf->op & FILE_OP_MMAP) != FILE_OP_MMAP || (__pf->fg & O_ACCMODE) != O_RDWR)
+        return -FILE_ERROR;
+
+    if(__len == 0)
+        return 0;
+
+    size_t __end = (size_t)__ofs + __len;
+    if(__end > __pf->map_len)
+    {
+        if(ftruncate(__pf->fd ,(off_t)__end) == -1){
+            PRINT_ERROR();
+            return -FILE_ERROR;
+        }
+        if(_file_mmap_remap(__pf) == -FILE_ERROR)
+            return -FILE_ERROR;
+    }
+
+    memcpy((char *)__pf->map + __ofs ,__data ,__len);
+    __pf->ret = __len;
+    __pf->stale = 1;
+    return (int)__len;
+}
+
+/**
+ * @name  _file_msync
+ * @brief 将映射区的修改刷回文件。
+ *
+ * @param[in] __pf    映射模式打开的文件结构体指针。
+ * @param[in] __ofs   起始偏移，内部向下对齐到页边界。
+ * @param[in] __len   长度，0 表示到映射区末尾。
+ * @param[in] __sync  非 0 使用 MS_SYNC 等待写回完成；0 使用 MS_ASYNC 仅发起写回。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+int _file_msync(_file_t *__pf ,off_t __ofs ,size_t __len ,int __sync)
+{
+    if(__pf == NULL || __ofs < 0 || (__pf->op & FILE_OP_MMAP) != FILE_OP_MMAP)
+        return -FILE_ERROR;
+
+    if(__pf->map == NULL || (size_t)__ofs >= __pf->map_len)
+        return FILE_EOK;
+
+    size_t __page = _file_mmap_page_size();
+    size_t __start = (size_t)__ofs & ~(__page - 1);
+    size_t __end = (__len == 0 || __len > __pf->map_len - (size_t)__ofs) ?
+                        __pf->map_len : (size_t)__ofs + __len;
+
+    if(msync((char *)__pf->map + __start ,__end - __start ,__sync ? MS_SYNC : MS_ASYNC) == -1){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+    return FILE_EOK;
+}
+
+/******************************************************************************************************************/
+/**
+ * @name  _file_scan_delim
+ * @brief 在 [p, p + n) 中查找分隔符 c，返回首次出现的位置，未找到返回 NULL。
+ *
+ * 按平台选择实现：x86 使用 SSE2 每次比较 16 字节，ARM 使用 NEON 每次比较 16 字节，
+ * 其他平台使用按字（word-at-a-time / SWAR）比较，尾部不足一组的字节逐个比较。
+ */
+static const char *_file_scan_delim(const char *p ,int c ,size_t n)
+{
+    const unsigned char __c = (unsigned char)c;
+
+#if defined(__SSE2__)
+    const __m128i __v = _mm_set1_epi8((char)__c);
+    for(; n >= 16; p += 16 ,n -= 16)
+    {
+        int __m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p) ,__v));
+        if(__m != 0)
+            return p + __builtin_ctz(__m);
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const uint8x16_t __v = vdupq_n_u8(__c);
+    for(; n >= 16; p += 16 ,n -= 16)
+    {
+        uint64x2_t __eq = vreinterpretq_u64_u8(vceqq_u8(vld1q_u8((const uint8_t *)p) ,__v));
+        if((vgetq_lane_u64(__eq ,0) | vgetq_lane_u64(__eq ,1)) != 0)
+            break;      /* 命中的 16 字节交给下面的逐字节比较定位 */
+    }
+#else
+    const unsigned long __ones  = (unsigned long)-1 / 0xff;
+    const unsigned long __highs = __ones * 0x80;
+    const unsigned long __pat   = __ones * __c;
+    for(; n >= sizeof(unsigned long); p += sizeof(unsigned long) ,n -= sizeof(unsigned long))
+    {
+        unsigned long __w;
+        memcpy(&__w ,p ,sizeof(__w));
+        __w ^= __pat;
+        if(((__w - __ones) & ~__w & __highs) != 0)
+            break;      /* 该字中含有分隔符 */
+    }
+#endif
+
+    for(; n > 0; p++ ,n--)
+    {
+        if((unsigned char)*p == __c)
+            return p;
+    }
+    return NULL;
+}
+
+/**
+ * @name  _file_reader_init
+ * @brief 创建流式记录读取器，按分隔符逐条读取文件内容，不需要一次载入整个文件。
+ *
+ * 读取器持有一块滑动缓冲区：已返回的记录被丢弃，剩余数据移到缓冲区头部后再补充读取；
+ * 单条记录超过缓冲区大小时缓冲区按 2 倍增长。读取从 pf 的当前偏移开始，使用 pread，
+ * 不改变 pf 的偏移，也不使用 pf->data。
+ *
+ * @param[in] __pf     已打开（可读）的文件对象。
+ * @param[in] __bufsz  缓冲区初始大小，0 表示 FILE_READER_BUF_SIZE。
+ * @param[in] __delim  记录分隔符，按行读取时为 '\n'。
+ *
+ * @return 成功返回读取器指针，失败返回 NULL。使用完毕调用 _file_reader_free 释放。
+ */
+_file_reader_t* _file_reader_init(_file_t *__pf ,size_t __bufsz ,int __delim)
+{
+    if(__pf == NULL || __pf->fd < 0)
+        return NULL;
+
+    _file_reader_t *__r = (_file_reader_t *)calloc(1 ,sizeof(_file_reader_t));
+    if(__r == NULL)
+        return NULL;
+
+    __r->cap = (__bufsz == 0) ? FILE_READER_BUF_SIZE : __bufsz;
+    __r->buf = (char *)malloc(__r->cap);
+    if(__r->buf == NULL){
+        free(__r);
+        return NULL;
+    }
+
+    __r->pf = __pf;
+    __r->ofs = __pf->ofs;
+    __r->delim = __delim;
+    return __r;
+}
+
+/**
+ * @name  _file_reader_fill
+ * @brief 滑动并补充缓冲区：丢弃已消费数据，必要时扩容，然后读取更多数据。
+ *
+ * @return 读取的字节数（0 表示文件尾），失败返回 -FILE_ERROR。
+ */
+static ssize_t _file_reader_fill(_file_reader_t *r)
+{
+    if(r->head > 0)
+    {
+        memmove(r->buf ,r->buf + r->head ,r->tail - r->head);
+        r->tail -= r->head;
+        r->scan -= r->head;
+        r->head = 0;
+    }
+
+    if(r->tail == r->cap)
+    {
+        char *__nbuf = (char *)realloc(r->buf ,r->cap * 2);
+        if(__nbuf == NULL){
+            printf("realloc error...\n");
+            return -FILE_ERROR;
+        }
+        r->buf = __nbuf;
+        r->cap *= 2;
+    }
+
+    ssize_t __n;
+    do{
+        __n = pread(r->pf->fd ,r->buf + r->tail ,r->cap - r->tail ,r->ofs);
+    }while(__n < 0 && errno == EINTR);
+
+    if(__n < 0){
+        PRINT_ERROR();
+        return -FILE_ERROR;
+    }
+
+    r->tail += __n;
+    r->ofs += __n;
+    return __n;
+}
+
+/**
+ * @name  _file_reader_next
+ * @brief 读取下一条记录（不含分隔符）。
+ *
+ * @param[in,out] __r    读取器。
+ * @param[out]    __rec  记录起始地址，指向读取器内部缓冲区，下次调用或释放后失效。
+ * @param[out]    __len  记录长度（字节）。
+ *
+ * @return 1 表示读到一条记录，0 表示文件尾，失败返回 -FILE_ERROR。
+ *
+ * @note 文件末尾没有分隔符的最后一段数据也作为一条记录返回。
+ */
+int _file_reader_next(_file_reader_t *__r ,const char **__rec ,size_t *__len)
+{
+    if(__r == NULL || __rec == NULL || __len == NULL)
+        return -FILE_ERROR;
+
+    for(;;)
+    {
+        const char *__d = _file_scan_delim(__r->buf + __r->scan ,__r->delim ,__r->tail - __r->scan);
+        if(__d != NULL)
+        {
+            *__rec = __r->buf + __r->head;
+            *__len = (size_t)(__d - *__rec);
+            __r->head = (size_t)(__d - __r->buf) + 1;
+            __r->scan = __r->head;
+            return 1;
+        }
+        __r->scan = __r->tail;
+
+        if(__r->eof)
+            break;
+
+        ssize_t __n = _file_reader_fill(__r);
+        if(__n == -FILE_ERROR)
+            return -FILE_ERROR;
+        if(__n == 0)
+            __r->eof = 1;
+    }
+
+    if(__r->head == __r->tail)
+        return 0;
+
+    *__rec = __r->buf + __r->head;
+    *__len = __r->tail - __r->head;
+    __r->head = __r->scan = __r->tail;
+    return 1;
+}
+
+/**
+ * @name  _file_reader_free
+ * @brief 释放读取器（不关闭关联的文件对象）。
+ */
+void _file_reader_free(_file_reader_t *__r)
+{
+    if(__r == NULL)
+        return;
+
+    free(__r->buf);
+    free(__r);
+}
+
  /******************************************************************************************************************/
  /**
   * @name _sfile_get_ofs
@@ -1487,6 +3387,7 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
      psf->path = strdup(path);
      psf->md = strdup(md);
      psf->ptr = NULL;
+     psf->cap = 0;
      psf->ofs = 0;
      if(psf->name == NULL || psf->path == NULL){
          FREE_SFILE(psf);
@@ -1528,7 +3429,7 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
  
      psf->fd = psf->pf->_fileno;
      psf->fsz = _sfile_get_sz(psf->pf);
-     if(psf->fsz == (size_t)-1){
+     if(psf->fsz == -1){
          PRINT_ERROR();
          return -FILE_ERROR;
      }
@@ -1603,7 +3504,7 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
      }
  
      psfw->fsz = _sfile_get_sz(psfw->pf);
-     if(psfw->fsz == (size_t)-1){
+     if(psfw->fsz == -1){
          PRINT_ERROR();
          return -FILE_ERROR;
      }
@@ -1639,7 +3540,7 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
                      || (whence != SEEK_CUR && whence != SEEK_SET && whence != SEEK_END))
          return -FILE_ERROR;
      
-     if(_file_data_init(&psfr->ptr ,sz * nmemb) == -FILE_ERROR)
+     if(_file_data_reserve(&psfr->ptr ,&psfr->cap ,sz * nmemb) == -FILE_ERROR)
          return -FILE_ERROR;
    
      psfr->ofs = _sfile_set_ofs(psfr->pf ,ofs ,whence);
@@ -1657,6 +3558,8 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
  
          clearerr(psfr->pf);
      }
+     /* 复用缓冲区不清零，_file_data_reserve 已预留结尾 '\0' 的 1 字节 */
+     ((char *)psfr->ptr)[psfr->ret * sz] = '\0';
      
      psfr->ofs = _sfile_get_ofs(psfr->pf);
      if(psfr->ofs == -1)
@@ -1693,7 +3596,7 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
      if(psfp->ofs == -1)
          return -FILE_ERROR; 
  
-     if(_file_data_init(&psfp->ptr ,sz * nmemb) == -FILE_ERROR)
+     if(_file_data_reserve(&psfp->ptr ,&psfp->cap ,sz * nmemb) == -FILE_ERROR)
          return -FILE_ERROR; 
          
      psfp->ret = fread(psfp->ptr ,sz ,nmemb ,psfp->pf);
@@ -1707,9 +3610,10 @@ int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd)
  
          clearerr(psfp->pf);
      }
+     ((char *)psfp->ptr)[psfp->ret * sz] = '\0';
  
      printf("\n*----------------------------------------------------*\n");
-     for (int i = 0; i < psfp->ret; ++i) {
+     for (size_t i = 0; i < psfp->ret; ++i) {
          putchar((char)((unsigned char *)psfp->ptr)[i]);
      }
      printf("\n*----------------------------------------------------*\n");
@@ -30,6 +30,17 @@
 #include "time.h"
 #include <utime.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 #include <pwd.h> 
 #include <dirent.h>
 
@@ -183,6 +194,17 @@ extern "C" {
 #define FILE_ERROR      0x01
 #define FILE_EOK        0x00
 
+#define FILE_DATA_MIN_CAP   (256)   ///< 数据缓冲区初始容量，之后按 2 倍增长
+#define FILE_READER_BUF_SIZE (64 * 1024)       ///< 流式读取器默认缓冲区大小
+#define FILE_DUMP_IN_BLOCK   (16 * 1024)       ///< _file_dump 单次读取的输入块大小（16 的倍数）
+#define FILE_DUMP_OUT_BLOCK  (128 * 1024)      ///< _file_dump 输出块大小，块满后一次 write
+#define FILE_DUMP_HEX_STEP   (256)             ///< FILE_DUMP_HEX 每次编码的字节数（16 的倍数）
+#define FILE_DUMP_XXD_LINE   (68)              ///< FILE_DUMP_XXD 单行最大长度
+#define FILE_DIO_BOUNCE      (1024 * 1024)     ///< 直接 I/O 中转缓冲区大小（需为对齐值的整数倍）
+#define FILE_COPY_BUF_SIZE  (128 * 1024)        ///< _file_copy 用户空间中转缓冲区大小
+#define FILE_COPY_CHUNK     (1024 * 1024 * 1024) ///< _file_copy 内核拷贝方式单次调用的最大长度
+#define TIME_STR_FRAC_MAX   (27)                 ///< _time_get_local_str_frac 输出缓冲区最小长度
+
 /**
  * @struct __file_stat
  * @brief 封装文件的元信息，包括 stat 结构、类型、权限及时间戳。
@@ -218,17 +240,118 @@ struct passwd {
  * 偏移量、文件标志、描述符、文件名以及文件状态信息。
  */
 typedef struct {
-    void *data;                 /**< 数据缓冲区，用于读写文件内容 */
+    void *data;                 /**< 数据缓冲区，用于读写文件内容（跨调用复用） */
+    size_t cap;                 /**< data 缓冲区当前容量（字节），不足时按 2 倍增长 */
     ssize_t ret;                /**< 实际读取或写入的字节数（有符号） */
     off_t ofs;                  /**< 当前文件偏移量（与 lseek 操作相关） */
     int fg;                     /**< 文件打开标志（如 O_RDONLY, O_RDWR） */
     int fd;                     /**< 文件描述符（由 open 系统调用返回） */
     char *__pathname;           /**< 文件路径名 */
     struct __file_stat *fst;    /**< 指向文件属性信息结构体的指针 */
+    int op;                     /**< 操作选项（file_op_t 按位组合），需在 _file_open 之前设置 */
+    int stale;                  /**< 缓存模式下 fst 中的时间/属主等格式化信息是否已过期 */
+    void *map;                  /**< 映射模式（FILE_OP_MMAP）下的映射起始地址，未映射为 NULL */
+    size_t map_len;             /**< 当前映射长度（字节），与映射时的文件大小一致 */
+    off_t map_ofs;              /**< _file_view 的视图游标，独立于 ofs 与内核偏移 */
+    size_t dio_align;           /**< 直接 I/O 模式下偏移/长度的对齐要求（字节） */
+    size_t dio_mem_align;       /**< 直接 I/O 模式下缓冲区地址的对齐要求（字节） */
+    void *dio_buf;              /**< 直接 I/O 对齐中转缓冲区（posix_memalign 分配） */
+    size_t dio_cap;             /**< dio_buf 容量 */
 } _file_t;
 
+/**
+ * @enum   file_op_t
+ * @brief  _file_t 操作选项标志，配合 _file_t 结构体中的 op 字段使用
+ *
+ * @details
+ * 与 thread_op_t 类似，每个位表示一个独立的行为开关，可按位或（|）组合：
+ *   - FILE_OP_CACHE：元信息缓存模式。st_size 与偏移量由封装层自行维护，
+ *     _file_read/_file_write/_file_pread/_file_pwrite 不再在每次调用后执行
+ *     stat/lseek/fcntl 与时间格式化，只有调用 _file_refresh_info() 或检测到
+ *     文件被外部修改（读到文件尾边界时的一次 fstat）才会刷新。
+ *   - FILE_OP_MMAP：内存映射模式，由 _file_mmap_open() 自动设置（隐含 FILE_OP_CACHE），
+ *     通过 _file_view() 获取指向映射区的零拷贝视图。
+ *   - FILE_OP_DIRECT：直接 I/O 模式（隐含 FILE_OP_CACHE），_file_open 以 O_DIRECT 打开，
+ *     数据不经过页缓存；读写请求不满足对齐要求时自动经对齐中转缓冲区处理。
+ *     不支持与 O_APPEND 同时使用（_file_open 返回 -FILE_ERROR，errno 为 EINVAL）。
+ *
+ * @note
+ * - 缓存模式假定文件主要由本对象修改，外部修改可通过 _file_refresh_info() 重新同步；
+ * - 缓存模式下读写路径不再打印 PRINT_FILE_INFO。
+ */
+typedef enum
+{
+    FILE_OP_DEFAULT = 0,         ///< 0b000：默认操作，每次 I/O 后刷新全部元信息
+    FILE_OP_CACHE   = (1 << 0),  ///< 0b001：元信息缓存模式，I/O 路径不再 stat
+    FILE_OP_MMAP    = (1 << 1),  ///< 0b010：内存映射模式，读取返回映射区视图
+    FILE_OP_DIRECT  = (1 << 2)   ///< 0b100：直接 I/O 模式，绕过页缓存
+}file_op_t;
+
+/**
+ * @typedef _file_view_t
+ * @brief   映射模式下的只读数据视图（指针 + 长度），不拷贝数据。
+ *
+ * @note
+ * - ptr 指向 _file_t 的映射区，映射被重建（文件增长后 _file_mmap_remap）或关闭后失效；
+ * - 文件被外部截短时访问视图会触发 SIGBUS，调用者需保证文件只增不减。
+ */
+typedef struct {
+    const void *ptr;    /**< 视图起始地址（映射区内） */
+    size_t len;         /**< 视图长度（字节），0 表示已到文件尾 */
+    off_t ofs;          /**< 视图起始位置在文件中的偏移 */
+} _file_view_t;
+
+/**
+ * @enum   file_advice_t
+ * @brief  映射区访问模式提示，对应 madvise() 的 MADV_* 取值
+ */
+typedef enum
+{
+    FILE_ADVICE_NORMAL     = MADV_NORMAL,      ///< 默认预读策略
+    FILE_ADVICE_SEQUENTIAL = MADV_SEQUENTIAL,  ///< 顺序扫描：加大预读，读过的页可尽快回收
+    FILE_ADVICE_RANDOM     = MADV_RANDOM,      ///< 随机访问：关闭预读
+    FILE_ADVICE_WILLNEED   = MADV_WILLNEED,    ///< 即将访问：提前异步读入
+    FILE_ADVICE_DONTNEED   = MADV_DONTNEED     ///< 不再访问：释放对应页（共享映射数据不丢失）
+}file_advice_t;
+
+/**
+ * @typedef _file_extent_t
+ * @brief   稀疏文件中的一个数据区段（非空洞部分）
+ */
+typedef struct {
+    off_t ofs;      /**< 区段起始偏移 */
+    off_t len;      /**< 区段长度（字节） */
+} _file_extent_t;
+
+/**
+ * @typedef _file_extent_iter_t
+ * @brief   数据区段迭代器，由 _file_extent_begin 初始化，_file_extent_next 推进
+ */
+typedef struct {
+    _file_t *pf;    /**< 被遍历的文件对象 */
+    off_t pos;      /**< 下一次查找的起始偏移 */
+    off_t end;      /**< 遍历结束偏移（不含） */
+} _file_extent_iter_t;
+
+/**
+ * @typedef _file_reader_t
+ * @brief   流式记录读取器：按分隔符逐条读取文件，缓冲区 [head, tail) 为未消费的数据
+ */
+typedef struct {
+    _file_t *pf;    /**< 关联的文件对象 */
+    char *buf;      /**< 滑动缓冲区 */
+    size_t cap;     /**< 缓冲区容量（记录超长时按 2 倍增长） */
+    size_t head;    /**< 未消费数据起点 */
+    size_t tail;    /**< 有效数据终点 */
+    size_t scan;    /**< 已确认不含分隔符的位置，补充数据后从此处继续查找 */
+    off_t ofs;      /**< 下一次读取的文件偏移 */
+    int delim;      /**< 记录分隔符 */
+    int eof;        /**< 是否已读到文件尾 */
+} _file_reader_t;
+
 /* 相关函数声明 */
 size_t _time_get_local_str(time_t *__timer, char *__buf);
+size_t _time_get_local_str_frac(char *__buf ,int __frac);
 double _time_get_timestamp(void);
 int _file_get_properties(char *__pathname ,struct __file_stat *fst);
 int _file_chown(_file_t *__pathname , uid_t owner, gid_t group);
@@ -248,16 +371,51 @@ void _file_close(_file_t *pf);
                         }while(0)
 _file_t* _file_init(char *__pathname);
 int _file_open(_file_t *__pf ,int __fg ,mode_t __md);
+int _file_attach_fd(_file_t *__pf ,int __fd ,int __fg);
+int _file_refresh_info(_file_t *__pf);
 int _file_read(_file_t *pfr ,off_t ofs ,int whence ,size_t len);
+int _file_read_into(_file_t *pfr ,void *buf ,off_t ofs ,int whence ,size_t len);
 int _file_write(_file_t *__pfw ,void *__data ,off_t __ofs ,int __whence ,size_t __len);
 int _file_pread(_file_t *__pfr  ,off_t __ofs ,size_t __len);
+int _file_pread_into(_file_t *__pfr ,void *__buf ,off_t __ofs ,size_t __len);
 int _file_pwrite(_file_t *pfw ,void *data ,size_t len ,off_t ofs);
+int _file_readv(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int whence);
+int _file_writev(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int whence);
+int _file_preadv2(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int flags);
+int _file_pwritev2(_file_t *pf ,const struct iovec *iov ,int iovcnt ,off_t ofs ,int flags);
 int _file_cpfd(_file_t *pf ,_file_t *cppf ,int flag ,int nfd);
+ssize_t _file_copy(_file_t *src ,_file_t *dst ,off_t off ,size_t len);
+int _file_extent_begin(_file_t *__pf ,_file_extent_iter_t *__it ,off_t __start ,off_t __end);
+int _file_extent_next(_file_extent_iter_t *__it ,_file_extent_t *__ext);
+int _file_fallocate(_file_t *__pf ,int __mode ,off_t __ofs ,off_t __len);
+int _file_punch_hole(_file_t *__pf ,off_t __ofs ,off_t __len);
+int _file_zero_range(_file_t *__pf ,off_t __ofs ,off_t __len);
+ssize_t _file_sparse_copy(_file_t *src ,_file_t *dst);
 int _file_status_fcntl(_file_t *__pf ,int __cmd, ...);
 int _file_flock(_file_t *__pf ,int __opt);
 int _file_truncate(_file_t *__pf ,off_t __len ,off_t __ofs ,int __cmd);
+/**
+ * @enum   file_dump_t
+ * @brief  _file_dump 输出格式
+ */
+typedef enum
+{
+    FILE_DUMP_TEXT = 0,     ///< 原样输出
+    FILE_DUMP_HEX  = 1,     ///< 每字节 "0xXX "
+    FILE_DUMP_XXD  = 2      ///< xxd 风格：偏移 + 16 字节十六进制 + ASCII 列
+}file_dump_t;
+ssize_t _file_dump(_file_t *pf ,off_t ofs ,size_t len ,int mode ,int out_fd);
 int _file_print(_file_t *pfp ,off_t ofs ,size_t len);
 int _file_print_u16(_file_t *pfp ,off_t ofs ,size_t len);
+int _file_mmap_open(_file_t *__pf ,int __fg ,mode_t __md);
+int _file_mmap_remap(_file_t *__pf);
+int _file_view(_file_t *__pf ,_file_view_t *__v ,off_t __ofs ,int __whence ,size_t __len);
+int _file_madvise(_file_t *__pf ,off_t __ofs ,size_t __len ,int __advice);
+int _file_mmap_write(_file_t *__pf ,const void *__data ,size_t __len ,off_t __ofs);
+int _file_msync(_file_t *__pf ,off_t __ofs ,size_t __len ,int __sync);
+_file_reader_t* _file_reader_init(_file_t *__pf ,size_t __bufsz ,int __delim);
+int _file_reader_next(_file_reader_t *__r ,const char **__rec ,size_t *__len);
+void _file_reader_free(_file_reader_t *__r);
 
 /**
  * @macro  CLOSE_FILE_FD
@@ -346,7 +504,8 @@ typedef struct
     char *path;     /**< 文件路径（可包含完整目录） */
     char *name;     /**< 文件名（可与 path 分离存储） */
     char *md;       /**< 打开模式字符串，如 "r", "w+", "rb" 等 */
-    void *ptr;      /**< 用户自定义数据指针，可用于扩展用途 */
+    void *ptr;      /**< 读缓冲区（跨调用复用），也可用于扩展用途 */
+    size_t cap;     /**< ptr 缓冲区当前容量（字节） */
     off_t fsz;      /**< 文件大小（单位：字节） */
     size_t ret;     /**< 实际读取或写入的字节数（无符号） */
     long ofs;       /**< 当前偏移量（相对文件开头） */
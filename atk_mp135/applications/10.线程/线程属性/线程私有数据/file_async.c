@@ -0,0 +1,828 @@
+/**
+ * @file    file_async.c
+ * @brief   _file_t 异步批量 I/O 引擎实现
+ *
+ * 本文件实现 file_async.h 中声明的异步文件操作接口，主要功能包括：
+ *  - io_uring 后端：通过原始系统调用建立 SQ/CQ 环，批量写入 SQE 后一次 io_uring_enter 提交；
+ *  - 线程池后端：io_uring 不可用（内核过旧、被 seccomp 禁用、缺少操作码）时，
+ *    由内部工作线程执行同步 pread/pwrite/fsync/open；
+ *  - 完成处理：在收割线程中更新 `_file_t` 的 ret/ofs/文件大小/fd，再调用请求回调。
+ *
+ * 设计要点：
+ *  - 请求结构体由调用者分配，引擎内部不做任何动态分配；
+ *  - 在途请求数不超过队列深度，CQ 容量为 SQ 的 2 倍，不会发生 CQ 溢出；
+ *  - 写请求完成后按缓存模式的规则维护 fst->st.st_size，并设置 stale 标志。
+ *
+ * @note
+ * - 回调中可以继续 _afile_prep_* / _afile_submit，但不能再调用 _afile_reap/_afile_poll；
+ * - ofs 为 -1 的读写使用文件当前偏移（io_uring 需内核支持 IORING_FEAT_RW_CUR_POS）。
+ */
+#include "file_async.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+
+/******************************************************************************************************************/
+/**
+ * @name  _afile_complete
+ * @brief 处理一个完成的请求：更新 _file_t 记账信息并调用回调。
+ */
+static void _afile_complete(_afile_t *ctx ,_afile_req_t *req ,int res)
+{
+    _file_t *pf = req->pf;
+
+    ctx->inflight--;
+    req->res = res;
+
+    switch(req->opcode)
+    {
+        case AFILE_OP_READ:
+            pf->ret = res;
+            if(res > 0 && req->ofs == -1)
+                pf->ofs += res;
+            break;
+
+        case AFILE_OP_WRITE:
+            pf->ret = res;
+            if(res <= 0)
+                break;
+            if((pf->fg & O_APPEND) == O_APPEND)
+                pf->fst->st.st_size += res;
+            else
+            {
+                off_t __end = ((req->ofs == -1) ? pf->ofs : req->ofs) + res;
+                if(__end > pf->fst->st.st_size)
+                    pf->fst->st.st_size = __end;
+            }
+            if(req->ofs == -1)
+                pf->ofs = ((pf->fg & O_APPEND) == O_APPEND) ? pf->fst->st.st_size : (pf->ofs + res);
+            pf->stale = 1;
+            break;
+
+        case AFILE_OP_OPEN:
+            if(res >= 0 && _file_attach_fd(pf ,res ,req->flags) == -FILE_ERROR)
+                res = req->res = -EIO;
+            break;
+
+        default:
+            break;
+    }
+
+    if(req->cb != NULL)
+        req->cb(req ,res);
+}
+
+/**
+ * @name  _afile_full
+ * @brief 检查队列是否已满（排队 + 在途达到深度），已满时设置 errno 为 EBUSY。
+ *
+ * 必须在填写请求结构体之前检查，避免调用者复用仍在队列中的请求时破坏链表。
+ */
+static int _afile_full(_afile_t *ctx)
+{
+    if(ctx->queued + ctx->inflight >= ctx->depth){
+        errno = EBUSY;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @name  _afile_queue
+ * @brief 将填写好的请求加入排队队列（未提交）。
+ */
+static int _afile_queue(_afile_t *ctx ,_afile_req_t *req)
+{
+    req->res = 0;
+    req->next = NULL;
+    if(ctx->q_tail != NULL)
+        ctx->q_tail->next = req;
+    else
+        ctx->q_head = req;
+    ctx->q_tail = req;
+    ctx->queued++;
+    return FILE_EOK;
+}
+
+/******************************************************************************************************************/
+/**
+ * @name  _afile_uring_enter
+ * @brief io_uring_enter 系统调用封装。
+ */
+static int _afile_uring_enter(int fd ,unsigned to_submit ,unsigned min_complete ,unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter ,fd ,to_submit ,min_complete ,flags ,NULL ,0);
+}
+
+/**
+ * @name  _afile_uring_probe
+ * @brief 检查内核是否支持引擎所需的全部操作码。
+ *
+ * @return 全部支持返回 FILE_EOK，否则返回 -FILE_ERROR。
+ */
+static int _afile_uring_probe(int fd)
+{
+    const int __ops[] = {IORING_OP_READ ,IORING_OP_WRITE ,IORING_OP_FSYNC ,IORING_OP_OPENAT};
+    size_t __sz = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *__probe = calloc(1 ,__sz);
+    if(__probe == NULL)
+        return -FILE_ERROR;
+
+    int __ret = FILE_EOK;
+    if(syscall(__NR_io_uring_register ,fd ,IORING_REGISTER_PROBE ,__probe ,256) < 0)
+        __ret = -FILE_ERROR;
+
+    for(size_t __i = 0; __ret == FILE_EOK && __i < sizeof(__ops) / sizeof(__ops[0]); __i++)
+    {
+        if(__ops[__i] > __probe->last_op ||
+                (__probe->ops[__ops[__i]].flags & IO_URING_OP_SUPPORTED) == 0)
+            __ret = -FILE_ERROR;
+    }
+
+    free(__probe);
+    return __ret;
+}
+
+/**
+ * @name  _afile_uring_exit
+ * @brief 解除 io_uring 映射并关闭实例。
+ */
+static void _afile_uring_exit(struct _afile_ring *r)
+{
+    if(r->sqes != NULL && r->sqes != MAP_FAILED)
+        munmap(r->sqes ,r->sqes_sz);
+    if(r->cq_ptr != NULL && r->cq_ptr != MAP_FAILED && r->cq_ptr != r->sq_ptr)
+        munmap(r->cq_ptr ,r->cq_sz);
+    if(r->sq_ptr != NULL && r->sq_ptr != MAP_FAILED)
+        munmap(r->sq_ptr ,r->sq_sz);
+    if(r->fd >= 0)
+        close(r->fd);
+
+    memset(r ,0 ,sizeof(*r));
+    r->fd = -1;
+}
+
+/**
+ * @name  _afile_uring_setup
+ * @brief 建立 io_uring 实例并映射 SQ/CQ 环与 SQE 数组。
+ *
+ * @return 成功返回 FILE_EOK；内核不支持或缺少所需特性时返回 -FILE_ERROR（不打印错误，由调用者退回线程池）。
+ */
+static int _afile_uring_setup(struct _afile_ring *r ,unsigned depth)
+{
+    struct io_uring_params __p;
+    memset(&__p ,0 ,sizeof(__p));
+
+    r->fd = (int)syscall(__NR_io_uring_setup ,depth ,&__p);
+    if(r->fd < 0)
+        return -FILE_ERROR;
+
+    if((__p.features & IORING_FEAT_RW_CUR_POS) == 0 || _afile_uring_probe(r->fd) == -FILE_ERROR)
+        goto fail;
+
+    r->sq_sz = __p.sq_off.array + __p.sq_entries * sizeof(unsigned);
+    r->cq_sz = __p.cq_off.cqes + __p.cq_entries * sizeof(struct io_uring_cqe);
+    if(__p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(r->cq_sz > r->sq_sz)
+            r->sq_sz = r->cq_sz;
+        r->cq_sz = r->sq_sz;
+    }
+
+    r->sq_ptr = mmap(NULL ,r->sq_sz ,PROT_READ | PROT_WRITE ,MAP_SHARED | MAP_POPULATE ,r->fd ,IORING_OFF_SQ_RING);
+    if(r->sq_ptr == MAP_FAILED)
+        goto fail;
+
+    if(__p.features & IORING_FEAT_SINGLE_MMAP)
+        r->cq_ptr = r->sq_ptr;
+    else
+    {
+        r->cq_ptr = mmap(NULL ,r->cq_sz ,PROT_READ | PROT_WRITE ,MAP_SHARED | MAP_POPULATE ,r->fd ,IORING_OFF_CQ_RING);
+        if(r->cq_ptr == MAP_FAILED)
+            goto fail;
+    }
+
+    r->sqes_sz = __p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL ,r->sqes_sz ,PROT_READ | PROT_WRITE ,MAP_SHARED | MAP_POPULATE ,r->fd ,IORING_OFF_SQES);
+    if(r->sqes == MAP_FAILED)
+        goto fail;
+
+    r->sq_head  = (unsigned *)((char *)r->sq_ptr + __p.sq_off.head);
+    r->sq_tail  = (unsigned *)((char *)r->sq_ptr + __p.sq_off.tail);
+    r->sq_mask  = *(unsigned *)((char *)r->sq_ptr + __p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)((char *)r->sq_ptr + __p.sq_off.array);
+    r->cq_head  = (unsigned *)((char *)r->cq_ptr + __p.cq_off.head);
+    r->cq_tail  = (unsigned *)((char *)r->cq_ptr + __p.cq_off.tail);
+    r->cq_mask  = *(unsigned *)((char *)r->cq_ptr + __p.cq_off.ring_mask);
+    r->cqes     = (char *)r->cq_ptr + __p.cq_off.cqes;
+    r->to_submit = 0;
+    return FILE_EOK;
+
+fail:
+    _afile_uring_exit(r);
+    return -FILE_ERROR;
+}
+
+/**
+ * @name  _afile_uring_fill
+ * @brief 将一个请求写入下一个空闲 SQE（只推进本地尾指针，由调用者统一发布）。
+ */
+static void _afile_uring_fill(struct _afile_ring *r ,unsigned tail ,_afile_req_t *req)
+{
+    unsigned __idx = tail & r->sq_mask;
+    struct io_uring_sqe *__sqe = (struct io_uring_sqe *)r->sqes + __idx;
+
+    memset(__sqe ,0 ,sizeof(*__sqe));
+    __sqe->user_data = (unsigned long long)(uintptr_t)req;
+
+    switch(req->opcode)
+    {
+        case AFILE_OP_READ:
+        case AFILE_OP_WRITE:
+            __sqe->opcode = (req->opcode == AFILE_OP_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+            __sqe->fd = req->pf->fd;
+            __sqe->addr = (unsigned long long)(uintptr_t)req->buf;
+            __sqe->len = (unsigned)req->len;   /* 入队时已保证不超过 AFILE_LEN_MAX */
+            __sqe->off = (unsigned long long)req->ofs;   /* -1 即使用当前偏移 */
+            break;
+
+        case AFILE_OP_FSYNC:
+            __sqe->opcode = IORING_OP_FSYNC;
+            __sqe->fd = req->pf->fd;
+            __sqe->fsync_flags = req->flags ? IORING_FSYNC_DATASYNC : 0;
+            break;
+
+        case AFILE_OP_OPEN:
+            __sqe->opcode = IORING_OP_OPENAT;
+            __sqe->fd = AT_FDCWD;
+            __sqe->addr = (unsigned long long)(uintptr_t)req->pf->__pathname;
+            __sqe->len = req->md;
+            __sqe->open_flags = req->flags;
+            break;
+    }
+
+    r->sq_array[__idx] = __idx;
+}
+
+/**
+ * @name  _afile_uring_abort
+ * @brief io_uring_enter 出现不可重试的错误时，撤回内核尚未取走的 SQE。
+ *
+ * 未使用 SQPOLL，内核只在 io_uring_enter 中消费 SQ，因此可以安全地回退尾指针；
+ * 被撤回的请求以 -err 完成（回调照常调用，在途计数随之回退），
+ * 否则它们永远不会产生 CQE，_afile_wait_all/_afile_free 会一直等待。
+ */
+static void _afile_uring_abort(_afile_t *ctx ,int err)
+{
+    struct _afile_ring *r = &ctx->ring;
+    unsigned __head = __atomic_load_n(r->sq_head ,__ATOMIC_ACQUIRE);
+    unsigned __tail = *r->sq_tail;
+
+    __atomic_store_n(r->sq_tail ,__head ,__ATOMIC_RELEASE);
+    r->to_submit = 0;
+
+    for(unsigned __i = __head; __i != __tail; __i++)
+    {
+        struct io_uring_sqe *__sqe = (struct io_uring_sqe *)r->sqes + (__i & r->sq_mask);
+        _afile_complete(ctx ,(_afile_req_t *)(uintptr_t)__sqe->user_data ,-err);
+    }
+}
+
+/**
+ * @name  _afile_uring_submit
+ * @brief 将排队队列全部写入 SQ，一次 io_uring_enter 提交。
+ *
+ * @return 本次提交的请求数，失败返回 -FILE_ERROR（未提交的请求已以 -errno 完成）。
+ */
+static int _afile_uring_submit(_afile_t *ctx)
+{
+    struct _afile_ring *r = &ctx->ring;
+    unsigned __tail = *r->sq_tail;
+    int __n = 0;
+
+    for(_afile_req_t *__req = ctx->q_head; __req != NULL; __req = __req->next)
+    {
+        _afile_uring_fill(r ,__tail++ ,__req);
+        __n++;
+    }
+    /* 发布新的尾指针：SQE 内容必须先于尾指针对内核可见 */
+    __atomic_store_n(r->sq_tail ,__tail ,__ATOMIC_RELEASE);
+
+    ctx->inflight += ctx->queued;
+    ctx->queued = 0;
+    ctx->q_head = ctx->q_tail = NULL;
+    r->to_submit += __n;
+
+    while(r->to_submit > 0)
+    {
+        int __ret = _afile_uring_enter(r->fd ,r->to_submit ,0 ,0);
+        if(__ret < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            /* EAGAIN/EBUSY：SQE 已在环中，下次 submit/reap 时再交给内核 */
+            if(errno == EAGAIN || errno == EBUSY)
+                break;
+            int __err = errno;
+            PRINT_ERROR();
+            _afile_uring_abort(ctx ,__err);
+            errno = __err;
+            return -FILE_ERROR;
+        }
+        r->to_submit -= (unsigned)__ret;
+    }
+
+    return __n;
+}
+
+/**
+ * @name  _afile_uring_reap
+ * @brief 收割 CQ 中的完成事件，不足 min 个时在 io_uring_enter 中阻塞等待。
+ *
+ * @return 收割的请求数，失败返回 -FILE_ERROR。
+ */
+static int _afile_uring_reap(_afile_t *ctx ,unsigned min)
+{
+    struct _afile_ring *r = &ctx->ring;
+    unsigned __got = 0;
+
+    for(;;)
+    {
+        unsigned __head = *r->cq_head;
+        unsigned __tail = __atomic_load_n(r->cq_tail ,__ATOMIC_ACQUIRE);
+
+        while(__head != __tail)
+        {
+            struct io_uring_cqe *__cqe = (struct io_uring_cqe *)r->cqes + (__head & r->cq_mask);
+            _afile_req_t *__req = (_afile_req_t *)(uintptr_t)__cqe->user_data;
+            int __res = __cqe->res;
+
+            __head++;
+            __atomic_store_n(r->cq_head ,__head ,__ATOMIC_RELEASE);
+            _afile_complete(ctx ,__req ,__res);
+            __got++;
+        }
+
+        if(__got >= min)
+            break;
+
+        int __ret = _afile_uring_enter(r->fd ,r->to_submit ,min - __got ,IORING_ENTER_GETEVENTS);
+        if(__ret < 0)
+        {
+            if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            int __err = errno;
+            PRINT_ERROR();
+            if(r->to_submit > 0)
+                _afile_uring_abort(ctx ,__err);
+            errno = __err;
+            return -FILE_ERROR;
+        }
+        r->to_submit -= ((unsigned)__ret > r->to_submit) ? r->to_submit : (unsigned)__ret;
+    }
+
+    return (int)__got;
+}
+
+/******************************************************************************************************************/
+/**
+ * @name  _afile_pool_exec
+ * @brief 线程池后端：以同步系统调用执行一个请求。
+ *
+ * @return 结果，语义同 io_uring CQE 的 res（成功为字节数或 0，失败为 -errno）。
+ */
+static int _afile_pool_exec(_afile_req_t *req)
+{
+    ssize_t __ret = -1;
+    _file_t *__pf = req->pf;
+
+    switch(req->opcode)
+    {
+        case AFILE_OP_READ:
+            __ret = (req->ofs == -1) ? read(__pf->fd ,req->buf ,req->len)
+                                     : pread(__pf->fd ,req->buf ,req->len ,req->ofs);
+            break;
+        case AFILE_OP_WRITE:
+            __ret = (req->ofs == -1) ? write(__pf->fd ,req->buf ,req->len)
+                                     : pwrite(__pf->fd ,req->buf ,req->len ,req->ofs);
+            break;
+        case AFILE_OP_FSYNC:
+            __ret = req->flags ? fdatasync(__pf->fd) : fsync(__pf->fd);
+            break;
+        case AFILE_OP_OPEN:
+            __ret = open(__pf->__pathname ,req->flags ,req->md);
+            break;
+        default:
+            errno = EINVAL;
+            break;
+    }
+
+    return (__ret < 0) ? -errno : (int)__ret;
+}
+
+/**
+ * @name  _afile_pool_worker
+ * @brief 线程池后端工作线程：取请求、执行、放入完成队列。
+ */
+static void *_afile_pool_worker(void *arg)
+{
+    struct _afile_pool *p = (struct _afile_pool *)arg;
+
+    pthread_mutex_lock(&p->lock);
+    for(;;)
+    {
+        while(p->sub_head == NULL && !p->stop)
+            pthread_cond_wait(&p->cond_sub ,&p->lock);
+        if(p->sub_head == NULL && p->stop)
+            break;
+
+        _afile_req_t *__req = p->sub_head;
+        p->sub_head = __req->next;
+        if(p->sub_head == NULL)
+            p->sub_tail = NULL;
+        pthread_mutex_unlock(&p->lock);
+
+        __req->res = _afile_pool_exec(__req);
+        __req->next = NULL;
+
+        pthread_mutex_lock(&p->lock);
+        if(p->done_tail != NULL)
+            p->done_tail->next = __req;
+        else
+            p->done_head = __req;
+        p->done_tail = __req;
+        pthread_cond_signal(&p->cond_done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/**
+ * @name  _afile_pool_exit
+ * @brief 停止并回收线程池后端。
+ */
+static void _afile_pool_exit(struct _afile_pool *p ,int started)
+{
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->cond_sub);
+    pthread_mutex_unlock(&p->lock);
+
+    for(int __i = 0; __i < started; __i++)
+        pthread_join(p->tids[__i] ,NULL);
+
+    free(p->tids);
+    p->tids = NULL;
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->cond_sub);
+    pthread_cond_destroy(&p->cond_done);
+}
+
+/**
+ * @name  _afile_pool_setup
+ * @brief 创建线程池后端。
+ *
+ * @return 成功返回 FILE_EOK，失败返回 -FILE_ERROR。
+ */
+static int _afile_pool_setup(struct _afile_pool *p ,int nworkers)
+{
+    memset(p ,0 ,sizeof(*p));
+    p->tids = calloc(nworkers ,sizeof(pthread_t));
+    if(p->tids == NULL)
+        return -FILE_ERROR;
+
+    pthread_mutex_init(&p->lock ,NULL);
+    pthread_cond_init(&p->cond_sub ,NULL);
+    pthread_cond_init(&p->cond_done ,NULL);
+
+    for(int __i = 0; __i < nworkers; __i++)
+    {
+        int __ret = pthread_create(&p->tids[__i] ,NULL ,_afile_pool_worker ,p);
+        if(__ret != 0)
+        {
+            errno = __ret;
+            PRINT_ERROR();
+            _afile_pool_exit(p ,__i);
+            return -FILE_ERROR;
+        }
+    }
+    p->nworkers = nworkers;
+    return FILE_EOK;
+}
+
+/**
+ * @name  _afile_pool_submit
+ * @brief 线程池后端：将排队队列整体移交给工作线程。
+ */
+static int _afile_pool_submit(_afile_t *ctx)
+{
+    struct _afile_pool *p = &ctx->pool;
+    int __n = (int)ctx->queued;
+
+    pthread_mutex_lock(&p->lock);
+    if(p->sub_tail != NULL)
+        p->sub_tail->next = ctx->q_head;
+    else
+        p->sub_head = ctx->q_head;
+    p->sub_tail = ctx->q_tail;
+    pthread_cond_broadcast(&p->cond_sub);
+    pthread_mutex_unlock(&p->lock);
+
+    ctx->inflight += ctx->queued;
+    ctx->queued = 0;
+    ctx->q_head = ctx->q_tail = NULL;
+    return __n;
+}
+
+/**
+ * @name  _afile_pool_reap
+ * @brief 线程池后端：收割完成队列，不足 min 个时等待。
+ */
+static int _afile_pool_reap(_afile_t *ctx ,unsigned min)
+{
+    struct _afile_pool *p = &ctx->pool;
+    unsigned __got = 0;
+
+    do
+    {
+        pthread_mutex_lock(&p->lock);
+        while(p->done_head == NULL && __got < min)
+            pthread_cond_wait(&p->cond_done ,&p->lock);
+        _afile_req_t *__list = p->done_head;
+        p->done_head = p->done_tail = NULL;
+        pthread_mutex_unlock(&p->lock);
+
+        while(__list != NULL)
+        {
+            _afile_req_t *__req = __list;
+            __list = __list->next;
+            _afile_complete(ctx ,__req ,__req->res);
+            __got++;
+        }
+    } while(__got < min);
+
+    return (int)__got;
+}
+
+/******************************************************************************************************************/
+/**
+ * @name   _afile_init
+ * @brief  创建异步 I/O 上下文。
+ *
+ * 优先建立 io_uring 实例；内核不支持 io_uring、缺少 READ/WRITE/FSYNC/OPENAT 操作码，
+ * 或指定了 AFILE_FLAG_FORCE_THREAD 时，创建 AFILE_WORKERS_DEFAULT 个工作线程作为后端。
+ *
+ * @param[in] __depth  队列深度（同时在途的最大请求数），0 表示 AFILE_DEPTH_DEFAULT。
+ * @param[in] __flags  afile_flag_t 按位组合。
+ *
+ * @return 成功返回上下文指针，失败返回 NULL。
+ */
+_afile_t* _afile_init(unsigned __depth ,int __flags)
+{
+    _afile_t *__ctx = calloc(1 ,sizeof(_afile_t));
+    if(__ctx == NULL)
+        return NULL;
+
+    __ctx->depth = (__depth == 0) ? AFILE_DEPTH_DEFAULT : __depth;
+    __ctx->ring.fd = -1;
+
+    if((__flags & AFILE_FLAG_FORCE_THREAD) != AFILE_FLAG_FORCE_THREAD &&
+            _afile_uring_setup(&__ctx->ring ,__ctx->depth) == FILE_EOK)
+    {
+        __ctx->backend = AFILE_BACKEND_URING;
+        return __ctx;
+    }
+
+    if(_afile_pool_setup(&__ctx->pool ,AFILE_WORKERS_DEFAULT) == -FILE_ERROR)
+    {
+        free(__ctx);
+        return NULL;
+    }
+    __ctx->backend = AFILE_BACKEND_THREAD;
+    return __ctx;
+}
+
+/**
+ * @name   _afile_free
+ * @brief  提交并等待全部剩余请求完成后释放上下文。
+ *
+ * @param[in] __ctx  上下文指针，可为 NULL。
+ */
+void _afile_free(_afile_t *__ctx)
+{
+    if(__ctx == NULL)
+        return;
+
+    _afile_wait_all(__ctx);
+
+    if(__ctx->backend == AFILE_BACKEND_URING)
+        _afile_uring_exit(&__ctx->ring);
+    else
+        _afile_pool_exit(&__ctx->pool ,__ctx->pool.nworkers);
+
+    free(__ctx);
+}
+
+/**
+ * @name   _afile_prep_read
+ * @brief  排队一个读请求（pread 语义），完成后 pf->ret 为读取字节数。
+ *
+ * @param[in]     __ctx  上下文。
+ * @param[in,out] __req  调用者分配的请求结构体，回调返回前不得释放或复用。
+ * @param[in]     __pf   已打开的文件对象。
+ * @param[out]    __buf  目标缓冲区。
+ * @param[in]     __len  读取长度，不超过 AFILE_LEN_MAX。
+ * @param[in]     __ofs  文件偏移；-1 表示使用并推进当前偏移。
+ * @param[in]     __cb   完成回调，可为 NULL。
+ * @param[in]     __arg  回调私有数据，保存在 __req->arg 中。
+ *
+ * @return 成功返回 FILE_EOK；参数错误、长度超过 AFILE_LEN_MAX（errno = EINVAL）或队列已满（errno = EBUSY）
+ *         返回 -FILE_ERROR。
+ *
+ * @note 超长请求直接拒绝而不是截短：截短后的短读无法与文件尾区分。
+ */
+int _afile_prep_read(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,void *__buf ,size_t __len ,off_t __ofs ,_afile_cb_t __cb ,void *__arg)
+{
+    if(__ctx == NULL || __req == NULL || __pf == NULL || __buf == NULL || __ofs < -1)
+        return -FILE_ERROR;
+
+    if((uint64_t)__len > AFILE_LEN_MAX){
+        errno = EINVAL;
+        return -FILE_ERROR;
+    }
+
+    if(_afile_full(__ctx))
+        return -FILE_ERROR;
+
+    memset(__req ,0 ,sizeof(*__req));
+    __req->opcode = AFILE_OP_READ;
+    __req->pf = __pf;
+    __req->buf = __buf;
+    __req->len = __len;
+    __req->ofs = __ofs;
+    __req->cb = __cb;
+    __req->arg = __arg;
+    return _afile_queue(__ctx ,__req);
+}
+
+/**
+ * @name   _afile_prep_write
+ * @brief  排队一个写请求（pwrite 语义），完成后更新 pf->ret 与缓存的文件大小。
+ *
+ * 参数含义同 _afile_prep_read；__buf 中的数据在回调返回前不得修改。
+ *
+ * @return 成功返回 FILE_EOK；参数错误、长度超过 AFILE_LEN_MAX（errno = EINVAL）或队列已满（errno = EBUSY）
+ *         返回 -FILE_ERROR。
+ */
+int _afile_prep_write(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,const void *__buf ,size_t __len ,off_t __ofs ,_afile_cb_t __cb ,void *__arg)
+{
+    if(__ctx == NULL || __req == NULL || __pf == NULL || __buf == NULL || __ofs < -1)
+        return -FILE_ERROR;
+
+    if((uint64_t)__len > AFILE_LEN_MAX){
+        errno = EINVAL;
+        return -FILE_ERROR;
+    }
+
+    if(_afile_full(__ctx))
+        return -FILE_ERROR;
+
+    memset(__req ,0 ,sizeof(*__req));
+    __req->opcode = AFILE_OP_WRITE;
+    __req->pf = __pf;
+    __req->buf = (void *)__buf;
+    __req->len = __len;
+    __req->ofs = __ofs;
+    __req->cb = __cb;
+    __req->arg = __arg;
+    return _afile_queue(__ctx ,__req);
+}
+
+/**
+ * @name   _afile_prep_fsync
+ * @brief  排队一个 fsync 请求。
+ *
+ * @param[in] __datasync  非 0 使用 fdatasync 语义（只同步数据及必要元数据）。
+ *
+ * @return 成功返回 FILE_EOK；参数错误或队列已满（errno = EBUSY）返回 -FILE_ERROR。
+ *
+ * @note fsync 与同一批次中的写请求之间没有顺序保证，需要时应先收割写请求再提交 fsync。
+ */
+int _afile_prep_fsync(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,int __datasync ,_afile_cb_t __cb ,void *__arg)
+{
+    if(__ctx == NULL || __req == NULL || __pf == NULL)
+        return -FILE_ERROR;
+
+    if(_afile_full(__ctx))
+        return -FILE_ERROR;
+
+    memset(__req ,0 ,sizeof(*__req));
+    __req->opcode = AFILE_OP_FSYNC;
+    __req->pf = __pf;
+    __req->flags = __datasync;
+    __req->cb = __cb;
+    __req->arg = __arg;
+    return _afile_queue(__ctx ,__req);
+}
+
+/**
+ * @name   _afile_prep_open
+ * @brief  排队一个打开请求，打开 pf->__pathname，完成后通过 _file_attach_fd 初始化 pf。
+ *
+ * @param[in] __pf  由 _file_init 创建、尚未打开的文件对象。
+ * @param[in] __fg  打开标志。
+ * @param[in] __md  创建文件时的权限。
+ *
+ * @return 成功返回 FILE_EOK；参数错误或队列已满（errno = EBUSY）返回 -FILE_ERROR。
+ */
+int _afile_prep_open(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,int __fg ,mode_t __md ,_afile_cb_t __cb ,void *__arg)
+{
+    if(__ctx == NULL || __req == NULL || __pf == NULL || __pf->__pathname == NULL || __pf->fd >= 0)
+        return -FILE_ERROR;
+
+    if(_afile_full(__ctx))
+        return -FILE_ERROR;
+
+    memset(__req ,0 ,sizeof(*__req));
+    __req->opcode = AFILE_OP_OPEN;
+    __req->pf = __pf;
+    __req->flags = __fg;
+    __req->md = __md;
+    __req->cb = __cb;
+    __req->arg = __arg;
+    return _afile_queue(__ctx ,__req);
+}
+
+/**
+ * @name   _afile_submit
+ * @brief  一次性提交所有排队的请求。
+ *
+ * @return 本次提交的请求数（可为 0），失败返回 -FILE_ERROR。
+ */
+int _afile_submit(_afile_t *__ctx)
+{
+    if(__ctx == NULL)
+        return -FILE_ERROR;
+
+    if(__ctx->queued == 0)
+        return 0;
+
+    return (__ctx->backend == AFILE_BACKEND_URING) ? _afile_uring_submit(__ctx)
+                                                   : _afile_pool_submit(__ctx);
+}
+
+/**
+ * @name   _afile_reap
+ * @brief  收割完成事件并调用回调，至少等待 __min 个请求完成。
+ *
+ * @param[in] __ctx  上下文。
+ * @param[in] __min  最少收割数量，超过在途请求数时按在途请求数处理；0 表示不等待。
+ *
+ * @return 收割的请求数，失败返回 -FILE_ERROR。
+ */
+int _afile_reap(_afile_t *__ctx ,unsigned __min)
+{
+    if(__ctx == NULL)
+        return -FILE_ERROR;
+
+    if(__min > __ctx->inflight)
+        __min = __ctx->inflight;
+
+    return (__ctx->backend == AFILE_BACKEND_URING) ? _afile_uring_reap(__ctx ,__min)
+                                                   : _afile_pool_reap(__ctx ,__min);
+}
+
+/**
+ * @name   _afile_poll
+ * @brief  非阻塞地收割当前已完成的请求，适合放在主循环中周期调用。
+ *
+ * @return 收割的请求数，失败返回 -FILE_ERROR。
+ */
+int _afile_poll(_afile_t *__ctx)
+{
+    return _afile_reap(__ctx ,0);
+}
+
+/**
+ * @name   _afile_wait_all
+ * @brief  提交排队的请求并等待全部在途请求完成。
+ *
+ * @return 收割的请求数，失败返回 -FILE_ERROR。
+ */
+int _afile_wait_all(_afile_t *__ctx)
+{
+    if(__ctx == NULL)
+        return -FILE_ERROR;
+
+    if(_afile_submit(__ctx) == -FILE_ERROR)
+        return -FILE_ERROR;
+
+    int __total = 0;
+    while(__ctx->inflight > 0)
+    {
+        int __ret = _afile_reap(__ctx ,__ctx->inflight);
+        if(__ret == -FILE_ERROR)
+            return -FILE_ERROR;
+        __total += __ret;
+    }
+    return __total;
+}
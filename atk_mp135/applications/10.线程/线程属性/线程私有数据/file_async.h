@@ -0,0 +1,170 @@
+/**
+ * @file    file_async.h
+ * @brief   _file_t 异步批量 I/O 引擎接口定义
+ *
+ * 本头文件定义了基于 io_uring 的异步文件操作接口，用于在不阻塞调用线程的前提下，
+ * 对多个 `_file_t` 对象批量提交读、写、fsync、打开等请求。
+ * 主要内容包括：
+ *  - 异步请求结构体 (_afile_req_t)，由调用者分配，生命周期需覆盖到完成回调；
+ *  - 异步上下文结构体 (_afile_t)，封装 io_uring 环形队列或线程池后端；
+ *  - 请求准备（_afile_prep_*）、批量提交（_afile_submit）与完成收割（_afile_reap/_afile_poll）接口。
+ *
+ * 设计说明：
+ *  - 使用原始 io_uring 系统调用（io_uring_setup/io_uring_enter/io_uring_register），不依赖 liburing；
+ *  - 内核不支持 io_uring 或缺少所需操作码时，自动退回内部线程池后端，接口行为一致；
+ *  - 所有完成回调都在调用 _afile_reap/_afile_poll 的线程中执行，回调中可安全访问 `_file_t`；
+ *  - 上下文本身非线程安全，同一个 _afile_t 应只在一个线程中使用。
+ *
+ * 使用流程：
+ *  1. _afile_init() 创建上下文；
+ *  2. _afile_prep_read/write/fsync/open() 排队若干请求；
+ *  3. _afile_submit() 一次性提交；
+ *  4. _afile_reap()/_afile_poll() 收割完成事件并触发回调；
+ *  5. _afile_free() 等待剩余请求完成后释放上下文。
+ *
+ * 依赖：
+ *  - 依赖 "file.h" 定义文件结构体及文件操作接口。
+ */
+#ifndef __FILE_ASYNC_H
+#define __FILE_ASYNC_H
+
+#include "file.h"
+#include <pthread.h>
+
+#define AFILE_DEPTH_DEFAULT     (64)    ///< 默认队列深度（同时在途的最大请求数）
+#define AFILE_LEN_MAX           (UINT_MAX)  ///< 单个读写请求的最大长度（io_uring SQE 的 len 为 32 位）
+#define AFILE_WORKERS_DEFAULT   (2)     ///< 线程池后端默认工作线程数
+
+/**
+ * @enum   afile_opcode_t
+ * @brief  异步请求类型
+ */
+typedef enum
+{
+    AFILE_OP_READ = 0,      ///< 按偏移读取（pread）
+    AFILE_OP_WRITE,         ///< 按偏移写入（pwrite）
+    AFILE_OP_FSYNC,         ///< fsync/fdatasync
+    AFILE_OP_OPEN           ///< 打开 _file_t 对应的路径，完成后写回 pf->fd
+}afile_opcode_t;
+
+/**
+ * @enum   afile_backend_t
+ * @brief  异步引擎后端类型
+ */
+typedef enum
+{
+    AFILE_BACKEND_URING  = 0,   ///< io_uring 后端
+    AFILE_BACKEND_THREAD = 1    ///< 线程池后端（io_uring 不可用时的退路）
+}afile_backend_t;
+
+/**
+ * @enum   afile_flag_t
+ * @brief  _afile_init 选项标志
+ */
+typedef enum
+{
+    AFILE_FLAG_DEFAULT      = 0,         ///< 优先使用 io_uring
+    AFILE_FLAG_FORCE_THREAD = (1 << 0)   ///< 强制使用线程池后端
+}afile_flag_t;
+
+typedef struct _afile_req _afile_req_t;
+
+/**
+ * @typedef _afile_cb_t
+ * @brief   完成回调函数类型
+ *
+ * @param[in] req  完成的请求。
+ * @param[in] res  结果：>=0 为字节数（读写）或 0（fsync/open），<0 为 -errno。
+ */
+typedef void (*_afile_cb_t)(_afile_req_t *req ,int res);
+
+/**
+ * @struct _afile_req
+ * @brief  异步请求，由调用者分配（栈、堆或静态数组均可），完成回调返回前不得释放
+ */
+struct _afile_req
+{
+    int opcode;             ///< 请求类型（afile_opcode_t）
+    _file_t *pf;            ///< 目标文件对象
+    void *buf;              ///< 读写缓冲区
+    size_t len;             ///< 读写长度
+    off_t ofs;              ///< 读写偏移；-1 表示使用并推进文件当前偏移
+    int flags;              ///< FSYNC：非 0 表示 fdatasync；OPEN：打开标志
+    mode_t md;              ///< OPEN：创建文件时的权限
+    int res;                ///< 完成结果，语义同回调参数 res
+    _afile_cb_t cb;         ///< 完成回调，可为 NULL
+    void *arg;              ///< 调用者私有数据
+    _afile_req_t *next;     ///< 内部队列链接
+};
+
+/**
+ * @struct _afile_ring
+ * @brief  io_uring 环形队列映射信息（内部使用）
+ */
+struct _afile_ring
+{
+    int fd;                 ///< io_uring 实例描述符
+    void *sq_ptr;           ///< SQ 环映射地址
+    void *cq_ptr;           ///< CQ 环映射地址（SINGLE_MMAP 时与 sq_ptr 相同）
+    size_t sq_sz;           ///< SQ 环映射长度
+    size_t cq_sz;           ///< CQ 环映射长度
+    void *sqes;             ///< SQE 数组映射地址
+    size_t sqes_sz;         ///< SQE 数组映射长度
+    unsigned *sq_head;      ///< SQ 头（内核推进）
+    unsigned *sq_tail;      ///< SQ 尾（用户推进）
+    unsigned sq_mask;       ///< SQ 索引掩码
+    unsigned *sq_array;     ///< SQ 索引数组
+    unsigned *cq_head;      ///< CQ 头（用户推进）
+    unsigned *cq_tail;      ///< CQ 尾（内核推进）
+    unsigned cq_mask;       ///< CQ 索引掩码
+    void *cqes;             ///< CQE 数组
+    unsigned to_submit;     ///< 已写入 SQ 但尚未被内核取走的 SQE 数
+};
+
+/**
+ * @struct _afile_pool
+ * @brief  线程池后端状态（内部使用）
+ */
+struct _afile_pool
+{
+    pthread_t *tids;            ///< 工作线程
+    int nworkers;               ///< 工作线程数
+    int stop;                   ///< 退出标志
+    pthread_mutex_t lock;       ///< 保护以下队列
+    pthread_cond_t cond_sub;    ///< 有新请求
+    pthread_cond_t cond_done;   ///< 有请求完成
+    _afile_req_t *sub_head;     ///< 已提交待执行队列
+    _afile_req_t *sub_tail;
+    _afile_req_t *done_head;    ///< 已完成待收割队列
+    _afile_req_t *done_tail;
+};
+
+/**
+ * @struct _afile_t
+ * @brief  异步 I/O 上下文
+ */
+typedef struct
+{
+    int backend;                ///< 当前后端（afile_backend_t）
+    unsigned depth;             ///< 队列深度
+    unsigned queued;            ///< 已排队未提交的请求数
+    unsigned inflight;          ///< 已提交未收割的请求数
+    _afile_req_t *q_head;       ///< 排队队列
+    _afile_req_t *q_tail;
+    struct _afile_ring ring;    ///< io_uring 后端
+    struct _afile_pool pool;    ///< 线程池后端
+} _afile_t;
+
+/* 相关函数声明 */
+_afile_t* _afile_init(unsigned __depth ,int __flags);
+void _afile_free(_afile_t *__ctx);
+int _afile_prep_read(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,void *__buf ,size_t __len ,off_t __ofs ,_afile_cb_t __cb ,void *__arg);
+int _afile_prep_write(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,const void *__buf ,size_t __len ,off_t __ofs ,_afile_cb_t __cb ,void *__arg);
+int _afile_prep_fsync(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,int __datasync ,_afile_cb_t __cb ,void *__arg);
+int _afile_prep_open(_afile_t *__ctx ,_afile_req_t *__req ,_file_t *__pf ,int __fg ,mode_t __md ,_afile_cb_t __cb ,void *__arg);
+int _afile_submit(_afile_t *__ctx);
+int _afile_reap(_afile_t *__ctx ,unsigned __min);
+int _afile_poll(_afile_t *__ctx);
+int _afile_wait_all(_afile_t *__ctx);
+
+#endif
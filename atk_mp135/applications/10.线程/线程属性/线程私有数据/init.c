@@ -9,7 +9,7 @@
  * @note
  * - 依赖 applicate.h、init.h 以及日志、进程、线程相关模块；
  * - 各初始化函数均对错误进行检测，异常时安全退出或清理；
- * - 线程初始化包含主线程信息填充和两个子工作线程的创建与调度；
+ * - 线程初始化包含主线程信息填充和两个子工作线程的创建与调度，实时线程与杂务线程分开绑定 CPU；
  * - 进程退出函数由注册回调自动调用，完成资源清理和日志输出。
  * 
  * @author  baotou
@@ -22,21 +22,73 @@
 unsigned int __count = 0;
 __tsync_rwlock_t __rwlock;
 __tsync_sem_t __sem;
+__tpool_t *__tpool = NULL;
 static void process_exit_handler(void);
 
+/**
+ * @function cpu_affinity_init
+ * @brief 把主线程限制在杂务 CPU 集合上，为实时线程空出 CPU
+ *
+ * @note
+ * - 必须最先调用：之后创建的日志刷写线程、线程池工作线程等都继承主线程的亲和性；
+ * - 实时线程创建时使用 THREAD_OP_CPUAFFINITY + THREAD_PLACE_ISOLATE_RT，单独绑定到实时集合；
+ * - 实时集合优先取内核 isolcpus，否则保留编号最大的 TOPO_RT_CORES 个物理核；
+ * - 单核或无法划分时不做任何改动。
+ */
+void cpu_affinity_init(void)
+{
+    cpu_set_t __house;
+    if(__topo_place(THREAD_PLACE_ISOLATE_RT ,0 ,&__house) == 0)
+        pthread_setaffinity_np(pthread_self() ,sizeof(__house) ,&__house);
+}
+
+/**
+ * @function thread_stack_init
+ * @brief 配置线程栈池并预分配、预触碰常用尺寸的栈
+ *
+ * @note
+ * - 在创建任何线程之前调用；
+ * - 级别对应线程池工作线程（TPOOL_STACK_DEFAULT）与 thread_init 中的实时线程（2MB、3MB 取整到 4MB）；
+ * - 预触碰使实时线程运行后不再因首次访问栈而缺页；
+ * - 失败不影响运行：缺少的栈在创建线程时再 mmap，超出级别的仍由 glibc 分配。
+ */
+void thread_stack_init(void)
+{
+    static const __tstack_class_t __cls[] = {
+        { TPOOL_STACK_DEFAULT ,TPOOL_WORKERS_DEFAULT },
+        { 1024 * 1024 ,0 },
+        { 1024 * 1024 * 2 ,1 },
+        { 1024 * 1024 * 4 ,1 },
+        { 1024 * 1024 * 8 ,0 }
+    };
+    int __ret = __tstack_pool_init(__cls ,sizeof(__cls) / sizeof(__cls[0]) ,TSTACK_MAX_FREE_DEFAULT ,1);
+    if(__ret != 0)
+        fprintf(stderr ,"thread stack pool init failed, error=%d\n" ,__ret);
+}
+
 /**
  * @function log_init
  * @brief 初始化日志系统封装函数
  *
  * @note
  * - 本函数是对 `_log_init()` 的简化封装，便于直接调用；
+ * - 日志文件与附加输出（stderr、unix 套接字）可由环境变量 LOG_SINKS 在启动时配置；
  * - 若日志系统初始化失败，将直接退出程序；
+ * - 按 LOG_ROTATE_SIZE 轮转，保留 LOG_ROTATE_KEEP 个历史分段；
+ * - 注册 SIGUSR1/SIGUSR2 用于运行中调整日志等级阈值；
+ * - 每个 LOG_PRINT 调用点限速 LOG_RATE_PER_SEC 条/秒（突发 LOG_RATE_BURST 条）；
+ * - 不启用重复内容合并：判断重复要为每条日志多格式化（或编码）一次，需要时自行调用 `_log_set_dedup(1)`；
+ * - 初始化后切换到异步写入模式（队列满时阻塞，不丢日志），失败则保持同步模式；
  * - 通常在主函数开始处调用一次；
  */
 void log_init(void)
 {
     if(_log_init() == -1)
         exit(-1);
+    _log_set_rotate(LOG_ROTATE_SIZE ,0 ,LOG_ROTATE_KEEP);
+    _log_level_signal();
+    _log_set_ratelimit(LOG_RATE_PER_SEC ,LOG_RATE_BURST);
+    _log_async_start(0 ,LOG_POLICY_BLOCK);
 }
 
 /**
@@ -95,29 +147,38 @@ void thread_sync_init(void)
 
 /**
  * @function thread_init
- * @brief 初始化线程链表、主线程信息并创建两个工作线程
+ * @brief 初始化线程注册表、主线程信息并创建两个工作线程
  *
  * @note
  * - 本函数在进程初始化后调用，用于设置线程结构和调度；
  * - 初始化失败时会立即退出进程，防止资源泄漏；
- * - 所有线程都会注册到线程链表中进行统一管理；
+ * - 所有线程都会注册到线程注册表中进行统一管理；
  * - 主线程信息由当前调用线程填充；
  * - 新建线程创建成功后立即调度执行。
  */
 void thread_init(void)
 {
-    /* 初始化线程链表容器 */
-    __proc->__pthdl = __thd_list_init();
-    if (__proc->__pthdl == NULL)
+    /* 初始化线程注册表 */
+    __proc->__preg = __treg_init();
+    if (__proc->__preg == NULL)
     {
         PROCESS_EXIT_FLUSH(&__proc, -1);
     }
     /* 填充主线程信息 */
-    __proc->__pthdl->__pthd = __thread_init("main");
-    __proc->__pthdl->__pthd->__id = __thread_getid();
-    LOG_PRINT("INFO", __proc, __proc->__pthdl->__pthd, "init %s thread ,tid=%lu",
-        __proc->__pthdl->__pthd->__name,
-        __proc->__pthdl->__pthd->__id);
+    __thd_t *__pmain = __thread_init("main");
+    if(__pmain == NULL)
+    {
+        PROCESS_EXIT_FLUSH(&__proc, -1);
+    }
+    __pmain->__id = __thread_getid();
+    if(__treg_add(__proc->__preg, __pmain) != 0)
+    {
+        __thread_free(&__pmain);
+        PROCESS_EXIT_FLUSH(&__proc, -1);
+    }
+    LOG_PRINT("INFO", __proc, __pmain, "init %s thread ,tid=%lu",
+        __pmain->__name,
+        __pmain->__id);
 
 #if 0
     /* 创建工作线程 1 */
@@ -126,23 +187,23 @@ void thread_init(void)
     {
         PROCESS_EXIT_FLUSH(&__proc, -1);
     }
-    __thd_list_add_nd(__proc->__pthdl, __pthd_1);
+    __treg_add(__proc->__preg, __pthd_1);
     /* 创建工作线程 2 */
     __thd_t *__pthd_2= __thread_init("thd2", __thread_2 ,NULL);
     if(__pthd_2== NULL)
     {
         PROCESS_EXIT_FLUSH(&__proc, -1);
     }
-    __thd_list_add_nd(__proc->__pthdl, __pthd_2);
+    __treg_add(__proc->__preg, __pthd_2);
 
      /* 启动线程 1 */
     __thread_create(__pthd_1);
-    LOG_PRINT("INFO", __proc, __proc->__pthdl->__pthd->__name, "create %s thread ,tid=%lu",
+    LOG_PRINT("INFO", __proc, __pmain, "create %s thread ,tid=%lu",
         __pthd_1->__name,
         __pthd_1->__id);
     /* 启动线程 2 */
     __thread_create(__pthd_2);
-    LOG_PRINT("INFO", __proc, __proc->__pthdl->__pthd->__name, "create %s thread ,tid=%lu",
+    LOG_PRINT("INFO", __proc, __pmain, "create %s thread ,tid=%lu",
         __pthd_2->__name,
         __pthd_2->__id);
 #else
@@ -154,33 +215,50 @@ void thread_init(void)
     __thd_t *__pthd_2= __thread_init("thd2");
     if(__pthd_2 == NULL)
     {
+        __thread_free(&__pthd_1);
         PROCESS_EXIT_FLUSH(&__proc, -1);
     }
 
-    __thd_list_add_nd(__proc->__pthdl, __pthd_1);
-    __thd_list_add_nd(__proc->__pthdl, __pthd_2);
+    /* 先按名称登记，创建成功后再补充线程 ID 索引；登记成功后归注册表所有 */
+    if(__treg_add(__proc->__preg, __pthd_1) != 0)
+    {
+        __thread_free(&__pthd_1);
+        __thread_free(&__pthd_2);
+        PROCESS_EXIT_FLUSH(&__proc, -1);
+    }
+    if(__treg_add(__proc->__preg, __pthd_2) != 0)
+    {
+        __thread_free(&__pthd_2);
+        PROCESS_EXIT_FLUSH(&__proc, -1);
+    }
 
     __pthd_1->__start_routine = __thread_1;
     __pthd_1->__inheritsched = PTHREAD_EXPLICIT_SCHED;
     __pthd_1->__policy = SCHED_RR;
     __pthd_1->__param.sched_priority = 50;
     __pthd_1->__stack_sz = (1024 * 1024 * 2);
-    __pthd_1->__op = THREAD_OP_REALTIME | THREAD_OP_DETACHED | THREAD_OP_STACKSIZE;
+    __pthd_1->__placement = THREAD_PLACE_ISOLATE_RT;
+    __pthd_1->__op = THREAD_OP_REALTIME | THREAD_OP_DETACHED | THREAD_OP_STACKSIZE | THREAD_OP_CPUAFFINITY;
     
     __pthd_2->__start_routine = __thread_2;
     __pthd_2->__inheritsched = PTHREAD_EXPLICIT_SCHED;
     __pthd_2->__policy = SCHED_RR;
     __pthd_2->__param.sched_priority = 50;
     __pthd_2->__stack_sz = (1024 * 1024 * 3);
-    __pthd_2->__op = THREAD_OP_REALTIME | THREAD_OP_DETACHED | THREAD_OP_STACKSIZE;
+    __pthd_2->__placement = THREAD_PLACE_ISOLATE_RT;
+    __pthd_2->__op = THREAD_OP_REALTIME | THREAD_OP_DETACHED | THREAD_OP_STACKSIZE | THREAD_OP_CPUAFFINITY;
 
     int ret1 = __thread_create(__pthd_1);
     int ret2 = __thread_create(__pthd_2);
 
     if(ret1 != 0)
         fprintf(stderr ,"thread 1 create failed, error=%d\n", ret1);
+    else
+        __treg_bind_id(__proc->__preg, __pthd_1);
     if(ret2 != 0) 
         fprintf(stderr ,"thread 2 create failed, error=%d\n", ret2);
+    else
+        __treg_bind_id(__proc->__preg, __pthd_2);
 #if 0 
     ret1 = __thread_join(__pthd_1);
     if(ret1 == EINVAL) 
@@ -193,6 +271,35 @@ void thread_init(void)
 #endif
 }
 
+/**
+ * @function thread_pool_init
+ * @brief 创建进程共享的工作线程池 __tpool
+ *
+ * @note
+ * - 在 thread_init 之后调用，工作线程使用默认调度策略与 TPOOL_STACK_DEFAULT 大小的栈；
+ * - 工作线程继承主线程的亲和性，即 cpu_affinity_init 划出的杂务 CPU 集合；
+ * - 队列满时 __tpool_submit 按调用者给定的超时阻塞或失败，不会无限堆积任务；
+ * - 创建失败时会立即退出进程；
+ * - 进程退出时由 process_exit_handler 排空队列并回收工作线程。
+ */
+void thread_pool_init(void)
+{
+    __thd_t __tmpl;
+    memset(&__tmpl ,0 ,sizeof(__tmpl));
+    __tmpl.__stack_sz = TPOOL_STACK_DEFAULT;
+    __tmpl.__op = THREAD_OP_STACKSIZE;
+
+    __tpool = __tpool_init("pool" ,TPOOL_WORKERS_DEFAULT ,TPOOL_QUEUE_DEFAULT ,&__tmpl);
+    if(__tpool == NULL)
+    {
+        PROCESS_EXIT_FLUSH(&__proc, -1);
+    }
+    LOG_PRINT("INFO", __proc, __treg_self(__proc->__preg), "init %s thread pool ,workers=%d ,queue=%u",
+        __tpool->__name,
+        __tpool->__nworkers,
+        __tpool->__cap);
+}
+
 /*<< ***********************************************************************************/
 /**
  * @function thread_exit_handler
@@ -202,7 +309,7 @@ void thread_init(void)
  *
  * @details
  * - 该函数作为线程清理函数使用，通常通过 `pthread_cleanup_push` 注册；
- * - 调用 `__thread_exit()` 完成线程安全退出与链表移除；
+ * - 调用 `__thread_exit()` 完成线程安全退出与注册表注销；
  * - 建议所有线程退出前都注册此函数，确保统一退出流程和资源释放；
  * - 退出返回值固定为 (void *)50，可根据需要修改。
  */
@@ -218,7 +325,7 @@ void thread_exit_handler(void *__arg)
     /* 控制台打印线程清理提示 */
     fprintf(stdout, "线程清理: %s\n", __pthd->__name);
 
-    /* 退出线程，释放链表节点，返回退出值 */
+    /* 退出线程，从注册表注销，返回退出值 */
     __thread_exit(__proc, __pthd ,0);
 }
 
@@ -245,6 +352,36 @@ static void process_exit_handler(void)
      */
     /* 摧毁线程同步相关资源 */
 
+    /* 排空线程池队列并回收工作线程，须在关闭日志之前 */
+    if(__tpool != NULL)
+    {
+        __tpool_stat_t __st;
+        __tpool_shutdown(__tpool ,1);
+        __tpool_stat(__tpool ,&__st);
+        LOG_PRINT("INFO", __proc, NULL, "thread pool done ,submitted=%llu ,completed=%llu ,rejected=%llu ,depth_max=%u ,wait_avg=%lluns ,wait_max=%lluns ,run_avg=%lluns",
+            (unsigned long long)__st.__submitted,
+            (unsigned long long)__st.__completed,
+            (unsigned long long)__st.__rejected,
+            __st.__depth_max,
+            (unsigned long long)__st.__wait_avg_ns,
+            (unsigned long long)__st.__wait_max_ns,
+            (unsigned long long)__st.__run_avg_ns);
+        __tpool_free(&__tpool);
+    }
+
+    /* 栈池占用与命中情况，归还空闲栈 */
+    __tstack_stat_t __sst;
+    __tstack_stat(&__sst);
+    LOG_PRINT("INFO", __proc, NULL, "thread stack pool ,mapped=%u ,free=%u ,detached=%u ,bytes=%zu ,hits=%llu ,misses=%llu ,reclaimed=%llu",
+        __sst.__mapped,
+        __sst.__free,
+        __sst.__detached,
+        __sst.__bytes,
+        (unsigned long long)__sst.__hits,
+        (unsigned long long)__sst.__misses,
+        (unsigned long long)__sst.__reclaimed);
+    __tstack_pool_free();
+
     /* 摧毁线程同步相关资源 */
     //__thread_key_delete(&__tls.__key); // 注意传入指针，或者按你的接口定义
 
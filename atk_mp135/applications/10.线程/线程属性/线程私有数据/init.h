@@ -6,7 +6,7 @@
  * 线程初始化等。封装了基础设施的启动流程，方便主函数调用，确保系统稳定运行。
  * 
  * @note
- * - 推荐调用顺序：log_init → process_init → thread_init；
+ * - 推荐调用顺序：cpu_affinity_init → thread_stack_init → log_init → process_init → thread_sync_init → thread_init → thread_pool_init；
  * - 初始化失败时函数内部会处理错误（如直接退出或安全释放资源）；
  * - 该模块依赖 process.h、log.h、signal.h 等基础模块。
  * 
@@ -19,17 +19,22 @@
 #include "process.h"   /**< 进程管理模块，定义 __proc 结构体及其生命周期函数 */
 #include "log.h"       /**< 日志系统模块，提供 _log_init、LOG_PRINT 等接口 */
 #include "signal.h"    /**< 信号管理模块，用于注册退出处理函数等 */
+#include "thread_pool.h" /**< 线程池模块，提供 __tpool_submit 等接口 */
 
 /* 接口函数声明 */
+void cpu_affinity_init(void);
+void thread_stack_init(void);
 void log_init(void);
 void process_init(void);
 void thread_sync_init(void);
 void thread_init(void);
+void thread_pool_init(void);
 
 void thread_exit_handler(void *__arg);
 
 extern unsigned int __count;
 extern __tsync_rwlock_t __rwlock;
 extern __tsync_sem_t __sem;
+extern __tpool_t *__tpool;
 
 #endif /* __INIT_H */
\ No newline at end of file
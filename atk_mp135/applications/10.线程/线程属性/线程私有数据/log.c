@@ -5,48 +5,149 @@
  * 本文件实现日志功能的具体逻辑，主要包括日志模块的初始化、日志信息的写入、
  * 以及资源的释放等操作，适用于记录程序运行过程中的关键信息与错误提示。
  *
- * 日志文件路径由宏 `LOGFILE` 指定，默认路径为 `"./run.log"`。
+ * 日志文件路径由宏 `LOGFILE` 指定，默认路径为 `"./run.log"`，也可由 `_log_open()` 指定。
  * 初始化时若文件存在，则以追加方式打开；否则新建文件并以独占方式打开。
+ * 启用轮转后，当前分段超过大小或时长上限时依次改名为 run.log.1 ~ run.log.N 并新建分段。
+ * 写入只依赖 O_APPEND，不再对每行日志执行 access/lseek/stat，
+ * 文件被删除或轮转的检测按 LOG_CHECK_INTERVAL 行间隔进行。
  *
- * 本模块依赖文件操作接口 `_file_init()`、`_file_open()`、`_file_write()`、
+ * 本模块依赖文件操作接口 `_file_init()`、`_file_open()`、
  * `_file_close()` 以及路径访问宏 `__ACCESS_MODE()`。
  *
+ * 异步模式下，生产者通过 CAS 在有界环形队列中领取槽位（每个槽位带序号，
+ * 参考 Vyukov 有界队列），直接把日志行格式化进槽位后发布；刷写线程按顺序
+ * 收集已发布的槽位，每批最多 LOG_FLUSH_BATCH 条，以一次 writev 写入日志文件。
+ * 附加 sink（标准错误、unix 数据报套接字）复用同一种队列，各自拥有一个刷写线程。
+ *
+ * 分线程暂存模式下，每个线程的暂存缓冲区通过 __thd_tls_t（`__thread_key_*`）绑定，
+ * 键的析构函数在线程退出时写出并释放缓冲区。
+ *
  * @note
  * - 所有接口需在调用 `_log_init()` 成功后再使用；
- * - 写入函数 `_log_write()` 支持自动添加时间戳；
+ * - 写入函数 `_log_write()` 支持自动添加时间戳，可被多个线程并发调用；
  * - 所有资源在 `_log_free()` 中释放，避免内存泄漏。
  *
  * @author  baotou
  * @date    2025-06-9
  */
  #include "log.h"
+ #include "thread.h"
+ #include <stddef.h>
+ #include <sys/syscall.h>
+ #include <signal.h>
 
  __log_t *__log = NULL;
+ int __log_level = LOG_LEVEL_DEFAULT;
+ int __log_noverride = 0;
+ uint64_t __log_rate_iv = 0;        ///< 令牌间隔（纳秒），0 表示不限速
+ uint64_t __log_rate_limit = 0;     ///< 允许的突发量（纳秒，突发条数 × 令牌间隔）
+ int __log_dedup = 0;
+
+ static struct _log_site *__log_sites = NULL;   ///< 曾被限速或合并过的调用点，供 _log_site_report 补提示
+
+/**
+ * @struct _log_override
+ * @brief  按进程/线程名单独设置的等级；条目只追加不删除，读取无需加锁
+ */
+struct _log_override
+{
+    char *__name;       ///< 进程或线程名
+    int __level;        ///< 等级阈值，-1 表示已取消
+};
+
+static struct _log_override __log_over[LOG_OVERRIDE_MAX];
+static pthread_mutex_t __log_over_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @struct _log_fmt
+ * @brief  已登记的格式串（二进制格式）
+ *
+ * 登记表为进程级，格式串与名称都是调用点的字符串字面量，调用点的静态编号在
+ * 重新初始化日志模块后仍然有效；每次切换到二进制格式时把整张表重新写入日志文件。
+ */
+struct _log_fmt
+{
+    const char *__name;                 ///< 日志名称（等级）
+    const char *__fmt;                  ///< 格式串
+    int __nargs;                        ///< 参数个数
+    uint8_t __kind[LOG_BIN_MAX_ARGS];   ///< 每个参数的取值方式（LOG_KIND_*）
+};
+
+/* 参数取值方式：低 7 位为 va_arg 类型，最高位表示有符号 */
+#define LOG_KIND_SIGNED     (0x80)
+enum
+{
+    LOG_KIND_INT = 1,
+    LOG_KIND_CHAR,
+    LOG_KIND_SHORT,
+    LOG_KIND_LONG,
+    LOG_KIND_LLONG,
+    LOG_KIND_SIZE,
+    LOG_KIND_INTMAX,
+    LOG_KIND_PTRDIFF,
+    LOG_KIND_DOUBLE,
+    LOG_KIND_LDOUBLE,
+    LOG_KIND_STR,
+    LOG_KIND_PTR
+};
+
+static struct _log_fmt __log_fmts[LOG_BIN_MAX_FMTS];
+static int __log_nfmts = 0;         ///< 只增不减，登记项填好后以 release 发布
+/* 只串行化登记；轮转（可能在刷写线程中）不取此锁，按快照直接写新分段 */
+static pthread_mutex_t __log_fmt_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _log_bin_emit_header(void);
+static void _log_bin_write_header(int __fd ,int __from ,int __to);
+static void _log_sink_close_all(void);
+static void _log_sink_wake(struct _log_sink *__s ,int __force);
+static void _log_stage_flush_all(int __expired);
  
 /**
  * @brief   初始化日志模块
  *
+ * 设置了环境变量 LOG_SINKS 时按其内容配置日志文件与附加 sink（见 `_log_config()`），
+ * 否则日志文件为 LOGFILE。
+ *
+ * @retval 0       成功
+ * @retval -1      失败（内存或文件操作失败，或 LOG_SINKS 格式错误）
+ */
+int _log_init(void)
+{
+    const char *__spec = getenv(LOG_SINKS_ENV);
+    if(__spec != NULL && __spec[0] != '\0')
+        return _log_config(__spec);
+    return _log_open(LOGFILE);
+}
+
+/**
+ * @name    _log_open
+ * @brief   以指定路径初始化日志模块
+ *
  * 本函数完成以下工作：
  * 1. 分配并初始化日志结构体 `__log_t`；
  * 2. 初始化日志文件对象；
  * 3. 若日志文件已存在，以追加方式打开；否则以创建+独占方式新建；
- * 4. 分配内部缓冲区 `__str` 用于拼接日志输出内容；
- * 5. 初始化时间戳字段。
+ * 4. 初始化时间戳字段与刷写线程唤醒用的互斥锁/条件变量。
  *
- * 所有资源初始化失败时，均会清理资源避免内存泄漏。
+ * 所有资源初始化失败时，均会清理资源避免内存泄漏。已有日志不会被截断。
+ *
+ * @param[in]   __path  日志文件路径。
  *
  * @retval 0       成功
  * @retval -1      失败（内存或文件操作失败）
  */
-int _log_init(void)
+int _log_open(const char *__path)
 {
+    if(__path == NULL)
+        return -1;
+
     /* 分配日志结构体内存 */
     __log_t *__p_log = (__log_t *)calloc(1 ,sizeof(__log_t));
     if(__p_log == NULL)
         return -1;
     
     /* 初始化日志文件结构体 */
-    _file_t *__pf =  _file_init(LOGFILE);
+    _file_t *__pf =  _file_init((char *)__path);
     if(__pf == NULL){
         free(__p_log);
         __p_log = NULL;
@@ -56,7 +157,7 @@ int _log_init(void)
     /* 判断日志文件是否存在，设置打开标志：
        存在则以读写+追加打开，
        不存在则读写+追加+创建+独占打开 */
-    int __open_flags = (__ACCESS_MODE(LOGFILE ,F_OK) == 0) ? 
+    int __open_flags = (__ACCESS_MODE(__path ,F_OK) == 0) ? 
                                 (O_RDWR | O_APPEND) : 
                                 (O_RDWR | O_APPEND | O_CREAT | O_EXCL);
 
@@ -68,26 +169,22 @@ int _log_init(void)
         return -1;
     }                             
 
-    /* 分配内部缓冲区用于日志拼接 */
-    char *__str = (char *)calloc(256 ,sizeof(char));
-    if(__str == NULL){
-        _file_close(__pf);
-        free(__p_log);
-        __p_log = NULL;
-        return -1;
-    }
-    
     /* 赋值给全局日志结构体 */
     __log = __p_log;
-    __log->__str = __str;
     __log->__pf = __pf;
     __log->__timer = 0;
+    __log->__mode = LOG_MODE_SYNC;
+    __log->__backend = LOG_BACKEND_FILE;
+    __log->__level = LOG_LEVEL_TRACE;
+    __log->__batch = 1;
+    __log->__interval_ms = LOG_FLUSH_INTERVAL_MS;
+    pthread_mutex_init(&__log->__lock ,NULL);
+    pthread_cond_init(&__log->__cond ,NULL);
 
-    /* 截断日志文件为0长度，失败返回错误 */
-    if(_file_truncate(__pf ,0 ,0 ,FILE_TRUNCATE) == -FILE_ERROR)
-    {
-        return -1;
-    }
+    /* 保留已有日志，当前分段从已有内容之后开始计数 */
+    struct stat __st;
+    __log->__seg_bytes = (fstat(__pf->fd ,&__st) == 0) ? __st.st_size : 0;
+    __log->__seg_start = time(NULL);
     
     return 0;
 }
@@ -99,6 +196,8 @@ int _log_init(void)
  *
  * 该函数负责关闭日志文件并释放与日志相关的内存资源，
  * 包括关闭文件句柄 `__log->__log_pf` 和释放日志结构体 `__log` 的内存。
+ * 异步模式下先调用 `_log_async_stop()` 把队列中剩余日志写完，分线程暂存模式下先写出
+ * 所有线程的暂存内容，附加 sink 同样先写完再关闭。
  *
  * 调用此函数后，日志相关的资源将被正确释放，避免内存泄漏。
  *
@@ -109,66 +208,2459 @@ void _log_free(void)
     if(__log == NULL)
         return;
 
+    _log_site_report();
+    _log_async_stop();
+    _log_stage_stop();
+    _log_sink_close_all();
+    _log_flight_close();
+
     if(__log->__pf != NULL)
+    {
+        /* 释放文件尾之后未用完的预分配空间 */
+        struct stat __st;
+        if(__log->__rot_size > 0 && fstat(__log->__pf->fd ,&__st) == 0 &&
+           ftruncate(__log->__pf->fd ,__st.st_size) == -1)
+            PRINT_ERROR();
         _file_close(__log->__pf);
-        
-    if(__log->__str != NULL){
-        free(__log->__str);
-        __log->__str = NULL;
-    }    
+    }
+
+    pthread_mutex_destroy(&__log->__lock);
+    pthread_cond_destroy(&__log->__cond);
 
     free(__log);
     __log = NULL;
 }
  
 /**
- * @name    _log_write
- * @brief   写入日志信息到日志文件。
- * 
- * @param[in]   __name      日志来源名称（如模块名、函数名），不能为空。
- * @param[in]   __fmt_str   要写入的日志格式字符串，类似 printf 格式。
- * @param[in]   ...         可变参数，用于格式化 __fmt_str。
- * 
- * @return      成功返回写入的字节数，失败返回 -1。
- * 
- * @details
- *  该函数会：
- *  1. 获取当前时间字符串；
- *  2. 将时间戳、__name 和格式化后的字符串拼接为完整日志；
- *  3. 追加写入日志文件末尾；
- *  4. 返回写入的字节长度。
+ * @name    _log_format
+ * @brief   将 "时间戳 名称 内容\n" 格式化到调用者提供的缓冲区。
+ *
+ * @param[out]  __buf   目标缓冲区（不要求以 '\0' 结尾）。
+ * @param[in]   __cap   缓冲区大小。
+ *
+ * @return  成功返回日志行长度，内容过长或格式化失败返回 -1。
  */
-int _log_write(const char *__name, const char *__fmt_str, ...)
+static int _log_format(char *__buf ,size_t __cap ,const char *__name ,const char *__fmt_str ,va_list __args)
 {
-    /* 参数校验：全局日志指针、日志名称、格式字符串不能为空，日志文件必须存在 */
-    if(__log == NULL || __name == NULL || __fmt_str == NULL || __ACCESS_MODE(LOGFILE ,F_OK) == -1)
+    char __tim_str[TIME_STR_FRAC_MAX];
+    if(_time_get_local_str_frac(__tim_str ,LOG_TIME_FRAC) == 0)
         return -1;
 
-    char __tim_str[32] = {0};
-    /* 获取当前时间字符串，失败则返回 */
-    size_t __tim_len = _time_get_local_str(&__log->__timer, __tim_str);
-    if (__tim_len == 0)
+    int __n = snprintf(__buf ,__cap ,"%s %s " ,__tim_str ,__name);
+    if(__n < 0 || (size_t)__n >= __cap - 1)
         return -1;
 
-    /* 格式化日志主体内容 */
-    char __msg_buf[192] = {0};
-    va_list args;
-    va_start(args, __fmt_str);
-    int __msg_len = vsnprintf(__msg_buf, sizeof(__msg_buf), __fmt_str, args);
-    va_end(args);
-    if(__msg_len < 0 || __msg_len >= sizeof(__msg_buf))
+    /* 预留 1 字节给换行符 */
+    int __m = vsnprintf(__buf + __n ,__cap - __n - 1 ,__fmt_str ,__args);
+    if(__m < 0 || (size_t)__m >= __cap - __n - 1)
         return -1;
 
-    /* 拼接完整日志字符串：时间戳 + 空格 + 名称 + 内容 + 换行 */
-    snprintf(__log->__str, 256, "%s %s %s\n", __tim_str, __name, __msg_buf);
+    __buf[__n + __m] = '\n';
+    return __n + __m + 1;
+}
 
-    int __len = strlen(__log->__str);
-    /* 追加写入日志文件，失败返回 -1 */
-    if(_file_write(__log->__pf, __log->__str, 0, SEEK_END, __len) == -1)
+/**
+ * @name    _log_gettid
+ * @brief   获取当前线程的内核线程号（线程内缓存）。
+ */
+static uint32_t _log_gettid(void)
+{
+    static __thread uint32_t __tid = 0;
+    if(__tid == 0)
+        __tid = (uint32_t)syscall(SYS_gettid);
+    return __tid;
+}
+
+/**
+ * @name    _log_bin_hdr
+ * @brief   填写二进制记录头（时间戳、线程号）。
+ */
+static void _log_bin_hdr(struct _log_rec *__h ,int __type ,uint32_t __fid ,int __nargs ,size_t __len)
+{
+    struct timespec __ts;
+    clock_gettime(CLOCK_REALTIME ,&__ts);
+    __h->__len = (uint16_t)__len;
+    __h->__type = (uint8_t)__type;
+    __h->__nargs = (uint8_t)__nargs;
+    __h->__fid = __fid;
+    __h->__ts = (uint64_t)__ts.tv_sec * 1000000000ULL + __ts.tv_nsec;
+    __h->__tid = _log_gettid();
+}
+
+/**
+ * @name    _log_bin_text
+ * @brief   生成 LOG_REC_TEXT 记录：在设备上格式化，用于无法登记的格式串与 _log_write 直接调用。
+ *
+ * @return  记录长度，格式化失败返回 -1。
+ */
+static int _log_bin_text(char *__buf ,size_t __cap ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    size_t __n = sizeof(struct _log_rec);
+    size_t __nl = strlen(__name) + 1;
+    if(__n + __nl >= __cap)
         return -1;
+    memcpy(__buf + __n ,__name ,__nl);
+    __n += __nl;
 
-    /* 返回写入的字节数 */
+    int __m = vsnprintf(__buf + __n ,__cap - __n ,__fmt_str ,__args);
+    if(__m < 0)
+        return -1;
+    /* 过长时保留截断后的内容，不含结尾 '\0' */
+    __n += ((size_t)__m >= __cap - __n) ? (__cap - __n - 1) : (size_t)__m;
+
+    struct _log_rec __h;
+    _log_bin_hdr(&__h ,LOG_REC_TEXT ,0 ,0 ,__n);
+    memcpy(__buf ,&__h ,sizeof(__h));
+    return __n;
+}
+
+/**
+ * @name    _log_bin_put
+ * @brief   向 LOG_REC_MSG 负载追加一个参数：F64 为 8 字节原值，整数与指针为 LEB128 变长编码。
+ *
+ * @return  成功返回 0，空间不足返回 -1。
+ */
+static int _log_bin_put(char *__buf ,size_t __cap ,size_t *__n ,int __tag ,const void *__v)
+{
+    if(*__n + 11 > __cap)
+        return -1;
+    __buf[(*__n)++] = (char)__tag;
+
+    if(__tag == LOG_ARG_F64)
+    {
+        memcpy(__buf + *__n ,__v ,8);
+        *__n += 8;
+        return 0;
+    }
+
+    uint64_t __u;
+    memcpy(&__u ,__v ,8);
+    if(__tag == LOG_ARG_I64)
+        __u = (__u << 1) ^ (uint64_t)((int64_t)__u >> 63);    /* zigzag：小的负数也只占 1~2 字节 */
+    do
+    {
+        unsigned char __b = __u & 0x7f;
+        __u >>= 7;
+        __buf[(*__n)++] = (char)(__u ? (__b | 0x80) : __b);
+    }while(__u);
+    return 0;
+}
+
+/**
+ * @name    _log_bin_encode
+ * @brief   生成 LOG_REC_MSG 记录：按登记时解析出的类型逐个取出参数，原样保存。
+ *
+ * 空间不足时截断：字符串保留能放下的部分，其余参数不再保存，__nargs 为实际保存的个数。
+ *
+ * @return  记录长度。
+ */
+static int _log_bin_encode(char *__buf ,size_t __cap ,int __fid ,va_list __args)
+{
+    const struct _log_fmt *__f = &__log_fmts[__fid - 1];
+    size_t __n = sizeof(struct _log_rec);
+    int __i;
+
+    for(__i = 0; __i < __f->__nargs; __i++)
+    {
+        int __sig = __f->__kind[__i] & LOG_KIND_SIGNED;
+        int64_t __iv = 0;
+        uint64_t __uv = 0;
+        double __dv;
+        int __r = 0;
+
+        switch(__f->__kind[__i] & ~LOG_KIND_SIGNED)
+        {
+            case LOG_KIND_INT:
+                if(__sig) __iv = va_arg(__args ,int); else __uv = va_arg(__args ,unsigned int);
+                break;
+            case LOG_KIND_CHAR:
+                if(__sig) __iv = (signed char)va_arg(__args ,int); else __uv = (unsigned char)va_arg(__args ,int);
+                break;
+            case LOG_KIND_SHORT:
+                if(__sig) __iv = (short)va_arg(__args ,int); else __uv = (unsigned short)va_arg(__args ,int);
+                break;
+            case LOG_KIND_LONG:
+                if(__sig) __iv = va_arg(__args ,long); else __uv = va_arg(__args ,unsigned long);
+                break;
+            case LOG_KIND_LLONG:
+                if(__sig) __iv = va_arg(__args ,long long); else __uv = va_arg(__args ,unsigned long long);
+                break;
+            case LOG_KIND_SIZE:
+                if(__sig) __iv = va_arg(__args ,ssize_t); else __uv = va_arg(__args ,size_t);
+                break;
+            case LOG_KIND_INTMAX:
+                if(__sig) __iv = va_arg(__args ,intmax_t); else __uv = va_arg(__args ,uintmax_t);
+                break;
+            case LOG_KIND_PTRDIFF:
+                if(__sig) __iv = va_arg(__args ,ptrdiff_t); else __uv = (size_t)va_arg(__args ,ptrdiff_t);
+                break;
+            case LOG_KIND_DOUBLE:
+                __dv = va_arg(__args ,double);
+                __r = _log_bin_put(__buf ,__cap ,&__n ,LOG_ARG_F64 ,&__dv);
+                goto next;
+            case LOG_KIND_LDOUBLE:
+                __dv = (double)va_arg(__args ,long double);
+                __r = _log_bin_put(__buf ,__cap ,&__n ,LOG_ARG_F64 ,&__dv);
+                goto next;
+            case LOG_KIND_PTR:
+                __uv = (uintptr_t)va_arg(__args ,void *);
+                __r = _log_bin_put(__buf ,__cap ,&__n ,LOG_ARG_PTR ,&__uv);
+                goto next;
+            case LOG_KIND_STR:
+            {
+                const char *__s = va_arg(__args ,const char *);
+                if(__s == NULL)
+                    __s = "(null)";
+                if(__n + 3 > __cap)
+                {
+                    __r = -1;
+                    goto next;
+                }
+                size_t __sl = strnlen(__s ,__cap - __n - 3);
+                uint16_t __l16 = (uint16_t)__sl;
+                __buf[__n] = LOG_ARG_STR;
+                memcpy(__buf + __n + 1 ,&__l16 ,2);
+                memcpy(__buf + __n + 3 ,__s ,__sl);
+                __n += 3 + __sl;
+                goto next;
+            }
+            default:
+                __r = -1;
+                goto next;
+        }
+
+        __r = __sig ? _log_bin_put(__buf ,__cap ,&__n ,LOG_ARG_I64 ,&__iv)
+                    : _log_bin_put(__buf ,__cap ,&__n ,LOG_ARG_U64 ,&__uv);
+next:
+        if(__r == -1)
+            break;
+    }
+
+    struct _log_rec __h;
+    _log_bin_hdr(&__h ,LOG_REC_MSG ,__fid ,__i ,__n);
+    memcpy(__buf ,&__h ,sizeof(__h));
+    return __n;
+}
+
+/**
+ * @name    _log_fill
+ * @brief   按当前记录格式把一条日志写入缓冲区（同步模式的栈缓冲区或异步模式的槽位）。
+ *
+ * @param[in]   __fid   格式串编号，>0 且为二进制格式时只保存参数；否则格式化为文本。
+ *
+ * @return  记录长度，失败返回 -1。
+ */
+static int _log_fill(char *__buf ,size_t __cap ,int __fid ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    if(__atomic_load_n(&__log->__format ,__ATOMIC_ACQUIRE) != LOG_FORMAT_BINARY)
+        return _log_format(__buf ,__cap ,__name ,__fmt_str ,__args);
+    if(__fid > 0)
+        return _log_bin_encode(__buf ,__cap ,__fid ,__args);
+    return _log_bin_text(__buf ,__cap ,__name ,__fmt_str ,__args);
+}
+
+/**
+ * @name    _log_fillf
+ * @brief   _log_fill 的可变参数版本，供模块内部生成提示信息。
+ */
+static int _log_fillf(char *__buf ,size_t __cap ,const char *__name ,const char *__fmt_str ,...)
+{
+    va_list __args;
+    va_start(__args ,__fmt_str);
+    int __len = _log_fill(__buf ,__cap ,0 ,__name ,__fmt_str ,__args);
+    va_end(__args);
     return __len;
 }
 
- 
+/**
+ * @name    _log_check_file
+ * @brief   检查日志文件是否已被删除或被外部轮转，是则按原路径重新打开。
+ *
+ * 比较已打开描述符（fstat）与路径（stat）的设备号/inode，以及描述符的链接数；
+ * 不一致时新建/打开路径，并用 dup2 原子地替换原描述符，其它线程无需加锁即可继续写入。
+ */
+static void _log_check_file(void)
+{
+    _file_t *__pf = __log->__pf;
+    struct stat __fst ,__pst;
+
+    if(fstat(__pf->fd ,&__fst) == -1)
+        return;
+    if(__fst.st_nlink > 0 && stat(__pf->__pathname ,&__pst) == 0 &&
+       __pst.st_dev == __fst.st_dev && __pst.st_ino == __fst.st_ino)
+        return;
+
+    int __fd = open(__pf->__pathname ,(__pf->fg & ~O_EXCL) | O_CREAT ,0774);
+    if(__fd == -1)
+    {
+        PRINT_ERROR();
+        return;
+    }
+    if(dup2(__fd ,__pf->fd) == -1)
+        PRINT_ERROR();
+    close(__fd);
+}
+
+/**
+ * @name    _log_prealloc
+ * @brief   为当前分段预分配 __rot_size 字节（FALLOC_FL_KEEP_SIZE，不改变文件大小），
+ *          追加写入时不再逐块分配，减少碎片与元数据更新。文件系统不支持时忽略。
+ */
+static void _log_prealloc(void)
+{
+    if(__log->__rot_size > __log->__seg_bytes)
+        _file_fallocate(__log->__pf ,FALLOC_FL_KEEP_SIZE ,0 ,__log->__rot_size);
+}
+
+/**
+ * @name    _log_rotate
+ * @brief   轮转日志：run.log.(N-1) -> run.log.N ... run.log -> run.log.1，新建 run.log 并替换描述符。
+ *
+ * 新分段通过 dup2 原子地替换原描述符，同步模式下其它线程无需加锁即可继续写入；
+ * 二进制格式下在替换之前直接向新描述符写出文件头与已登记的格式串，其它线程的记录
+ * 只会排在文件头之后；替换期间新登记的格式串在替换后补写。
+ * 不取 __log_fmt_lock：异步模式下登记线程持锁等待队列空位，刷写线程取锁会死锁。
+ */
+static void _log_rotate(void)
+{
+    _file_t *__pf = __log->__pf;
+    char __from[PATH_MAX] ,__to[PATH_MAX];
+    struct stat __st;
+
+    /* 先移动历史分段，这一步不影响正在写入的当前分段 */
+    if(__log->__rot_keep > 0)
+    {
+        snprintf(__to ,sizeof(__to) ,"%s.%u" ,__pf->__pathname ,__log->__rot_keep);
+        unlink(__to);
+        for(unsigned __i = __log->__rot_keep - 1; __i >= 1; __i--)
+        {
+            snprintf(__from ,sizeof(__from) ,"%s.%u" ,__pf->__pathname ,__i);
+            snprintf(__to ,sizeof(__to) ,"%s.%u" ,__pf->__pathname ,__i + 1);
+            if(rename(__from ,__to) == -1 && errno != ENOENT)
+                PRINT_ERROR();
+        }
+    }
+
+    int __old = dup(__pf->fd);
+
+    /* 改名与新建紧挨着进行，缩短其它线程仍写入旧分段的窗口 */
+    if(__log->__rot_keep == 0)
+        unlink(__pf->__pathname);
+    else
+    {
+        snprintf(__to ,sizeof(__to) ,"%s.1" ,__pf->__pathname);
+        if(rename(__pf->__pathname ,__to) == -1)
+            PRINT_ERROR();
+    }
+
+    int __fd = open(__pf->__pathname ,(__pf->fg & ~O_EXCL) | O_CREAT ,0774);
+    if(__fd == -1)
+    {
+        PRINT_ERROR();
+        if(__old != -1)
+            close(__old);
+        return;
+    }
+
+    int __bin = (__atomic_load_n(&__log->__format ,__ATOMIC_ACQUIRE) == LOG_FORMAT_BINARY);
+    int __nfmts = 0;
+    if(__bin)
+    {
+        __nfmts = __atomic_load_n(&__log_nfmts ,__ATOMIC_ACQUIRE);
+        _log_bin_write_header(__fd ,0 ,__nfmts);
+    }
+
+    /* 先清零再替换描述符：替换前仍写入旧分段的少量数据计入新分段，只会使下次轮转略早 */
+    __atomic_store_n(&__log->__seg_bytes ,0 ,__ATOMIC_RELAXED);
+    __log->__seg_start = time(NULL);
+    if(dup2(__fd ,__pf->fd) == -1)
+        PRINT_ERROR();
+    close(__fd);
+
+    /* 快照之后登记的格式串其定义可能已写入旧分段，补写一次（解码端以最后一次登记为准） */
+    if(__bin)
+    {
+        int __now = __atomic_load_n(&__log_nfmts ,__ATOMIC_ACQUIRE);
+        if(__now > __nfmts)
+            _log_bin_write_header(__pf->fd ,__nfmts ,__now);
+    }
+
+    /* 旧分段：释放文件尾之后未用完的预分配空间 */
+    if(__old != -1)
+    {
+        if(fstat(__old ,&__st) == 0 && ftruncate(__old ,__st.st_size) == -1)
+            PRINT_ERROR();
+        close(__old);
+    }
+
+    _log_prealloc();
+}
+
+/**
+ * @name    _log_rotate_due
+ * @brief   当前分段是否达到大小或时长上限。
+ */
+static int _log_rotate_due(void)
+{
+    if(__log->__rot_size > 0 && __atomic_load_n(&__log->__seg_bytes ,__ATOMIC_RELAXED) >= __log->__rot_size)
+        return 1;
+    if(__log->__rot_interval > 0 && time(NULL) - __log->__seg_start >= (time_t)__log->__rot_interval)
+        return 1;
+    return 0;
+}
+
+/**
+ * @name    _log_set_rotate
+ * @brief   设置日志轮转策略。
+ *
+ * @param[in]   __size      单个分段大小上限（字节），0 表示不按大小轮转；非 0 时每个分段按此大小预分配。
+ * @param[in]   __interval  单个分段时长上限（秒），0 表示不按时间轮转。
+ * @param[in]   __keep      保留的历史分段数（run.log.1 ~ run.log.N），0 表示轮转时直接删除旧分段。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ *
+ * @note
+ * - 轮转在写出日志之后检查：同步模式由越过上限的写入线程执行，异步模式只在刷写线程中执行；
+ * - 同步模式与分线程暂存模式下轮转期间其它线程的写入仍可能落入旧分段，分段大小会超出上限
+ *   （暂存模式每次写入整个缓冲区，线程多时超出更明显）；异步模式只有刷写线程写文件，分段大小严格受控；
+ * - 建议在 `_log_init()` 之后、创建其它线程之前调用。
+ */
+int _log_set_rotate(off_t __size ,unsigned __interval ,unsigned __keep)
+{
+    if(__log == NULL || __size < 0)
+        return -1;
+
+    __log->__rot_size = __size;
+    __log->__rot_interval = __interval;
+    __log->__rot_keep = __keep;
+    _log_prealloc();
+    return 0;
+}
+
+/**
+ * @name    _log_output
+ * @brief   日志输出出口：把若干条日志行一次性写入日志文件。
+ *
+ * 日志文件以 O_APPEND 打开，每次 writev 的整批内容在内核中原子地追加到文件尾，
+ * 因此不需要 lseek，也不需要在写入前后 stat；直接使用描述符，不修改 `_file_t` 中的
+ * 偏移等字段，多线程并发调用安全。每累计 LOG_CHECK_INTERVAL 行检查一次日志文件；
+ * 启用轮转时写入后检查当前分段是否达到上限。
+ *
+ * @return  成功返回写入字节数，失败返回 -1。
+ */
+static int _log_output(const struct iovec *__iov ,int __cnt)
+{
+    ssize_t __ret = writev(__log->__pf->fd ,__iov ,__cnt);
+
+    if(__ret > 0 && (__log->__rot_size > 0 || __log->__rot_interval > 0))
+    {
+        __atomic_add_fetch(&__log->__seg_bytes ,__ret ,__ATOMIC_RELAXED);
+        if(_log_rotate_due() && !__atomic_exchange_n(&__log->__rotating ,1 ,__ATOMIC_ACQUIRE))
+        {
+            /* 取得轮转权后复查，避免其它线程刚完成轮转又重复轮转 */
+            if(_log_rotate_due())
+                _log_rotate();
+            __atomic_store_n(&__log->__rotating ,0 ,__ATOMIC_RELEASE);
+        }
+    }
+
+    unsigned long __old = __atomic_fetch_add(&__log->__lines ,__cnt ,__ATOMIC_RELAXED);
+    if(__old / LOG_CHECK_INTERVAL != (__old + __cnt) / LOG_CHECK_INTERVAL &&
+       !__atomic_exchange_n(&__log->__checking ,1 ,__ATOMIC_ACQUIRE))
+    {
+        _log_check_file();
+        __atomic_store_n(&__log->__checking ,0 ,__ATOMIC_RELEASE);
+    }
+
+    return (__ret < 0) ? -1 : (int)__ret;
+}
+
+/**********************************************************************************************
+ * 异步模式：有界多生产者环形队列
+ *********************************************************************************************/
+/**
+ * @name    _log_ring_claim
+ * @brief   生产者领取一个空闲槽位。
+ *
+ * @param[out]  __pos   领取到的入队位置，提交时使用。
+ *
+ * @return  槽位指针；队列已满返回 NULL。
+ */
+static struct _log_slot* _log_ring_claim(struct _log_ring *__r ,size_t *__pos)
+{
+    size_t __p = __atomic_load_n(&__r->__head ,__ATOMIC_RELAXED);
+    for(;;)
+    {
+        struct _log_slot *__s = &__r->__slots[__p & __r->__mask];
+        size_t __seq = __atomic_load_n(&__s->__seq ,__ATOMIC_ACQUIRE);
+        long __dif = (long)(__seq - __p);
+        if(__dif == 0)
+        {
+            /* 槽位空闲，CAS 抢占入队位置；失败时 __p 被更新为最新值 */
+            if(__atomic_compare_exchange_n(&__r->__head ,&__p ,__p + 1 ,1 ,
+                    __ATOMIC_RELAXED ,__ATOMIC_RELAXED))
+            {
+                *__pos = __p;
+                return __s;
+            }
+        }
+        else if(__dif < 0)
+            return NULL;
+        else
+            __p = __atomic_load_n(&__r->__head ,__ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @name    _log_ring_take
+ * @brief   取出最旧的一条已发布日志（刷写线程与覆盖策略共用）。
+ *
+ * @param[out]  __pos   取到的出队位置，释放槽位时使用。
+ *
+ * @return  槽位指针；最旧的一条尚未发布（或队列为空）返回 NULL。
+ */
+static struct _log_slot* _log_ring_take(struct _log_ring *__r ,size_t *__pos)
+{
+    size_t __p = __atomic_load_n(&__r->__tail ,__ATOMIC_RELAXED);
+    for(;;)
+    {
+        struct _log_slot *__s = &__r->__slots[__p & __r->__mask];
+        size_t __seq = __atomic_load_n(&__s->__seq ,__ATOMIC_ACQUIRE);
+        long __dif = (long)(__seq - (__p + 1));
+        if(__dif == 0)
+        {
+            if(__atomic_compare_exchange_n(&__r->__tail ,&__p ,__p + 1 ,1 ,
+                    __ATOMIC_RELAXED ,__ATOMIC_RELAXED))
+            {
+                *__pos = __p;
+                return __s;
+            }
+        }
+        else if(__dif < 0)
+            return NULL;
+        else
+            __p = __atomic_load_n(&__r->__tail ,__ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @name    _log_ring_release
+ * @brief   归还已处理的槽位，使其可被下一轮入队复用。
+ */
+static void _log_ring_release(struct _log_ring *__r ,struct _log_slot *__s ,size_t __pos)
+{
+    __atomic_store_n(&__s->__seq ,__pos + __r->__mask + 1 ,__ATOMIC_RELEASE);
+    __atomic_add_fetch(&__r->__done ,1 ,__ATOMIC_RELEASE);
+}
+
+/**
+ * @name    _log_timedwait
+ * @brief   在条件变量上最多等待 __ms 毫秒（调用者已持有 __lock）。
+ */
+static void _log_timedwait(pthread_cond_t *__cond ,pthread_mutex_t *__lock ,unsigned __ms)
+{
+    struct timespec __ts;
+    clock_gettime(CLOCK_REALTIME ,&__ts);
+    __ts.tv_sec += __ms / 1000;
+    __ts.tv_nsec += (long)(__ms % 1000) * 1000000L;
+    if(__ts.tv_nsec >= 1000000000L)
+    {
+        __ts.tv_sec++;
+        __ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(__cond ,__lock ,&__ts);
+}
+
+/**
+ * @name    _log_wake
+ * @brief   刷写线程休眠时将其唤醒；__force 为 0 时仅在其休眠时才进入互斥锁。
+ */
+static void _log_wake(int __force)
+{
+    if(!__force && !__atomic_load_n(&__log->__sleeping ,__ATOMIC_SEQ_CST))
+        return;
+    pthread_mutex_lock(&__log->__lock);
+    pthread_cond_signal(&__log->__cond);
+    pthread_mutex_unlock(&__log->__lock);
+}
+
+/**
+ * @name    _log_report_drop
+ * @brief   自上次提示后有日志被丢弃时，向日志文件追加一条提示行。
+ */
+static void _log_report_drop(void)
+{
+    unsigned long __n = __atomic_load_n(&__log->__dropped ,__ATOMIC_RELAXED);
+    if(__n == __log->__reported)
+        return;
+
+    char __buf[LOG_LINE_MAX];
+    int __len = _log_fillf(__buf ,sizeof(__buf) ,"[WARN]" ,"log: %lu messages dropped",
+        __n - __log->__reported);
+    __log->__reported = __n;
+    if(__len < 0)
+        return;
+
+    struct iovec __iov = { .iov_base = __buf ,.iov_len = __len };
+    _log_output(&__iov ,1);
+}
+
+/**
+ * @name    _log_flusher
+ * @brief   刷写线程：按入队顺序收集已发布的日志行，每批一次 writev 写入日志文件。
+ *
+ * 队列为空时在条件变量上休眠，最长 __interval_ms 毫秒（默认 LOG_FLUSH_INTERVAL_MS）；
+ * 收到退出标志后把队列中剩余的日志全部写完才返回。
+ */
+static void* _log_flusher(void *__arg)
+{
+    struct _log_ring *__r = &__log->__ring;
+    struct iovec __iov[LOG_FLUSH_BATCH];
+    struct _log_slot *__slot[LOG_FLUSH_BATCH];
+    size_t __pos[LOG_FLUSH_BATCH];
+    (void)__arg;
+
+    for(;;)
+    {
+        int __n = 0;
+        while(__n < LOG_FLUSH_BATCH && (__slot[__n] = _log_ring_take(__r ,&__pos[__n])) != NULL)
+        {
+            __iov[__n].iov_base = __slot[__n]->__data;
+            __iov[__n].iov_len = __slot[__n]->__len;
+            __n++;
+        }
+
+        if(__n > 0)
+        {
+            _log_output(__iov ,__n);
+            for(int __i = 0; __i < __n; __i++)
+                _log_ring_release(__r ,__slot[__i] ,__pos[__i]);
+            _log_report_drop();
+            continue;
+        }
+
+        _log_report_drop();
+
+        if(__atomic_load_n(&__log->__stop ,__ATOMIC_ACQUIRE))
+        {
+            /* 仍有生产者正在填写已领取的槽位时，等待其发布后再写完 */
+            if(__atomic_load_n(&__r->__head ,__ATOMIC_ACQUIRE) == __atomic_load_n(&__r->__tail ,__ATOMIC_ACQUIRE))
+                break;
+            sched_yield();
+            continue;
+        }
+
+        /* 休眠：先置标志再复查队列，与生产者“先发布再读标志”配对，避免丢失唤醒 */
+        pthread_mutex_lock(&__log->__lock);
+        __atomic_store_n(&__log->__sleeping ,1 ,__ATOMIC_SEQ_CST);
+        size_t __t = __atomic_load_n(&__r->__tail ,__ATOMIC_RELAXED);
+        size_t __seq = __atomic_load_n(&__r->__slots[__t & __r->__mask].__seq ,__ATOMIC_SEQ_CST);
+        if(__seq != __t + 1 && !__atomic_load_n(&__log->__stop ,__ATOMIC_ACQUIRE))
+            _log_timedwait(&__log->__cond ,&__log->__lock ,__atomic_load_n(&__log->__interval_ms ,__ATOMIC_RELAXED));
+        __atomic_store_n(&__log->__sleeping ,0 ,__ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&__log->__lock);
+    }
+    return NULL;
+}
+
+/**
+ * @name    _log_async_claim
+ * @brief   异步模式领取槽位，队列已满时按背压策略处理。
+ *
+ * @param[in]   __block 非 0 时无论策略如何都等待空槽（用于格式串登记等不可丢失的记录）。
+ * @param[out]  __pos   领取到的入队位置。
+ *
+ * @return  槽位指针；被丢弃返回 NULL（已计入丢弃计数）。
+ */
+static struct _log_slot* _log_async_claim(int __block ,size_t *__pos)
+{
+    struct _log_ring *__r = &__log->__ring;
+    struct _log_slot *__s;
+    unsigned __spin = 0;
+
+    while((__s = _log_ring_claim(__r ,__pos)) == NULL)
+    {
+        if(!__block && __log->__policy == LOG_POLICY_OVERWRITE)
+        {
+            /* 丢弃最旧的一条已发布日志；已被刷写线程取走或尚未发布则只能丢弃本条 */
+            size_t __old;
+            struct _log_slot *__os = _log_ring_take(__r ,&__old);
+            if(__os == NULL)
+                break;
+            _log_ring_release(__r ,__os ,__old);
+            __atomic_add_fetch(&__log->__dropped ,1 ,__ATOMIC_RELAXED);
+            continue;
+        }
+        if(!__block && __log->__policy != LOG_POLICY_BLOCK)
+            break;
+
+        /* 阻塞策略：唤醒刷写线程后让出 CPU，多次仍满则短暂休眠 */
+        _log_wake(1);
+        if(++__spin < 16)
+            sched_yield();
+        else
+            usleep(100);
+    }
+
+    if(__s == NULL)
+        __atomic_add_fetch(&__log->__dropped ,1 ,__ATOMIC_RELAXED);
+    return __s;
+}
+
+/**
+ * @name    _log_async_commit
+ * @brief   发布已填写的槽位，队列中积累到 __batch 条时唤醒刷写线程。
+ */
+static void _log_async_commit(struct _log_slot *__s ,size_t __pos ,int __len)
+{
+    __s->__len = (__len < 0) ? 0 : __len;
+    __atomic_store_n(&__s->__seq ,__pos + 1 ,__ATOMIC_SEQ_CST);
+    if(__pos + 1 - __atomic_load_n(&__log->__ring.__tail ,__ATOMIC_RELAXED) >= __log->__batch)
+        _log_wake(0);
+}
+
+/**
+ * @name    _log_emit_raw
+ * @brief   写出一条已生成好的记录（二进制头部与格式串登记），不会被背压策略丢弃。
+ *
+ * 异步模式下经队列按序写出；在刷写线程内调用时直接写文件，避免等待自身。
+ */
+static int _log_emit_raw(const void *__rec ,size_t __len)
+{
+    if(__atomic_load_n(&__log->__mode ,__ATOMIC_ACQUIRE) == LOG_MODE_ASYNC &&
+       !pthread_equal(pthread_self() ,__log->__flusher))
+    {
+        size_t __pos;
+        struct _log_slot *__s = _log_async_claim(1 ,&__pos);
+        memcpy(__s->__data ,__rec ,__len);
+        _log_async_commit(__s ,__pos ,__len);
+        return __len;
+    }
+
+    struct iovec __iov = { .iov_base = (void *)__rec ,.iov_len = __len };
+    return _log_output(&__iov ,1);
+}
+
+/**
+ * @name    _log_async_start
+ * @brief   切换到异步写入模式：分配环形队列并启动刷写线程。
+ *
+ * @param[in]   __slots     槽位数，0 使用 LOG_RING_SLOTS，非 2 的幂时向上取整。
+ * @param[in]   __policy    队列已满时的背压策略（log_policy_t）。
+ *
+ * @return  成功返回 0，失败返回 -1（保持同步模式）。
+ *
+ * @note    应在创建其它线程之前调用；重复调用直接返回 0。
+ */
+int _log_async_start(unsigned __slots ,int __policy)
+{
+    if(__log == NULL || __policy < LOG_POLICY_DROP || __policy > LOG_POLICY_OVERWRITE)
+        return -1;
+    if(__log->__mode == LOG_MODE_ASYNC)
+        return 0;
+    if(__log->__mode != LOG_MODE_SYNC)
+        return -1;
+
+    size_t __n = (__slots == 0) ? LOG_RING_SLOTS : 2;
+    while(__n < __slots)
+        __n <<= 1;
+
+    struct _log_ring *__r = &__log->__ring;
+    __r->__slots = (struct _log_slot *)malloc(__n * sizeof(struct _log_slot));
+    if(__r->__slots == NULL)
+        return -1;
+    for(size_t __i = 0; __i < __n; __i++)
+        __r->__slots[__i].__seq = __i;
+    __r->__mask = __n - 1;
+    __r->__head = 0;
+    __r->__tail = 0;
+    __r->__done = 0;
+
+    __log->__policy = __policy;
+    __log->__stop = 0;
+    __log->__sleeping = 0;
+    if(pthread_create(&__log->__flusher ,NULL ,_log_flusher ,NULL) != 0)
+    {
+        free(__r->__slots);
+        __r->__slots = NULL;
+        return -1;
+    }
+
+    __atomic_store_n(&__log->__mode ,LOG_MODE_ASYNC ,__ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @name    _log_async_stop
+ * @brief   写完队列中剩余日志，停止刷写线程并切回同步模式。
+ *
+ * @note    调用时不应再有其它线程写日志。
+ */
+void _log_async_stop(void)
+{
+    if(__log == NULL || __log->__mode != LOG_MODE_ASYNC)
+        return;
+
+    __atomic_store_n(&__log->__stop ,1 ,__ATOMIC_RELEASE);
+    _log_wake(1);
+    pthread_join(__log->__flusher ,NULL);
+
+    __atomic_store_n(&__log->__mode ,LOG_MODE_SYNC ,__ATOMIC_RELEASE);
+    free(__log->__ring.__slots);
+    __log->__ring.__slots = NULL;
+}
+
+/**
+ * @name    _log_flush
+ * @brief   补写限速/合并的待提示计数，并等待调用时刻之前已入队的日志全部写出：
+ *          异步模式下的日志文件、分线程暂存模式下所有线程的暂存内容与全部附加 sink。
+ */
+void _log_flush(void)
+{
+    if(__log == NULL)
+        return;
+
+    _log_site_report();
+    if(__atomic_load_n(&__log->__mode ,__ATOMIC_ACQUIRE) == LOG_MODE_STAGED)
+        _log_stage_flush_all(0);
+
+    int __n = __atomic_load_n(&__log->__nsinks ,__ATOMIC_ACQUIRE);
+    for(int __i = 0; __i < __n; __i++)
+    {
+        struct _log_sink *__s = &__log->__sinks[__i];
+        size_t __target = __atomic_load_n(&__s->__ring.__head ,__ATOMIC_ACQUIRE);
+        while((long)(__atomic_load_n(&__s->__ring.__done ,__ATOMIC_ACQUIRE) - __target) < 0)
+        {
+            _log_sink_wake(__s ,1);
+            usleep(100);
+        }
+    }
+
+    if(__atomic_load_n(&__log->__mode ,__ATOMIC_ACQUIRE) != LOG_MODE_ASYNC)
+        return;
+
+    struct _log_ring *__r = &__log->__ring;
+    size_t __target = __atomic_load_n(&__r->__head ,__ATOMIC_ACQUIRE);
+    while((long)(__atomic_load_n(&__r->__done ,__ATOMIC_ACQUIRE) - __target) < 0)
+    {
+        _log_wake(1);
+        usleep(100);
+    }
+}
+
+/**
+ * @name    _log_dropped
+ * @brief   获取累计丢弃的日志条数（DROP/OVERWRITE 策略下队列满时计数）。
+ */
+unsigned long _log_dropped(void)
+{
+    return (__log == NULL) ? 0 : __atomic_load_n(&__log->__dropped ,__ATOMIC_RELAXED);
+}
+
+/**********************************************************************************************
+ * 分线程暂存模式
+ *********************************************************************************************/
+static void _log_stage_key_init(void);
+static void _log_stage_destroy(void *__arg);
+
+/* 暂存缓冲区的 TLS 键，进程内只创建一次，多次启停暂存模式共用 */
+static __thd_tls_t __log_stage_tls = {
+    .__destructor = _log_stage_destroy,
+    .__once = { PTHREAD_ONCE_INIT ,_log_stage_key_init }
+};
+static int __log_stage_key_ok = 0;
+static struct _log_stage *__log_stages = NULL;      ///< 全部线程的暂存缓冲区
+static pthread_mutex_t __log_stage_lock = PTHREAD_MUTEX_INITIALIZER;   ///< 保护 __log_stages
+
+/**
+ * @name    _log_stage_key_init
+ * @brief   创建暂存缓冲区的 TLS 键（经 __thread_once 只执行一次）。
+ */
+static void _log_stage_key_init(void)
+{
+    __log_stage_key_ok = (__thread_key_create(&__log_stage_tls) == 0);
+}
+
+/**
+ * @name    _log_now_ms
+ * @brief   粗粒度单调时钟（毫秒），用于判断暂存超时。
+ */
+static uint64_t _log_now_ms(void)
+{
+    struct timespec __ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE ,&__ts);
+    return (uint64_t)__ts.tv_sec * 1000 + __ts.tv_nsec / 1000000;
+}
+
+/**
+ * @name    _log_stage_flush_locked
+ * @brief   把暂存缓冲区的内容一次写入日志文件（调用者已持有 __st->__lock）。
+ */
+static void _log_stage_flush_locked(struct _log_stage *__st)
+{
+    if(__st->__len == 0)
+        return;
+    struct iovec __iov = { .iov_base = __st->__buf ,.iov_len = __st->__len };
+    _log_output(&__iov ,1);
+    __st->__len = 0;
+}
+
+/**
+ * @name    _log_stage_destroy
+ * @brief   TLS 析构函数：线程退出（__thread_exit/pthread_exit 或线程函数返回）时写出剩余内容并释放缓冲区。
+ */
+static void _log_stage_destroy(void *__arg)
+{
+    struct _log_stage *__st = (struct _log_stage *)__arg;
+
+    pthread_mutex_lock(&__log_stage_lock);
+    if(__st->__prev != NULL)
+        __st->__prev->__next = __st->__next;
+    else
+        __log_stages = __st->__next;
+    if(__st->__next != NULL)
+        __st->__next->__prev = __st->__prev;
+    pthread_mutex_unlock(&__log_stage_lock);
+
+    pthread_mutex_lock(&__st->__lock);
+    if(__log != NULL)
+        _log_stage_flush_locked(__st);
+    pthread_mutex_unlock(&__st->__lock);
+
+    pthread_mutex_destroy(&__st->__lock);
+    free(__st);
+}
+
+/**
+ * @name    _log_stage_get
+ * @brief   获取当前线程的暂存缓冲区，首次调用时分配、绑定到 TLS 键并登记到全局链表。
+ *
+ * @return  暂存缓冲区；分配或绑定失败返回 NULL（调用者退回同步写入）。
+ */
+static struct _log_stage* _log_stage_get(void)
+{
+    struct _log_stage *__st = (struct _log_stage *)__thread_key_getspecific(&__log_stage_tls);
+    if(__st != NULL)
+        return __st;
+
+    size_t __cap = __log->__stage_size;
+    __st = (struct _log_stage *)malloc(sizeof(struct _log_stage) + __cap);
+    if(__st == NULL)
+        return NULL;
+    pthread_mutex_init(&__st->__lock ,NULL);
+    __st->__cap = __cap;
+    __st->__len = 0;
+    __st->__first = 0;
+    __st->__prev = NULL;
+
+    if(__thread_key_setspecific(&__log_stage_tls ,__st) != 0)
+    {
+        pthread_mutex_destroy(&__st->__lock);
+        free(__st);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&__log_stage_lock);
+    __st->__next = __log_stages;
+    if(__log_stages != NULL)
+        __log_stages->__prev = __st;
+    __log_stages = __st;
+    pthread_mutex_unlock(&__log_stage_lock);
+    return __st;
+}
+
+/**
+ * @name    _log_stage_write
+ * @brief   把一条日志追加到本线程的暂存缓冲区；放不下下一条最长日志或最早一条已暂存超时则写出。
+ *
+ * @return  记录长度，格式化失败返回 -1。
+ */
+static int _log_stage_write(struct _log_stage *__st ,int __fid ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    pthread_mutex_lock(&__st->__lock);
+
+    if(__st->__len + LOG_LINE_MAX > __st->__cap)
+        _log_stage_flush_locked(__st);
+
+    uint64_t __now = _log_now_ms();
+    int __len = _log_fill(__st->__buf + __st->__len ,LOG_LINE_MAX ,__fid ,__name ,__fmt_str ,__args);
+    if(__len > 0)
+    {
+        if(__st->__len == 0)
+            __st->__first = __now;
+        __st->__len += __len;
+    }
+
+    if(__st->__len + LOG_LINE_MAX > __st->__cap ||
+       __now - __st->__first >= __atomic_load_n(&__log->__stage_interval ,__ATOMIC_RELAXED))
+        _log_stage_flush_locked(__st);
+
+    pthread_mutex_unlock(&__st->__lock);
+    return __len;
+}
+
+/**
+ * @name    _log_stage_flush_all
+ * @brief   写出所有线程的暂存内容。
+ *
+ * @param[in]   __expired   非 0 时只写出暂存超时的缓冲区，且跳过正被其所属线程使用的缓冲区（扫描线程）。
+ */
+static void _log_stage_flush_all(int __expired)
+{
+    uint64_t __now = _log_now_ms();
+    unsigned __interval = __atomic_load_n(&__log->__stage_interval ,__ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&__log_stage_lock);
+    for(struct _log_stage *__st = __log_stages; __st != NULL; __st = __st->__next)
+    {
+        if(!__expired)
+            pthread_mutex_lock(&__st->__lock);
+        else if(pthread_mutex_trylock(&__st->__lock) != 0)
+            continue;
+
+        if(!__expired || (__st->__len > 0 && __now - __st->__first >= __interval))
+            _log_stage_flush_locked(__st);
+        pthread_mutex_unlock(&__st->__lock);
+    }
+    pthread_mutex_unlock(&__log_stage_lock);
+}
+
+/**
+ * @name    _log_stage_sweeper
+ * @brief   扫描线程：每个暂存间隔写出一次超时的缓冲区，避免之后不再写日志的线程的内容滞留。
+ */
+static void* _log_stage_sweeper(void *__arg)
+{
+    (void)__arg;
+
+    pthread_mutex_lock(&__log->__lock);
+    while(!__atomic_load_n(&__log->__stop ,__ATOMIC_ACQUIRE))
+    {
+        _log_timedwait(&__log->__cond ,&__log->__lock ,__atomic_load_n(&__log->__stage_interval ,__ATOMIC_RELAXED));
+        pthread_mutex_unlock(&__log->__lock);
+        _log_stage_flush_all(1);
+        pthread_mutex_lock(&__log->__lock);
+    }
+    pthread_mutex_unlock(&__log->__lock);
+    return NULL;
+}
+
+/**
+ * @name    _log_stage_start
+ * @brief   切换到分线程暂存模式：每个线程经 TLS 绑定自己的暂存缓冲区，满或超时后一次写入文件。
+ *
+ * @param[in]   __size          每线程缓冲区大小，0 使用 LOG_STAGE_SIZE，不小于 2 * LOG_LINE_MAX。
+ * @param[in]   __interval_ms   最长暂存时间（毫秒），0 使用 LOG_STAGE_INTERVAL_MS。
+ *
+ * @return  成功返回 0，失败返回 -1（保持同步模式）。
+ *
+ * @note
+ * - 只能从同步模式切换，与异步模式互斥；
+ * - 每个线程的日志按本线程顺序写出，不同线程之间的行在文件中按写出批次交错，
+ *   不再严格按时间戳排序；
+ * - 线程经 `__thread_exit` 退出时由 TLS 析构函数写出剩余内容；主线程与仍在运行的线程的内容
+ *   由后台扫描线程按暂存间隔写出，`_log_flush()` 与 `_log_free()` 立即写出全部内容；
+ * - 缓冲区大小只对之后首次写日志的线程生效。
+ */
+int _log_stage_start(size_t __size ,unsigned __interval_ms)
+{
+    if(__log == NULL)
+        return -1;
+    if(__log->__mode == LOG_MODE_STAGED)
+        return 0;
+    if(__log->__mode != LOG_MODE_SYNC)
+        return -1;
+
+    __thread_once(&__log_stage_tls.__once);
+    if(!__log_stage_key_ok)
+        return -1;
+
+    __log->__stage_size = (__size == 0) ? LOG_STAGE_SIZE : __size;
+    if(__log->__stage_size < 2 * LOG_LINE_MAX)
+        __log->__stage_size = 2 * LOG_LINE_MAX;
+    __log->__stage_interval = (__interval_ms == 0) ? LOG_STAGE_INTERVAL_MS : __interval_ms;
+
+    __log->__stop = 0;
+    if(pthread_create(&__log->__flusher ,NULL ,_log_stage_sweeper ,NULL) != 0)
+        return -1;
+
+    __atomic_store_n(&__log->__mode ,LOG_MODE_STAGED ,__ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @name    _log_stage_stop
+ * @brief   写出所有线程的暂存内容，停止扫描线程并切回同步模式。
+ *
+ * @note    调用时不应再有其它线程写日志；各线程的缓冲区保留到线程退出时释放。
+ */
+void _log_stage_stop(void)
+{
+    if(__log == NULL || __log->__mode != LOG_MODE_STAGED)
+        return;
+
+    __atomic_store_n(&__log->__mode ,LOG_MODE_SYNC ,__ATOMIC_RELEASE);
+    __atomic_store_n(&__log->__stop ,1 ,__ATOMIC_RELEASE);
+    _log_wake(1);
+    pthread_join(__log->__flusher ,NULL);
+    _log_stage_flush_all(0);
+}
+
+/**********************************************************************************************
+ * 飞行记录器
+ *********************************************************************************************/
+/**
+ * @name    _log_flight_write
+ * @brief   把一条文本日志行写入飞行记录器：一次 fetch_add 领取序号，写入后以 release 提交。
+ *
+ * @return  日志行长度，格式化失败返回 -1（槽位仍提交为空行）。
+ */
+static int _log_flight_write(const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    struct _log_flight_hdr *__h = __atomic_load_n(&__log->__flight ,__ATOMIC_ACQUIRE);
+    if(__h == NULL)
+        return -1;
+
+    uint64_t __pos = __atomic_fetch_add(&__h->__head ,1 ,__ATOMIC_RELAXED);
+    struct _log_flight_slot *__s = (struct _log_flight_slot *)((char *)__h + sizeof(*__h) +
+                                   (size_t)(__pos & (__h->__nslots - 1)) * sizeof(struct _log_flight_slot));
+
+    __atomic_store_n(&__s->__seq ,0 ,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    int __len = _log_format(__s->__data ,sizeof(__s->__data) ,__name ,__fmt_str ,__args);
+    __s->__len = (__len < 0) ? 0 : __len;
+    __atomic_store_n(&__s->__seq ,__pos + 1 ,__ATOMIC_RELEASE);
+    return __len;
+}
+
+/**
+ * @name    _log_flight_open
+ * @brief   创建飞行记录器并启用 LOG_BACKEND_FLIGHT 后端。
+ *
+ * @param[in]   __name  共享内存名：以 '/' 开头时作为完整路径，否则为 /dev/shm/<name>；
+ *                      NULL 表示使用 memfd（运行中可经 /proc/<pid>/fd 读取，进程退出后不保留）。
+ * @param[in]   __slots 槽位数，0 使用 LOG_FLIGHT_SLOTS，非 2 的幂时向上取整。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ *
+ * @note
+ * - 文件已存在时重新初始化（上次崩溃留下的内容应在启动前先用 log_decode -f 导出）；
+ * - 飞行记录器总是保存文本日志行，不受 _log_set_format 影响；
+ * - 与等级过滤共用阈值，常开 TRACE 时可只把文件后端的 sink 等级调高。
+ */
+int _log_flight_open(const char *__name ,unsigned __slots)
+{
+    if(__log == NULL || __log->__flight != NULL)
+        return -1;
+
+    uint32_t __n = (__slots == 0) ? LOG_FLIGHT_SLOTS : 2;
+    while(__n < __slots)
+        __n <<= 1;
+    size_t __len = sizeof(struct _log_flight_hdr) + (size_t)__n * sizeof(struct _log_flight_slot);
+
+    int __fd;
+    if(__name == NULL)
+        __fd = memfd_create("log_flight" ,MFD_CLOEXEC);
+    else
+    {
+        char __path[PATH_MAX];
+        snprintf(__path ,sizeof(__path) ,(__name[0] == '/') ? "%s" : "/dev/shm/%s" ,__name);
+        __fd = open(__path ,O_RDWR | O_CREAT | O_CLOEXEC ,0644);
+    }
+    if(__fd == -1)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    if(ftruncate(__fd ,0) == -1 || ftruncate(__fd ,__len) == -1)
+    {
+        PRINT_ERROR();
+        close(__fd);
+        return -1;
+    }
+
+    struct _log_flight_hdr *__h = mmap(NULL ,__len ,PROT_READ | PROT_WRITE ,MAP_SHARED ,__fd ,0);
+    close(__fd);
+    if(__h == MAP_FAILED)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    __h->__version = LOG_FLIGHT_VERSION;
+    __h->__slot_size = sizeof(struct _log_flight_slot);
+    __h->__nslots = __n;
+    __h->__head = 0;
+    __h->__pid = getpid();
+    __atomic_store_n(&__h->__magic ,LOG_FLIGHT_MAGIC ,__ATOMIC_RELEASE);
+
+    __log->__flight_len = __len;
+    __atomic_store_n(&__log->__flight ,__h ,__ATOMIC_RELEASE);
+    __atomic_or_fetch(&__log->__backend ,LOG_BACKEND_FLIGHT ,__ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @name    _log_flight_close
+ * @brief   关闭飞行记录器（解除映射，/dev/shm 下的文件保留供事后导出）。
+ *
+ * @note    调用时不应再有其它线程写日志。
+ */
+void _log_flight_close(void)
+{
+    if(__log == NULL || __log->__flight == NULL)
+        return;
+
+    __atomic_and_fetch(&__log->__backend ,~LOG_BACKEND_FLIGHT ,__ATOMIC_RELEASE);
+    munmap(__log->__flight ,__log->__flight_len);
+    __log->__flight = NULL;
+    __log->__flight_len = 0;
+}
+
+/**
+ * @name    _log_set_backend
+ * @brief   选择启用的日志后端。
+ *
+ * @param[in]   __backend   LOG_BACKEND_FILE | LOG_BACKEND_FLIGHT 的组合；
+ *                          包含 LOG_BACKEND_FLIGHT 时须已调用 _log_flight_open。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ */
+int _log_set_backend(int __backend)
+{
+    if(__log == NULL || (__backend & ~(LOG_BACKEND_FILE | LOG_BACKEND_FLIGHT)) != 0)
+        return -1;
+    if((__backend & LOG_BACKEND_FLIGHT) && __log->__flight == NULL)
+        return -1;
+
+    __atomic_store_n(&__log->__backend ,__backend ,__ATOMIC_RELEASE);
+    return 0;
+}
+
+/**********************************************************************************************
+ * 附加 sink：标准错误、unix 数据报套接字
+ *********************************************************************************************/
+/**
+ * @name    _log_name_level
+ * @brief   由日志名称 "[LEVEL]" 得到等级（LOG_PRINT 的名称），其它名称按 INFO。
+ */
+static int _log_name_level(const char *__name)
+{
+    return (__name[0] == '[') ? LOG_LEVEL_OF(__name + 1) : LOG_LEVEL_INFO;
+}
+
+/**
+ * @name    _log_formatf
+ * @brief   _log_format 的可变参数版本，供附加 sink 生成提示信息（总是文本格式）。
+ */
+static int _log_formatf(char *__buf ,size_t __cap ,const char *__name ,const char *__fmt_str ,...)
+{
+    va_list __args;
+    va_start(__args ,__fmt_str);
+    int __len = _log_format(__buf ,__cap ,__name ,__fmt_str ,__args);
+    va_end(__args);
+    return __len;
+}
+
+/**
+ * @name    _log_sink_wake
+ * @brief   唤醒附加 sink 的刷写线程；__force 为 0 时仅在其休眠时才进入互斥锁。
+ */
+static void _log_sink_wake(struct _log_sink *__s ,int __force)
+{
+    if(!__force && !__atomic_load_n(&__s->__sleeping ,__ATOMIC_SEQ_CST))
+        return;
+    pthread_mutex_lock(&__s->__lock);
+    pthread_cond_signal(&__s->__cond);
+    pthread_mutex_unlock(&__s->__lock);
+}
+
+/**
+ * @name    _log_sink_output
+ * @brief   把一批日志行写到附加 sink。
+ *
+ * 标准错误一次 writev；unix 套接字每行一个数据报，一次 sendmmsg 发送整批。
+ * 收集进程未运行（ENOENT/ECONNREFUSED）或接收队列持续已满（发送超时）时，本批剩余日志计入丢弃。
+ */
+static void _log_sink_output(struct _log_sink *__s ,struct iovec *__iov ,int __cnt)
+{
+    if(__s->__type == LOG_SINK_STDERR)
+    {
+        if(writev(__s->__fd ,__iov ,__cnt) == -1)
+            __atomic_add_fetch(&__s->__dropped ,__cnt ,__ATOMIC_RELAXED);
+        return;
+    }
+
+    struct mmsghdr __msg[LOG_FLUSH_BATCH];
+    memset(__msg ,0 ,sizeof(__msg[0]) * __cnt);
+    for(int __i = 0; __i < __cnt; __i++)
+    {
+        __msg[__i].msg_hdr.msg_name = &__s->__addr;
+        __msg[__i].msg_hdr.msg_namelen = __s->__addrlen;
+        __msg[__i].msg_hdr.msg_iov = &__iov[__i];
+        __msg[__i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int __sent = 0;
+    while(__sent < __cnt)
+    {
+        int __n = sendmmsg(__s->__fd ,__msg + __sent ,__cnt - __sent ,0);
+        if(__n > 0)
+            __sent += __n;
+        else if(__n == -1 && errno == EINTR)
+            continue;
+        else
+        {
+            __atomic_add_fetch(&__s->__dropped ,__cnt - __sent ,__ATOMIC_RELAXED);
+            break;
+        }
+    }
+}
+
+/**
+ * @name    _log_sink_report_drop
+ * @brief   自上次提示后该 sink 有日志被丢弃时，向该 sink 追加一条提示行。
+ */
+static void _log_sink_report_drop(struct _log_sink *__s)
+{
+    unsigned long __n = __atomic_load_n(&__s->__dropped ,__ATOMIC_RELAXED);
+    if(__n == __s->__reported)
+        return;
+
+    char __buf[LOG_LINE_MAX];
+    int __len = _log_formatf(__buf ,sizeof(__buf) ,"[WARN]" ,"log: %lu messages dropped",
+        __n - __s->__reported);
+    __s->__reported = __n;
+    if(__len < 0)
+        return;
+
+    struct iovec __iov = { .iov_base = __buf ,.iov_len = __len };
+    _log_sink_output(__s ,&__iov ,1);
+}
+
+/**
+ * @name    _log_sink_flusher
+ * @brief   附加 sink 的刷写线程：每批最多 __batch 条，一次写出。
+ *
+ * 队列中不足一批时最长休眠 __interval_ms 毫秒再写出；收到退出标志后写完剩余日志才返回。
+ */
+static void* _log_sink_flusher(void *__arg)
+{
+    struct _log_sink *__s = (struct _log_sink *)__arg;
+    struct _log_ring *__r = &__s->__ring;
+    struct iovec __iov[LOG_FLUSH_BATCH];
+    struct _log_slot *__slot[LOG_FLUSH_BATCH];
+    size_t __pos[LOG_FLUSH_BATCH];
+
+    for(;;)
+    {
+        int __batch = (int)__atomic_load_n(&__s->__batch ,__ATOMIC_RELAXED);
+        int __n = 0;
+        while(__n < __batch && (__slot[__n] = _log_ring_take(__r ,&__pos[__n])) != NULL)
+        {
+            __iov[__n].iov_base = __slot[__n]->__data;
+            __iov[__n].iov_len = __slot[__n]->__len;
+            __n++;
+        }
+
+        if(__n > 0)
+        {
+            _log_sink_output(__s ,__iov ,__n);
+            for(int __i = 0; __i < __n; __i++)
+                _log_ring_release(__r ,__slot[__i] ,__pos[__i]);
+            _log_sink_report_drop(__s);
+            continue;
+        }
+
+        _log_sink_report_drop(__s);
+
+        if(__atomic_load_n(&__s->__stop ,__ATOMIC_ACQUIRE))
+        {
+            if(__atomic_load_n(&__r->__head ,__ATOMIC_ACQUIRE) == __atomic_load_n(&__r->__tail ,__ATOMIC_ACQUIRE))
+                break;
+            sched_yield();
+            continue;
+        }
+
+        pthread_mutex_lock(&__s->__lock);
+        __atomic_store_n(&__s->__sleeping ,1 ,__ATOMIC_SEQ_CST);
+        size_t __t = __atomic_load_n(&__r->__tail ,__ATOMIC_RELAXED);
+        size_t __head = __atomic_load_n(&__r->__head ,__ATOMIC_SEQ_CST);
+        if(__head - __t < (size_t)__batch && !__atomic_load_n(&__s->__stop ,__ATOMIC_ACQUIRE))
+            _log_timedwait(&__s->__cond ,&__s->__lock ,__atomic_load_n(&__s->__interval_ms ,__ATOMIC_RELAXED));
+        __atomic_store_n(&__s->__sleeping ,0 ,__ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&__s->__lock);
+    }
+    return NULL;
+}
+
+/**
+ * @name    _log_sink_write
+ * @brief   把一条日志送往等级阈值允许的附加 sink：只格式化一次，再复制进各 sink 的队列。
+ *
+ * 队列已满时丢弃并计数，从不阻塞调用线程；积累到 __batch 条时唤醒对应的刷写线程。
+ *
+ * @return  日志行长度；没有 sink 接收返回 0，格式化失败返回 -1。
+ */
+static int _log_sink_write(int __nsinks ,int __level ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    char __line[LOG_LINE_MAX];
+    int __len = 0;
+
+    for(int __i = 0; __i < __nsinks; __i++)
+    {
+        struct _log_sink *__s = &__log->__sinks[__i];
+        if(__level < __atomic_load_n(&__s->__level ,__ATOMIC_RELAXED))
+            continue;
+        if(__len == 0 && (__len = _log_format(__line ,sizeof(__line) ,__name ,__fmt_str ,__args)) < 0)
+            return -1;
+
+        size_t __pos;
+        struct _log_slot *__slot = _log_ring_claim(&__s->__ring ,&__pos);
+        if(__slot == NULL)
+        {
+            __atomic_add_fetch(&__s->__dropped ,1 ,__ATOMIC_RELAXED);
+            _log_sink_wake(__s ,0);
+            continue;
+        }
+        memcpy(__slot->__data ,__line ,__len);
+        __slot->__len = __len;
+        __atomic_store_n(&__slot->__seq ,__pos + 1 ,__ATOMIC_SEQ_CST);
+        if(__pos + 1 - __atomic_load_n(&__s->__ring.__tail ,__ATOMIC_RELAXED) >= __atomic_load_n(&__s->__batch ,__ATOMIC_RELAXED))
+            _log_sink_wake(__s ,0);
+    }
+    return __len;
+}
+
+/**
+ * @name    _log_sink_batch
+ * @brief   规整批量参数：0 取默认值，不超过 LOG_FLUSH_BATCH。
+ */
+static unsigned _log_sink_batch(unsigned __batch ,unsigned __def)
+{
+    if(__batch == 0)
+        return __def;
+    return (__batch > LOG_FLUSH_BATCH) ? LOG_FLUSH_BATCH : __batch;
+}
+
+/**
+ * @name    _log_sink_add
+ * @brief   附加一个 sink，并启动其刷写线程。
+ *
+ * @param[in]   __type          LOG_SINK_STDERR 或 LOG_SINK_UNIX。
+ * @param[in]   __target        LOG_SINK_UNIX：收集进程绑定的套接字路径，以 '@' 开头表示抽象命名空间；
+ *                              LOG_SINK_STDERR 忽略。
+ * @param[in]   __level         该 sink 的等级阈值（LOG_LEVEL_TRACE ~ LOG_LEVEL_OFF）。
+ * @param[in]   __batch         积累多少条写出一次，0 使用 LOG_SINK_BATCH，最大 LOG_FLUSH_BATCH。
+ * @param[in]   __interval_ms   不足一批时的最长等待时间（毫秒），0 使用 LOG_FLUSH_INTERVAL_MS。
+ *
+ * @return  成功返回 sink 编号（>=1，日志文件固定为 0），失败返回 -1。
+ *
+ * @note
+ * - sink 只增不减，`_log_free()` 时统一写完并关闭；
+ * - sink 等级在全局阈值（`_log_set_level()`）之后再过滤，被全局阈值挡住的日志不会到达任何 sink；
+ * - 附加 sink 总是接收文本日志行，不受 `_log_set_format()` 影响；
+ * - 收集进程无需先于本进程启动，未运行期间的日志计入该 sink 的丢弃数。
+ */
+int _log_sink_add(int __type ,const char *__target ,int __level ,unsigned __batch ,unsigned __interval_ms)
+{
+    static pthread_mutex_t __add_lock = PTHREAD_MUTEX_INITIALIZER;
+
+    if(__log == NULL || __level < LOG_LEVEL_TRACE || __level > LOG_LEVEL_OFF)
+        return -1;
+    if(__type != LOG_SINK_STDERR && __type != LOG_SINK_UNIX)
+        return -1;
+    if(__type == LOG_SINK_UNIX && (__target == NULL || __target[0] == '\0' ||
+       strlen(__target) >= sizeof(((struct sockaddr_un *)0)->sun_path)))
+        return -1;
+
+    pthread_mutex_lock(&__add_lock);
+    int __n = __log->__nsinks;
+    if(__n >= LOG_SINK_MAX)
+    {
+        pthread_mutex_unlock(&__add_lock);
+        return -1;
+    }
+
+    struct _log_sink *__s = &__log->__sinks[__n];
+    memset(__s ,0 ,sizeof(*__s));
+    __s->__type = __type;
+    __s->__level = __level;
+    __s->__batch = _log_sink_batch(__batch ,LOG_SINK_BATCH);
+    __s->__interval_ms = (__interval_ms == 0) ? LOG_FLUSH_INTERVAL_MS : __interval_ms;
+
+    if(__type == LOG_SINK_STDERR)
+        __s->__fd = STDERR_FILENO;
+    else
+    {
+        __s->__fd = socket(AF_UNIX ,SOCK_DGRAM | SOCK_CLOEXEC ,0);
+        if(__s->__fd == -1)
+        {
+            PRINT_ERROR();
+            pthread_mutex_unlock(&__add_lock);
+            return -1;
+        }
+        /* 收集进程接收队列已满时最多阻塞一个刷写间隔，之后丢弃本批 */
+        struct timeval __tv = { .tv_sec = __s->__interval_ms / 1000 ,.tv_usec = (__s->__interval_ms % 1000) * 1000 };
+        setsockopt(__s->__fd ,SOL_SOCKET ,SO_SNDTIMEO ,&__tv ,sizeof(__tv));
+
+        size_t __tl = strlen(__target);
+        __s->__addr.sun_family = AF_UNIX;
+        memcpy(__s->__addr.sun_path ,__target ,__tl);
+        if(__target[0] == '@')
+            __s->__addr.sun_path[0] = '\0';
+        else
+            __tl++;
+        __s->__addrlen = offsetof(struct sockaddr_un ,sun_path) + __tl;
+    }
+
+    struct _log_ring *__r = &__s->__ring;
+    __r->__slots = (struct _log_slot *)malloc(LOG_SINK_SLOTS * sizeof(struct _log_slot));
+    if(__r->__slots == NULL)
+        goto fail;
+    for(size_t __i = 0; __i < LOG_SINK_SLOTS; __i++)
+        __r->__slots[__i].__seq = __i;
+    __r->__mask = LOG_SINK_SLOTS - 1;
+
+    pthread_mutex_init(&__s->__lock ,NULL);
+    pthread_cond_init(&__s->__cond ,NULL);
+    if(pthread_create(&__s->__flusher ,NULL ,_log_sink_flusher ,__s) != 0)
+    {
+        pthread_mutex_destroy(&__s->__lock);
+        pthread_cond_destroy(&__s->__cond);
+        goto fail;
+    }
+
+    __atomic_store_n(&__log->__nsinks ,__n + 1 ,__ATOMIC_RELEASE);
+    pthread_mutex_unlock(&__add_lock);
+    return __n + 1;
+
+fail:
+    free(__r->__slots);
+    __r->__slots = NULL;
+    if(__type == LOG_SINK_UNIX)
+        close(__s->__fd);
+    pthread_mutex_unlock(&__add_lock);
+    return -1;
+}
+
+/**
+ * @name    _log_sink_close_all
+ * @brief   写完全部附加 sink 队列中的日志，停止刷写线程并释放资源。
+ *
+ * @note    调用时不应再有其它线程写日志。
+ */
+static void _log_sink_close_all(void)
+{
+    int __n = __log->__nsinks;
+    __atomic_store_n(&__log->__nsinks ,0 ,__ATOMIC_RELEASE);
+
+    for(int __i = 0; __i < __n; __i++)
+    {
+        struct _log_sink *__s = &__log->__sinks[__i];
+        __atomic_store_n(&__s->__stop ,1 ,__ATOMIC_RELEASE);
+        _log_sink_wake(__s ,1);
+        pthread_join(__s->__flusher ,NULL);
+
+        if(__s->__type == LOG_SINK_UNIX)
+            close(__s->__fd);
+        free(__s->__ring.__slots);
+        __s->__ring.__slots = NULL;
+        pthread_mutex_destroy(&__s->__lock);
+        pthread_cond_destroy(&__s->__cond);
+    }
+}
+
+/**
+ * @name    _log_sink_set_level
+ * @brief   设置指定 sink 的等级阈值。
+ *
+ * @param[in]   __id    sink 编号：0 为日志文件，其它为 `_log_sink_add()` 的返回值。
+ * @param[in]   __level LOG_LEVEL_TRACE ~ LOG_LEVEL_OFF。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ */
+int _log_sink_set_level(int __id ,int __level)
+{
+    if(__log == NULL || __level < LOG_LEVEL_TRACE || __level > LOG_LEVEL_OFF)
+        return -1;
+    if(__id == 0)
+        __atomic_store_n(&__log->__level ,__level ,__ATOMIC_RELAXED);
+    else if(__id > 0 && __id <= __atomic_load_n(&__log->__nsinks ,__ATOMIC_ACQUIRE))
+        __atomic_store_n(&__log->__sinks[__id - 1].__level ,__level ,__ATOMIC_RELAXED);
+    else
+        return -1;
+    return 0;
+}
+
+/**
+ * @name    _log_sink_set_batch
+ * @brief   设置指定 sink 的批量与刷写间隔。
+ *
+ * @param[in]   __id            sink 编号：0 为日志文件（仅异步模式下生效，默认每条唤醒刷写线程），
+ *                              其它为 `_log_sink_add()` 的返回值。
+ * @param[in]   __batch         积累多少条唤醒刷写线程，0 使用默认值（日志文件为 1，附加 sink 为 LOG_SINK_BATCH）。
+ * @param[in]   __interval_ms   刷写线程最长休眠时间（毫秒），0 使用 LOG_FLUSH_INTERVAL_MS。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ */
+int _log_sink_set_batch(int __id ,unsigned __batch ,unsigned __interval_ms)
+{
+    unsigned *__pb ,*__pi;
+
+    if(__log == NULL)
+        return -1;
+    if(__id == 0)
+    {
+        __batch = _log_sink_batch(__batch ,1);
+        __pb = &__log->__batch;
+        __pi = &__log->__interval_ms;
+    }
+    else if(__id > 0 && __id <= __atomic_load_n(&__log->__nsinks ,__ATOMIC_ACQUIRE))
+    {
+        __batch = _log_sink_batch(__batch ,LOG_SINK_BATCH);
+        __pb = &__log->__sinks[__id - 1].__batch;
+        __pi = &__log->__sinks[__id - 1].__interval_ms;
+    }
+    else
+        return -1;
+
+    __atomic_store_n(__pb ,__batch ,__ATOMIC_RELAXED);
+    __atomic_store_n(__pi ,(__interval_ms == 0) ? LOG_FLUSH_INTERVAL_MS : __interval_ms ,__ATOMIC_RELAXED);
+    return 0;
+}
+
+/**********************************************************************************************
+ * 写入接口
+ *********************************************************************************************/
+/**
+ * @name    _log_vwrite
+ * @brief   写入一条日志：依次送往飞行记录器、附加 sink 与日志文件。
+ *
+ * 日志文件同步模式在栈上生成后直接写出，异步模式直接生成到队列槽位中，
+ * 分线程暂存模式追加到本线程的暂存缓冲区。
+ *
+ * @return  成功返回记录长度，失败或被丢弃返回 -1。
+ */
+static int _log_vwrite(int __fid ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    int __len = -1;
+    int __backend = __atomic_load_n(&__log->__backend ,__ATOMIC_ACQUIRE);
+    int __nsinks = __atomic_load_n(&__log->__nsinks ,__ATOMIC_ACQUIRE);
+    int __level = _log_name_level(__name);
+
+    if(__backend & LOG_BACKEND_FLIGHT)
+    {
+        va_list __copy;
+        va_copy(__copy ,__args);
+        __len = _log_flight_write(__name ,__fmt_str ,__copy);
+        va_end(__copy);
+    }
+    if(__nsinks > 0)
+    {
+        va_list __copy;
+        va_copy(__copy ,__args);
+        int __n = _log_sink_write(__nsinks ,__level ,__name ,__fmt_str ,__copy);
+        va_end(__copy);
+        if(__n > 0)
+            __len = __n;
+    }
+    if((__backend & LOG_BACKEND_FILE) == 0 || __level < __atomic_load_n(&__log->__level ,__ATOMIC_RELAXED))
+        return __len;
+
+    int __mode = __atomic_load_n(&__log->__mode ,__ATOMIC_ACQUIRE);
+    struct _log_stage *__st;
+    if(__mode == LOG_MODE_STAGED && (__st = _log_stage_get()) != NULL)
+        return _log_stage_write(__st ,__fid ,__name ,__fmt_str ,__args);
+
+    if(__mode == LOG_MODE_ASYNC)
+    {
+        size_t __pos;
+        struct _log_slot *__s = _log_async_claim(0 ,&__pos);
+        if(__s == NULL)
+            return -1;
+        __len = _log_fill(__s->__data ,sizeof(__s->__data) ,__fid ,__name ,__fmt_str ,__args);
+        _log_async_commit(__s ,__pos ,__len);
+        return __len;
+    }
+
+    char __str[LOG_LINE_MAX];
+    __len = _log_fill(__str ,sizeof(__str) ,__fid ,__name ,__fmt_str ,__args);
+    if(__len < 0)
+        return -1;
+
+    /* 追加写入日志文件，失败返回 -1 */
+    struct iovec __iov = { .iov_base = __str ,.iov_len = __len };
+    if(_log_output(&__iov ,1) == -1)
+        return -1;
+
+    /* 返回写入的字节数 */
+    return __len;
+}
+
+/**
+ * @name    _log_write
+ * @brief   写入日志信息到日志文件。
+ * 
+ * @param[in]   __name      日志来源名称（如模块名、函数名），不能为空。
+ * @param[in]   __fmt_str   要写入的日志格式字符串，类似 printf 格式。
+ * @param[in]   ...         可变参数，用于格式化 __fmt_str。
+ * 
+ * @return      成功返回写入（异步模式为入队）的字节数，失败或被丢弃返回 -1。
+ * 
+ * @details
+ *  该函数会：
+ *  1. 获取当前时间字符串；
+ *  2. 将时间戳、__name 和格式化后的字符串拼接为完整日志；
+ *  3. 同步模式：在调用线程栈上拼接后以一次 writev 追加写入日志文件末尾；
+ *     异步模式：直接拼接到环形队列槽位中，由刷写线程批量写入；
+ *  4. 返回日志行长度。
+ *
+ * @note  二进制格式下本函数没有调用点编号，生成 LOG_REC_TEXT 记录（仍在设备上格式化）。
+ */
+int _log_write(const char *__name, const char *__fmt_str, ...)
+{
+    /* 参数校验：全局日志指针、日志名称、格式字符串不能为空 */
+    if(__log == NULL || __name == NULL || __fmt_str == NULL)
+        return -1;
+
+    va_list args;
+    va_start(args, __fmt_str);
+    int __len = _log_vwrite(0 ,__name ,__fmt_str ,args);
+    va_end(args);
+    return __len;
+}
+
+/**********************************************************************************************
+ * 二进制格式：格式串登记
+ *********************************************************************************************/
+/**
+ * @name    _log_fmt_parse
+ * @brief   解析 printf 格式串，得到每个参数的取值方式。
+ *
+ * @return  参数个数；含 %n、%m、位置参数（%1$d）或参数超过 LOG_BIN_MAX_ARGS 时返回 -1。
+ */
+static int _log_fmt_parse(const char *__fmt ,uint8_t *__kind)
+{
+    int __n = 0;
+
+    for(const char *__p = __fmt; *__p != '\0'; __p++)
+    {
+        if(*__p != '%')
+            continue;
+        __p++;
+        if(*__p == '%')
+            continue;
+
+        /* 标志 */
+        while(*__p != '\0' && strchr("-+ #0'" ,*__p) != NULL)
+            __p++;
+        /* 宽度 */
+        if(*__p == '*')
+        {
+            if(__n >= LOG_BIN_MAX_ARGS)
+                return -1;
+            __kind[__n++] = LOG_KIND_INT | LOG_KIND_SIGNED;
+            __p++;
+        }
+        else
+        {
+            while(*__p >= '0' && *__p <= '9')
+                __p++;
+            if(*__p == '$')
+                return -1;
+        }
+        /* 精度 */
+        if(*__p == '.')
+        {
+            __p++;
+            if(*__p == '*')
+            {
+                if(__n >= LOG_BIN_MAX_ARGS)
+                    return -1;
+                __kind[__n++] = LOG_KIND_INT | LOG_KIND_SIGNED;
+                __p++;
+            }
+            else
+                while(*__p >= '0' && *__p <= '9')
+                    __p++;
+        }
+        /* 长度修饰 */
+        int __size = LOG_KIND_INT;
+        switch(*__p)
+        {
+            case 'h':
+                __size = (__p[1] == 'h') ? (__p++ ,LOG_KIND_CHAR) : LOG_KIND_SHORT;
+                __p++;
+                break;
+            case 'l':
+                __size = (__p[1] == 'l') ? (__p++ ,LOG_KIND_LLONG) : LOG_KIND_LONG;
+                __p++;
+                break;
+            case 'q': case 'L': __size = LOG_KIND_LLONG;   __p++; break;
+            case 'z':           __size = LOG_KIND_SIZE;    __p++; break;
+            case 'j':           __size = LOG_KIND_INTMAX;  __p++; break;
+            case 't':           __size = LOG_KIND_PTRDIFF; __p++; break;
+            default: break;
+        }
+
+        if(__n >= LOG_BIN_MAX_ARGS)
+            return -1;
+        switch(*__p)
+        {
+            case 'd': case 'i':
+                __kind[__n++] = __size | LOG_KIND_SIGNED;
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                __kind[__n++] = __size;
+                break;
+            case 'c':
+                __kind[__n++] = LOG_KIND_INT | LOG_KIND_SIGNED;
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                __kind[__n++] = (__size == LOG_KIND_LLONG) ? LOG_KIND_LDOUBLE : LOG_KIND_DOUBLE;
+                break;
+            case 's':
+                __kind[__n++] = LOG_KIND_STR;
+                break;
+            case 'p':
+                __kind[__n++] = LOG_KIND_PTR;
+                break;
+            default:
+                return -1;
+        }
+    }
+    return __n;
+}
+
+/**
+ * @name    _log_bin_def
+ * @brief   生成 LOG_REC_DEF 记录。
+ *
+ * @return  记录长度；名称与格式串超出单条记录上限时返回 -1。
+ */
+static int _log_bin_def(char *__buf ,size_t __cap ,int __fid)
+{
+    const struct _log_fmt *__f = &__log_fmts[__fid - 1];
+    size_t __nl = strlen(__f->__name) + 1;
+    size_t __fl = strlen(__f->__fmt) + 1;
+    size_t __n = sizeof(struct _log_rec) + __nl + __fl;
+    if(__n > __cap)
+        return -1;
+
+    struct _log_rec __h;
+    _log_bin_hdr(&__h ,LOG_REC_DEF ,__fid ,__f->__nargs ,__n);
+    memcpy(__buf ,&__h ,sizeof(__h));
+    memcpy(__buf + sizeof(__h) ,__f->__name ,__nl);
+    memcpy(__buf + sizeof(__h) + __nl ,__f->__fmt ,__fl);
+    return __n;
+}
+
+/**
+ * @name    _log_bin_register
+ * @brief   登记调用点的格式串并写出 LOG_REC_DEF，结果写回调用点的静态编号。
+ *
+ * 登记失败（格式串不支持、过长或登记表已满）时编号置为 -1，该调用点此后生成 LOG_REC_TEXT 记录。
+ * 定义记录先于编号发布写出，其它线程看到编号时其定义一定已在队列中排在前面。
+ */
+static int _log_bin_register(int *__fid ,const char *__name ,const char *__fmt_str)
+{
+    pthread_mutex_lock(&__log_fmt_lock);
+
+    int __id = __atomic_load_n(__fid ,__ATOMIC_ACQUIRE);
+    if(__id == 0)
+    {
+        __id = -1;
+        if(__log_nfmts < LOG_BIN_MAX_FMTS)
+        {
+            struct _log_fmt *__f = &__log_fmts[__log_nfmts];
+            __f->__name = __name;
+            __f->__fmt = __fmt_str;
+            __f->__nargs = _log_fmt_parse(__fmt_str ,__f->__kind);
+
+            char __buf[LOG_LINE_MAX];
+            int __len = (__f->__nargs < 0) ? -1 : _log_bin_def(__buf ,sizeof(__buf) ,__log_nfmts + 1);
+            if(__len > 0)
+            {
+                __id = __log_nfmts + 1;
+                __atomic_store_n(&__log_nfmts ,__id ,__ATOMIC_RELEASE);
+                _log_emit_raw(__buf ,__len);
+            }
+        }
+        __atomic_store_n(__fid ,__id ,__ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&__log_fmt_lock);
+    return __id;
+}
+
+/**
+ * @name    _log_bin_emit_header
+ * @brief   写出 LOG_REC_HDR 与已登记的全部格式串（切换到二进制格式或开始新日志文件时调用）。
+ */
+static void _log_bin_emit_header(void)
+{
+    char __buf[LOG_LINE_MAX];
+    struct _log_rec __h;
+
+    pthread_mutex_lock(&__log_fmt_lock);
+    _log_bin_hdr(&__h ,LOG_REC_HDR ,LOG_BIN_MAGIC ,LOG_BIN_VERSION ,sizeof(__h));
+    _log_emit_raw(&__h ,sizeof(__h));
+    for(int __i = 1; __i <= __log_nfmts; __i++)
+    {
+        int __len = _log_bin_def(__buf ,sizeof(__buf) ,__i);
+        if(__len > 0)
+            _log_emit_raw(__buf ,__len);
+    }
+    pthread_mutex_unlock(&__log_fmt_lock);
+}
+
+/**
+ * @name    _log_bin_write_header
+ * @brief   直接向描述符写出格式串登记 (__from, __to]，__from 为 0 时先写 LOG_REC_HDR（轮转时调用）。
+ *
+ * 登记表只增不减，调用方以 acquire 读取 __log_nfmts 作为 __to，无需持有 __log_fmt_lock。
+ */
+static void _log_bin_write_header(int __fd ,int __from ,int __to)
+{
+    char __buf[LOG_LINE_MAX];
+    size_t __n = 0;
+
+    if(__from == 0)
+    {
+        struct _log_rec __h;
+        _log_bin_hdr(&__h ,LOG_REC_HDR ,LOG_BIN_MAGIC ,LOG_BIN_VERSION ,sizeof(__h));
+        memcpy(__buf ,&__h ,sizeof(__h));
+        __n = sizeof(__h);
+    }
+    for(int __i = __from + 1; __i <= __to; __i++)
+    {
+        int __len = _log_bin_def(__buf + __n ,sizeof(__buf) - __n ,__i);
+        if(__len < 0 && __n > 0)
+        {
+            /* 缓冲区放不下，先写出已攒的记录再重试 */
+            if(write(__fd ,__buf ,__n) == -1)
+                PRINT_ERROR();
+            __n = 0;
+            __len = _log_bin_def(__buf ,sizeof(__buf) ,__i);
+        }
+        if(__len > 0)
+            __n += __len;
+    }
+    if(__n > 0 && write(__fd ,__buf ,__n) == -1)
+        PRINT_ERROR();
+}
+
+/**
+ * @name    _log_set_format
+ * @brief   设置日志记录格式。
+ *
+ * @param[in]   __format    LOG_FORMAT_TEXT 或 LOG_FORMAT_BINARY。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ *
+ * @note
+ * - 切换到二进制格式时先写出文件头与已登记的格式串；
+ * - 同一日志文件中不应混用两种格式，建议在 `_log_init()` 之后、写入任何日志之前调用。
+ */
+int _log_set_format(int __format)
+{
+    if(__log == NULL || (__format != LOG_FORMAT_TEXT && __format != LOG_FORMAT_BINARY))
+        return -1;
+    if(__log->__format == __format)
+        return 0;
+
+    if(__format == LOG_FORMAT_BINARY)
+        _log_bin_emit_header();
+    __atomic_store_n(&__log->__format ,__format ,__ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @name    _log_site_repeat
+ * @brief   判断本条日志是否与该调用点上一条内容相同，相同则只计数。
+ *
+ * 内容哈希取自格式化后的消息（二进制格式取编码后的参数，不执行 vsnprintf）；
+ * 内容变化时先补一条 "last message repeated N times"，持续重复时每 LOG_REPEAT_INTERVAL 秒补一条。
+ *
+ * @return  与上一条相同（已合并）返回 1，否则返回 0。
+ */
+static int _log_site_repeat(struct _log_site *__site ,int __fid ,const char *__name ,const char *__fmt_str ,va_list __args)
+{
+    char __buf[LOG_LINE_MAX];
+    size_t __off = 0;
+    int __n;
+    va_list __copy;
+
+    va_copy(__copy ,__args);
+    if(__fid > 0)
+    {
+        __n = _log_bin_encode(__buf ,sizeof(__buf) ,__fid ,__copy);
+        __off = sizeof(struct _log_rec);
+    }
+    else
+        __n = vsnprintf(__buf ,sizeof(__buf) ,__fmt_str ,__copy);
+    va_end(__copy);
+    if(__n < 0)
+        return 0;
+    if((size_t)__n >= sizeof(__buf))
+        __n = sizeof(__buf) - 1;
+
+    /* FNV-1a */
+    uint64_t __h = 0xcbf29ce484222325ULL;
+    for(size_t __i = __off; __i < (size_t)__n; __i++)
+        __h = (__h ^ (unsigned char)__buf[__i]) * 0x100000001b3ULL;
+    if(__h == 0)
+        __h = 1;
+
+    struct timespec __ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE ,&__ts);
+    uint64_t __now = __ts.tv_sec;
+
+    unsigned __rep;
+    if(__atomic_exchange_n(&__site->__hash ,__h ,__ATOMIC_RELAXED) == __h)
+    {
+        if(__atomic_add_fetch(&__site->__repeat ,1 ,__ATOMIC_RELAXED) == 1)
+            _log_site_track(__site);
+        uint64_t __last = __atomic_load_n(&__site->__rep_ts ,__ATOMIC_RELAXED);
+        if(__now - __last >= LOG_REPEAT_INTERVAL &&
+           __atomic_compare_exchange_n(&__site->__rep_ts ,&__last ,__now ,0 ,__ATOMIC_RELAXED ,__ATOMIC_RELAXED) &&
+           (__rep = __atomic_exchange_n(&__site->__repeat ,0 ,__ATOMIC_RELAXED)) > 0)
+            _log_write(__name ,"last message repeated %u times" ,__rep);
+        return 1;
+    }
+
+    __atomic_store_n(&__site->__rep_ts ,__now ,__ATOMIC_RELAXED);
+    if((__rep = __atomic_exchange_n(&__site->__repeat ,0 ,__ATOMIC_RELAXED)) > 0)
+        _log_write(__name ,"last message repeated %u times" ,__rep);
+    return 0;
+}
+
+/**
+ * @name    _log_print
+ * @brief   带调用点状态的日志写入，LOG_PRINT 宏的底层实现。
+ *
+ * @param[in,out]   __site      调用点的静态状态，初值为 0（__file/__line 为调用点位置）。
+ * @param[in]       __name      日志名称（等级），须为字符串字面量。
+ * @param[in]       __fmt_str   格式串，须为字符串字面量。
+ *
+ * @return  同 `_log_write()`；与上一条内容相同而被合并时返回 0。
+ *
+ * @details
+ *  文本格式下与 `_log_write()` 相同；二进制格式下首次调用登记格式串，
+ *  之后每次只保存格式串编号、时间戳、线程号与原始参数，不执行 vsnprintf。
+ *  该调用点有被限速丢弃的日志时，先补一条提示（含调用点的文件与行号）；
+ *  启用合并时，与上一条内容相同的日志只计数（见 `_log_site_repeat()`）。
+ */
+int _log_print(struct _log_site *__site ,const char *__name ,const char *__fmt_str ,...)
+{
+    if(__log == NULL || __site == NULL || __name == NULL || __fmt_str == NULL)
+        return -1;
+
+    int __id = 0;
+    if(__atomic_load_n(&__log->__format ,__ATOMIC_ACQUIRE) == LOG_FORMAT_BINARY)
+    {
+        __id = __atomic_load_n(&__site->__fid ,__ATOMIC_ACQUIRE);
+        if(__id == 0)
+            __id = _log_bin_register(&__site->__fid ,__name ,__fmt_str);
+    }
+
+    unsigned __limited;
+    if(__atomic_load_n(&__site->__limited ,__ATOMIC_RELAXED) != 0 &&
+       (__limited = __atomic_exchange_n(&__site->__limited ,0 ,__ATOMIC_RELAXED)) > 0)
+        _log_write("[WARN]" ,"log: %u messages suppressed at %s:%d" ,__limited,
+            (__site->__file != NULL) ? __site->__file : "?" ,__site->__line);
+
+    va_list args;
+    va_start(args ,__fmt_str);
+    int __len = 0;
+    if(!__atomic_load_n(&__log_dedup ,__ATOMIC_RELAXED) ||
+       !_log_site_repeat(__site ,__id ,__name ,__fmt_str ,args))
+        __len = _log_vwrite(__id ,__name ,__fmt_str ,args);
+    va_end(args);
+    return __len;
+}
+
+/**********************************************************************************************
+ * 等级过滤
+ *********************************************************************************************/
+/**
+ * @name    _log_set_level
+ * @brief   设置运行期全局等级阈值，低于阈值的 LOG_PRINT 不求值参数、不格式化。
+ *
+ * @param[in]   __level LOG_LEVEL_TRACE ~ LOG_LEVEL_OFF。
+ *
+ * @return  成功返回 0，参数非法返回 -1。
+ */
+int _log_set_level(int __level)
+{
+    if(__level < LOG_LEVEL_TRACE || __level > LOG_LEVEL_OFF)
+        return -1;
+    __atomic_store_n(&__log_level ,__level ,__ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @name    _log_get_level
+ * @brief   获取运行期全局等级阈值。
+ */
+int _log_get_level(void)
+{
+    return __atomic_load_n(&__log_level ,__ATOMIC_RELAXED);
+}
+
+/**
+ * @name    _log_set_level_for
+ * @brief   为指定进程名或线程名单独设置等级阈值（如只打开某个线程的 TRACE）。
+ *
+ * @param[in]   __name  `__proc_t`/`__thd_t` 的 __name。
+ * @param[in]   __level 等级阈值；-1 表示取消单独设置，恢复使用全局阈值。
+ *
+ * @return  成功返回 0，参数非法或条目已满返回 -1。
+ *
+ * @note    线程名的设置优先于进程名；条目数为 0 时 LOG_PRINT 只比较全局阈值。
+ */
+int _log_set_level_for(const char *__name ,int __level)
+{
+    if(__name == NULL || __level < -1 || __level > LOG_LEVEL_OFF)
+        return -1;
+
+    int __ret = 0;
+    pthread_mutex_lock(&__log_over_lock);
+
+    int __n = __atomic_load_n(&__log_noverride ,__ATOMIC_ACQUIRE);
+    int __i;
+    for(__i = 0; __i < __n; __i++)
+        if(strcmp(__log_over[__i].__name ,__name) == 0)
+            break;
+
+    if(__i < __n)
+        __atomic_store_n(&__log_over[__i].__level ,__level ,__ATOMIC_RELAXED);
+    else if(__level == -1)
+        ;
+    else if(__n >= LOG_OVERRIDE_MAX || (__log_over[__n].__name = strdup(__name)) == NULL)
+        __ret = -1;
+    else
+    {
+        __log_over[__n].__level = __level;
+        __atomic_store_n(&__log_noverride ,__n + 1 ,__ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&__log_over_lock);
+    return __ret;
+}
+
+/**
+ * @name    _log_level_check
+ * @brief   存在按名称设置的等级时的过滤判断（LOG_ENABLED 的慢路径）。
+ *
+ * @return  应输出返回 1，否则返回 0。
+ */
+int _log_level_check(int __level ,const char *__pname ,const char *__tname)
+{
+    int __n = __atomic_load_n(&__log_noverride ,__ATOMIC_ACQUIRE);
+    int __plevel = -1 ,__tlevel = -1;
+
+    for(int __i = 0; __i < __n; __i++)
+    {
+        int __l = __atomic_load_n(&__log_over[__i].__level ,__ATOMIC_RELAXED);
+        if(__l == -1)
+            continue;
+        if(__tname != NULL && strcmp(__log_over[__i].__name ,__tname) == 0)
+            __tlevel = __l;
+        else if(__pname != NULL && strcmp(__log_over[__i].__name ,__pname) == 0)
+            __plevel = __l;
+    }
+
+    if(__tlevel != -1)
+        return __level >= __tlevel;
+    if(__plevel != -1)
+        return __level >= __plevel;
+    return __level >= __atomic_load_n(&__log_level ,__ATOMIC_RELAXED);
+}
+
+/**
+ * @name    _log_level_handler
+ * @brief   SIGUSR1 降低阈值（输出更详细），SIGUSR2 提高阈值（输出更少），只使用原子操作。
+ */
+static void _log_level_handler(int __sig)
+{
+    int __old = __atomic_load_n(&__log_level ,__ATOMIC_RELAXED);
+    int __new = (__sig == SIGUSR1) ? __old - 1 : __old + 1;
+    if(__new >= LOG_LEVEL_TRACE && __new <= LOG_LEVEL_OFF)
+        __atomic_compare_exchange_n(&__log_level ,&__old ,__new ,0 ,__ATOMIC_RELAXED ,__ATOMIC_RELAXED);
+}
+
+/**
+ * @name    _log_level_signal
+ * @brief   注册 SIGUSR1/SIGUSR2，运行中通过 `kill -USR1 <pid>` / `kill -USR2 <pid>` 调整全局阈值。
+ *
+ * @return  成功返回 0，失败返回 -1。
+ */
+int _log_level_signal(void)
+{
+    struct sigaction __act;
+    memset(&__act ,0 ,sizeof(__act));
+    __act.sa_handler = _log_level_handler;
+    __act.sa_flags = SA_RESTART;
+    sigemptyset(&__act.sa_mask);
+
+    if(sigaction(SIGUSR1 ,&__act ,NULL) == -1 || sigaction(SIGUSR2 ,&__act ,NULL) == -1)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************************************************************************
+ * 限速与合并
+ *********************************************************************************************/
+/**
+ * @name    _log_site_track
+ * @brief   把调用点加入待提示链表（每个调用点只加入一次，无锁头插）。
+ */
+void _log_site_track(struct _log_site *__site)
+{
+    if(__atomic_exchange_n(&__site->__tracked ,1 ,__ATOMIC_RELAXED))
+        return;
+    struct _log_site *__head = __atomic_load_n(&__log_sites ,__ATOMIC_RELAXED);
+    do
+        __site->__next = __head;
+    while(!__atomic_compare_exchange_n(&__log_sites ,&__head ,__site ,1 ,__ATOMIC_RELEASE ,__ATOMIC_RELAXED));
+}
+
+/**
+ * @name    _log_site_report
+ * @brief   为所有尚有未提示计数的调用点补写提示（被限速丢弃的条数、被合并的重复条数）。
+ *
+ * 调用点在限速或重复期间之后不再输出时，计数不会被下一条日志带出，
+ * 由 `_log_flush()` 与 `_log_free()` 调用本函数补齐。
+ */
+void _log_site_report(void)
+{
+    if(__log == NULL)
+        return;
+
+    for(struct _log_site *__s = __atomic_load_n(&__log_sites ,__ATOMIC_ACQUIRE); __s != NULL; __s = __s->__next)
+    {
+        unsigned __n = __atomic_exchange_n(&__s->__limited ,0 ,__ATOMIC_RELAXED);
+        if(__n > 0)
+            _log_write("[WARN]" ,"log: %u messages suppressed at %s:%d" ,__n,
+                (__s->__file != NULL) ? __s->__file : "?" ,__s->__line);
+        __n = __atomic_exchange_n(&__s->__repeat ,0 ,__ATOMIC_RELAXED);
+        if(__n > 0)
+        {
+            /* 之后的相同内容重新计为首条 */
+            __atomic_store_n(&__s->__hash ,0 ,__ATOMIC_RELAXED);
+            _log_write("[INFO]" ,"last message repeated %u times (%s:%d)" ,__n,
+                (__s->__file != NULL) ? __s->__file : "?" ,__s->__line);
+        }
+    }
+}
+
+/**
+ * @name    _log_set_ratelimit
+ * @brief   设置 LOG_PRINT 调用点限速（每个调用点独立的令牌桶）。
+ *
+ * @param[in]   __rate  每个调用点每秒允许的条数，0 表示不限速。
+ * @param[in]   __burst 允许的突发条数（桶容量），0 按 1 处理。
+ *
+ * @return  成功返回 0，参数非法返回 -1。
+ *
+ * @note
+ * - 被限速的调用只付出一次粗粒度时钟读取与一次原子加，不求值参数、不格式化；
+ * - 丢弃的条数在该调用点下一条被允许的日志之前以 "[WARN] log: N messages suppressed at 文件:行" 提示，
+ *   之后不再输出的调用点由 `_log_flush()`/`_log_free()` 补写提示；
+ * - 粗粒度时钟分辨率为一个调度节拍（1~10 毫秒），突发条数应不小于 __rate 乘以节拍长度；
+ * - 不经 LOG_PRINT 的 `_log_write()` 不受限速。
+ */
+int _log_set_ratelimit(unsigned __rate ,unsigned __burst)
+{
+    if(__rate > 1000000000u)
+        return -1;
+    if(__rate == 0)
+    {
+        __atomic_store_n(&__log_rate_iv ,0 ,__ATOMIC_RELAXED);
+        return 0;
+    }
+
+    uint64_t __iv = 1000000000ULL / __rate;
+    __atomic_store_n(&__log_rate_limit ,__iv * ((__burst == 0) ? 1 : __burst) ,__ATOMIC_RELAXED);
+    __atomic_store_n(&__log_rate_iv ,__iv ,__ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @name    _log_set_dedup
+ * @brief   启用或关闭重复内容合并。
+ *
+ * @param[in]   __on    非 0 启用：同一调用点连续输出相同内容时只计数，
+ *                      内容变化时或每 LOG_REPEAT_INTERVAL 秒输出一条 "last message repeated N times"。
+ *
+ * @return  成功返回 0。
+ *
+ * @note    判断重复需要先生成一次消息内容（文本格式多一次 vsnprintf，二进制格式多一次参数编码）；
+ *          调用点之后不再输出时，尚未提示的重复条数由 `_log_flush()`/`_log_free()` 补写。
+ */
+int _log_set_dedup(int __on)
+{
+    __atomic_store_n(&__log_dedup ,__on ? 1 : 0 ,__ATOMIC_RELAXED);
+    return 0;
+}
+
+/**********************************************************************************************
+ * sink 配置
+ *********************************************************************************************/
+/**
+ * @struct _log_sink_conf
+ * @brief  LOG_SINKS 中的一项
+ */
+struct _log_sink_conf
+{
+    int __type;             ///< sink 类型（log_sink_type_t）
+    const char *__target;   ///< 文件路径或套接字路径，可为 NULL
+    int __level;            ///< 等级阈值
+    unsigned __batch;       ///< 批量，0 为默认
+    unsigned __interval;    ///< 刷写间隔（毫秒），0 为默认
+};
+
+/**
+ * @name    _log_level_parse
+ * @brief   解析等级名称（不区分大小写）。
+ *
+ * @return  log_level_t，无法识别返回 -1。
+ */
+static int _log_level_parse(const char *__str)
+{
+    static const char *__names[] = { "TRACE" ,"DEBUG" ,"INFO" ,"WARN" ,"ERROR" ,"FATAL" ,"OFF" };
+    for(int __i = 0; __i < (int)(sizeof(__names) / sizeof(__names[0])); __i++)
+        if(strcasecmp(__str ,__names[__i]) == 0)
+            return __i;
+    return -1;
+}
+
+/**
+ * @name    _log_sink_parse
+ * @brief   解析一项 "类型[=目标][:level=等级][:batch=条数][:interval=毫秒]"（就地切分）。
+ *
+ * @return  成功返回 0，格式错误返回 -1。
+ */
+static int _log_sink_parse(char *__item ,struct _log_sink_conf *__c)
+{
+    char *__save = NULL;
+    char *__tok = strtok_r(__item ,":" ,&__save);
+    if(__tok == NULL)
+        return -1;
+
+    memset(__c ,0 ,sizeof(*__c));
+    __c->__level = LOG_LEVEL_TRACE;
+
+    char *__eq = strchr(__tok ,'=');
+    if(__eq != NULL)
+    {
+        *__eq = '\0';
+        __c->__target = (__eq[1] != '\0') ? __eq + 1 : NULL;
+    }
+    if(strcmp(__tok ,"file") == 0)
+        __c->__type = LOG_SINK_FILE;
+    else if(strcmp(__tok ,"stderr") == 0)
+        __c->__type = LOG_SINK_STDERR;
+    else if(strcmp(__tok ,"unix") == 0 && __c->__target != NULL)
+        __c->__type = LOG_SINK_UNIX;
+    else
+        return -1;
+
+    while((__tok = strtok_r(NULL ,":" ,&__save)) != NULL)
+    {
+        char *__end = NULL;
+        if(strncmp(__tok ,"level=" ,6) == 0)
+        {
+            if((__c->__level = _log_level_parse(__tok + 6)) == -1)
+                return -1;
+        }
+        else if(strncmp(__tok ,"batch=" ,6) == 0)
+            __c->__batch = (unsigned)strtoul(__tok + 6 ,&__end ,10);
+        else if(strncmp(__tok ,"interval=" ,9) == 0)
+            __c->__interval = (unsigned)strtoul(__tok + 9 ,&__end ,10);
+        else
+            return -1;
+        if(__end != NULL && *__end != '\0')
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @name    _log_config
+ * @brief   按配置串初始化日志模块：打开日志文件并附加 sink。
+ *
+ * @param[in]   __spec  以 ',' 分隔的若干项，每项为
+ *                      "类型[=目标][:level=等级][:batch=条数][:interval=毫秒]"：
+ *                      - file[=路径]  ：日志文件，省略路径时为 LOGFILE；
+ *                      - stderr       ：标准错误；
+ *                      - unix=路径    ：unix 数据报套接字，'@' 开头为抽象命名空间；
+ *                      等级为 TRACE/DEBUG/INFO/WARN/ERROR/FATAL/OFF，省略时不额外过滤。
+ *
+ * @return  成功返回 0，格式错误或初始化失败返回 -1（不保留任何已初始化的资源）。
+ *
+ * @note
+ * - `_log_init()` 在设置了环境变量 LOG_SINKS 时调用本函数，例如
+ *   LOG_SINKS="file=/tmp/run.log:level=INFO,stderr:level=WARN:batch=1,unix=@logd";
+ * - 配置中没有 file 项时仍打开 LOGFILE（轮转等功能依赖它），但关闭日志文件后端；
+ * - 日志文件的 batch/interval 只在异步模式下生效。
+ */
+int _log_config(const char *__spec)
+{
+    if(__log != NULL || __spec == NULL)
+        return -1;
+
+    char *__buf = strdup(__spec);
+    if(__buf == NULL)
+        return -1;
+
+    /* 先完整解析，格式错误时不产生任何副作用 */
+    struct _log_sink_conf __conf[LOG_SINK_MAX + 1];
+    int __n = 0 ,__file = -1 ,__ret = 0;
+    char *__save = NULL;
+    for(char *__item = strtok_r(__buf ,"," ,&__save); __item != NULL; __item = strtok_r(NULL ,"," ,&__save))
+    {
+        if(__n >= LOG_SINK_MAX + 1 || _log_sink_parse(__item ,&__conf[__n]) == -1 ||
+           (__conf[__n].__type == LOG_SINK_FILE && __file != -1))
+        {
+            fprintf(stderr ,"%s: invalid sink \"%s\"\n" ,LOG_SINKS_ENV ,__item);
+            free(__buf);
+            return -1;
+        }
+        if(__conf[__n].__type == LOG_SINK_FILE)
+            __file = __n;
+        __n++;
+    }
+
+    const char *__path = (__file != -1 && __conf[__file].__target != NULL) ? __conf[__file].__target : LOGFILE;
+    if(_log_open(__path) == -1)
+    {
+        free(__buf);
+        return -1;
+    }
+
+    for(int __i = 0; __i < __n && __ret == 0; __i++)
+    {
+        const struct _log_sink_conf *__c = &__conf[__i];
+        int __id = 0;
+        if(__c->__type == LOG_SINK_FILE)
+            __ret = _log_sink_set_level(0 ,__c->__level);
+        else if((__id = _log_sink_add(__c->__type ,__c->__target ,__c->__level ,__c->__batch ,__c->__interval)) == -1)
+            __ret = -1;
+        if(__ret == 0 && (__c->__batch != 0 || __c->__interval != 0))
+            __ret = _log_sink_set_batch(__id ,__c->__batch ,__c->__interval);
+    }
+    if(__ret == 0 && __file == -1)
+        __ret = _log_set_backend(0);
+
+    free(__buf);
+    if(__ret == -1)
+        _log_free();
+    return __ret;
+}
@@ -8,10 +8,44 @@
  * 日志功能依赖于 `file.h` 提供的文件操作接口，通过封装 `_file_t` 类型对日志文件进行读写。
  * 日志格式由调用 `_log_write()` 函数动态生成，支持时间戳与模块名拼接，便于调试和回溯。
  *
+ * 支持三种写入模式：
+ *  - 同步模式（默认）：调用线程在栈上拼接日志行并直接写入文件；
+ *  - 异步模式（_log_async_start）：调用线程只把日志行格式化到无锁环形队列的槽位中，
+ *    由后台刷写线程批量取出并以 writev 一次写入，调用线程不再阻塞在磁盘 I/O 上；
+ *  - 分线程暂存模式（_log_stage_start）：每个线程经 __thd_tls_t 绑定自己的暂存缓冲区，
+ *    日志行先追加到本线程缓冲区，满或超时后一次写入文件，线程之间不共享任何写入状态；
+ *    线程经 __thread_exit 退出时由 TLS 析构函数写出剩余内容。
+ *
+ * 后端（_log_set_backend）：日志文件，以及可选的共享内存飞行记录器（_log_flight_open），
+ * 后者只做内存写入，适合在设备上常开详细跟踪，崩溃后仍可从 /dev/shm 读出最近的日志。
+ *
+ * 输出（sink）：除日志文件外，还可附加标准错误与 unix 数据报套接字（本地日志收集进程），
+ * 每个 sink 有独立的等级阈值、独立的队列与刷写线程，按各自的批量与间隔刷写，
+ * 控制台或收集进程变慢时只丢弃该 sink 的日志，不拖慢日志文件与写日志的线程。
+ * 可在运行时通过 `_log_sink_add()` 添加，或在启动时由环境变量 LOG_SINKS 配置（见 `_log_config()`）。
+ *
+ * 支持两种记录格式：
+ *  - 文本格式（默认）：每行 "时间戳 [LEVEL] 内容"；
+ *  - 二进制格式（_log_set_format）：LOG_PRINT 调用点的格式串只登记一次，之后每条记录只保存
+ *    格式串编号、原始时间戳、线程号与原始参数，不在设备上执行 vsnprintf；
+ *    日志文件由主机端工具 log_decode 还原为文本格式。
+ *
+ * 限速与合并（_log_set_ratelimit/_log_set_dedup）：每个 LOG_PRINT 调用点有独立的令牌桶，
+ * 超出速率的调用在格式化之前被丢弃，恢复输出时补一条被丢弃条数的提示；
+ * 启用合并后（默认关闭，每条日志多一次格式化），同一调用点连续输出相同内容时合并为一条
+ * "last message repeated N times"。
+ *
  * @note
- * - 日志文件路径固定为 `./run.log`，由宏 `LOGFILE` 定义；
+ * - 日志文件路径默认为 `./run.log`，由宏 `LOGFILE` 定义，也可通过 `_log_open()` 或
+ *   环境变量 LOG_SINKS（如 "file=/tmp/run.log:level=INFO,stderr:level=WARN"）指定；
+ * - 写入依赖 O_APPEND 的原子追加，热路径上每行只有一次 write/writev 系统调用；
+ *   日志文件被删除或被外部轮转（mv）后，最多 LOG_CHECK_INTERVAL 行内自动重新打开；
+ * - 初始化时不截断已有日志，新内容追加在后面；通过 `_log_set_rotate()` 按大小或时间
+ *   轮转为 run.log.1 ~ run.log.N，每个新分段用 fallocate 预分配，超出保留数的旧分段被删除；
+ *   异步模式下轮转只在刷写线程中进行，不阻塞写日志的线程；
  * - 调用 `_log_init()` 进行初始化后，方可写入日志；
- * - 写入完成后应调用 `_log_free()` 释放资源，避免内存泄漏。
+ * - 写入完成后应调用 `_log_free()` 释放资源，避免内存泄漏；异步模式下 `_log_free()`
+ *   会先等待队列中剩余日志全部落盘再停止刷写线程。
  *
  * @author  baotou
  * @date    2025-06-9
@@ -20,26 +54,420 @@
 #define __LOG_H
 
 #include "file.h"
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #define LOGFILE        ("/home/baotou/linux/atk_mp135/applications/run.log")  ///< 日志文件默认路径
 
+#define LOG_LINE_MAX            (256)   ///< 单条日志最大长度（含时间戳、名称与换行）
+#define LOG_RING_SLOTS          (1024)  ///< 异步模式默认槽位数（须为 2 的幂）
+#define LOG_FLUSH_BATCH         (64)    ///< 刷写线程单次 writev 最多合并的日志条数
+#define LOG_FLUSH_INTERVAL_MS   (100)   ///< 刷写线程空闲时的最长休眠时间（毫秒）
+#define LOG_ROTATE_SIZE         (4 * 1024 * 1024)   ///< log_init 默认单个分段大小上限
+#define LOG_ROTATE_KEEP         (4)     ///< log_init 默认保留的历史分段数（run.log.1 ~ run.log.N）
+#define LOG_TIME_FRAC           (6)     ///< 时间戳小数位数：0 秒、3 毫秒、6 微秒
+#define LOG_CHECK_INTERVAL      (1024)  ///< 每写入多少行检查一次日志文件是否被删除或轮转
+#define LOG_SINK_MAX            (4)     ///< 日志文件之外最多可附加的 sink 数
+#define LOG_SINK_SLOTS          (256)   ///< 每个附加 sink 的队列槽位数（须为 2 的幂）
+#define LOG_SINK_BATCH          (16)    ///< 附加 sink 默认批量：队列中积累多少条唤醒其刷写线程
+#define LOG_SINKS_ENV           ("LOG_SINKS")   ///< _log_init 读取的 sink 配置环境变量
+#define LOG_RATE_PER_SEC        (100)   ///< log_init 默认每个调用点每秒允许的日志条数
+#define LOG_RATE_BURST          (200)   ///< log_init 默认每个调用点允许的突发条数
+#define LOG_REPEAT_INTERVAL     (10)    ///< 相同内容持续重复时，至少每隔多少秒提示一次重复条数
+#define LOG_STAGE_SIZE          (4096)  ///< 分线程暂存模式默认每线程缓冲区大小
+#define LOG_STAGE_INTERVAL_MS   (200)   ///< 分线程暂存模式默认最长暂存时间（毫秒）
+
+/**
+ * @enum   log_mode_t
+ * @brief  日志写入模式
+ */
+typedef enum
+{
+    LOG_MODE_SYNC   = 0,    ///< 同步写入：调用线程直接写文件
+    LOG_MODE_ASYNC  = 1,    ///< 异步写入：经环形队列由刷写线程批量写文件
+    LOG_MODE_STAGED = 2     ///< 分线程暂存：先写入本线程缓冲区，满或超时后由本线程写文件
+}log_mode_t;
+
+/**
+ * @enum   log_level_t
+ * @brief  日志等级，LOG_PRINT 的 level 字符串按首字母映射（T/D/I/W/E/F，其它按 INFO）
+ */
+typedef enum
+{
+    LOG_LEVEL_TRACE = 0,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_FATAL,
+    LOG_LEVEL_OFF       ///< 作为阈值时关闭全部日志
+}log_level_t;
+
+#ifndef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN           LOG_LEVEL_TRACE     ///< 编译期下限，低于此等级的 LOG_PRINT 在编译时被删除（可用 -DLOG_LEVEL_MIN=2 指定）
+#endif
+#define LOG_LEVEL_DEFAULT       LOG_LEVEL_INFO      ///< 运行期默认阈值
+#define LOG_OVERRIDE_MAX        (32)                ///< 按名称单独设置等级的最大条目数
+
+/**
+ * @brief  将 LOG_PRINT 的 level 字符串字面量映射为 log_level_t（编译期常量折叠）
+ */
+#define LOG_LEVEL_OF(level)\
+                        (((level)[0] == 'T') ? LOG_LEVEL_TRACE :\
+                         ((level)[0] == 'D') ? LOG_LEVEL_DEBUG :\
+                         ((level)[0] == 'W') ? LOG_LEVEL_WARN  :\
+                         ((level)[0] == 'E') ? LOG_LEVEL_ERROR :\
+                         ((level)[0] == 'F') ? LOG_LEVEL_FATAL : LOG_LEVEL_INFO)
+
+/**
+ * @enum   log_backend_t
+ * @brief  日志后端（位掩码，可同时启用）
+ */
+typedef enum
+{
+    LOG_BACKEND_FILE   = (1 << 0),  ///< 日志文件（同步/异步、文本/二进制）
+    LOG_BACKEND_FLIGHT = (1 << 1)   ///< 共享内存飞行记录器（_log_flight_open）
+}log_backend_t;
+
+/**
+ * @enum   log_sink_type_t
+ * @brief  sink 类型
+ */
+typedef enum
+{
+    LOG_SINK_FILE   = 0,    ///< 日志文件（由 _log_open 打开，sink 编号固定为 0）
+    LOG_SINK_STDERR = 1,    ///< 标准错误，每批一次 writev
+    LOG_SINK_UNIX   = 2     ///< unix 数据报套接字，每行一个数据报，每批一次 sendmmsg
+}log_sink_type_t;
+
+/**
+ * @enum   log_format_t
+ * @brief  日志记录格式
+ */
+typedef enum
+{
+    LOG_FORMAT_TEXT   = 0,  ///< 文本行
+    LOG_FORMAT_BINARY = 1   ///< 二进制记录（延迟格式化，由 log_decode 还原）
+}log_format_t;
+
+/**
+ * @enum   log_policy_t
+ * @brief  异步模式下队列已满时的背压策略
+ */
+typedef enum
+{
+    LOG_POLICY_DROP      = 0,   ///< 丢弃新日志并计数，调用线程从不阻塞
+    LOG_POLICY_BLOCK     = 1,   ///< 等待刷写线程腾出槽位，不丢日志
+    LOG_POLICY_OVERWRITE = 2    ///< 丢弃队列中最旧的一条未刷写日志，为新日志让位
+}log_policy_t;
+
+/**********************************************************************************************
+ * 二进制日志格式
+ *
+ * 文件由连续的记录组成，每条记录以 struct _log_rec 开头，__len 为含头部的记录总长度；
+ * 多字节字段均为设备本机字节序，由 LOG_REC_HDR 记录中的魔数判断。
+ *  - LOG_REC_HDR ：文件/分段开头，__fid 为 LOG_BIN_MAGIC，__nargs 为格式版本；
+ *  - LOG_REC_DEF ：格式串登记，负载为 "名称\0格式串\0"；
+ *  - LOG_REC_MSG ：一条日志，负载为 __nargs 个参数，每个参数为 1 字节类型标签 + 数据：
+ *                  LOG_ARG_I64/U64/PTR 为 LEB128 变长整数（I64 先做 zigzag 编码），LOG_ARG_F64 为 8 字节，
+ *                  LOG_ARG_STR 为 2 字节长度 + 字符串（无 '\0'）；
+ *  - LOG_REC_TEXT：无法登记的格式串（如含 %n、位置参数或参数过多），负载为 "名称\0已格式化内容"。
+ *********************************************************************************************/
+#define LOG_BIN_MAGIC       (0x474F4C42u)   ///< "BLOG"
+#define LOG_BIN_VERSION     (1)             ///< 二进制格式版本
+#define LOG_BIN_MAX_FMTS    (4096)          ///< 最多可登记的格式串个数
+#define LOG_BIN_MAX_ARGS    (16)            ///< 单个格式串最多参数个数（含 '*' 宽度/精度）
+
+/**
+ * @enum   log_rec_type_t
+ * @brief  二进制记录类型
+ */
+typedef enum
+{
+    LOG_REC_HDR  = 1,
+    LOG_REC_DEF  = 2,
+    LOG_REC_MSG  = 3,
+    LOG_REC_TEXT = 4
+}log_rec_type_t;
+
+/**
+ * @enum   log_arg_tag_t
+ * @brief  LOG_REC_MSG 参数类型标签
+ */
+typedef enum
+{
+    LOG_ARG_I64 = 1,    ///< 有符号整数（含 char/short/long/size_t 等，统一扩展为 64 位）
+    LOG_ARG_U64 = 2,    ///< 无符号整数
+    LOG_ARG_F64 = 3,    ///< 浮点数（long double 按 double 保存）
+    LOG_ARG_STR = 4,    ///< 字符串
+    LOG_ARG_PTR = 5     ///< 指针
+}log_arg_tag_t;
+
+/**
+ * @struct _log_rec
+ * @brief  二进制记录头
+ */
+struct _log_rec
+{
+    uint16_t __len;     ///< 记录总长度（含本头部）
+    uint8_t __type;     ///< 记录类型（log_rec_type_t）
+    uint8_t __nargs;    ///< MSG：参数个数；HDR：格式版本
+    uint32_t __fid;     ///< 格式串编号；HDR：LOG_BIN_MAGIC
+    uint64_t __ts;      ///< CLOCK_REALTIME 纳秒时间戳
+    uint32_t __tid;     ///< 内核线程号
+}__attribute__((packed));
+
+/**********************************************************************************************
+ * 飞行记录器
+ *
+ * 固定大小的共享内存环形缓冲区（/dev/shm 下的文件或 memfd），进程运行中或崩溃后都可由
+ * `log_decode -f` 读出最近的日志。写入方用一次原子 fetch_add 领取序号，无系统调用、无锁：
+ *  1. 槽位 __seq 置 0（写入中）；
+ *  2. 写入文本日志行与长度；
+ *  3. __seq 以 release 语义置为 序号 + 1（已提交）。
+ * 读取方按序号遍历最近 __nslots 条，只接受读取前后 __seq 均为 序号 + 1 的槽位。
+ *********************************************************************************************/
+#define LOG_FLIGHT_MAGIC    (0x43524C46u)   ///< "FLRC"
+#define LOG_FLIGHT_VERSION  (1)
+#define LOG_FLIGHT_SLOTS    (4096)          ///< 默认槽位数（须为 2 的幂）
+
+/**
+ * @struct _log_flight_hdr
+ * @brief  飞行记录器文件头（占一条缓存行）
+ */
+struct _log_flight_hdr
+{
+    uint32_t __magic;       ///< LOG_FLIGHT_MAGIC
+    uint32_t __version;     ///< LOG_FLIGHT_VERSION
+    uint32_t __slot_size;   ///< 每个槽位字节数
+    uint32_t __nslots;      ///< 槽位数
+    uint64_t __head;        ///< 下一个待领取的序号
+    int32_t __pid;          ///< 写入进程号
+    uint32_t __reserved[9];
+};
+
+/**
+ * @struct _log_flight_slot
+ * @brief  飞行记录器槽位
+ */
+struct _log_flight_slot
+{
+    uint64_t __seq;             ///< 0：空或写入中；序号 + 1：已提交
+    uint32_t __len;             ///< 日志行长度
+    uint32_t __reserved;
+    char __data[LOG_LINE_MAX];  ///< 文本日志行
+};
+
+/**
+ * @struct _log_slot
+ * @brief  环形队列槽位（内部使用）
+ *
+ * __seq 为槽位序号：等于入队位置 pos 时表示空闲可写，等于 pos + 1 时表示已写好待刷写，
+ * 刷写完成后置为 pos + 槽位数，供下一轮复用。
+ */
+struct _log_slot
+{
+    size_t __seq;                   ///< 槽位序号
+    size_t __len;                   ///< 日志行长度，0 表示该条格式化失败、刷写时跳过
+    char __data[LOG_LINE_MAX];      ///< 日志行内容
+};
+
+/**
+ * @struct _log_ring
+ * @brief  有界多生产者环形队列（内部使用）
+ *
+ * 入队位置与出队位置分别独占一条缓存行，避免生产者与刷写线程之间的伪共享。
+ */
+struct _log_ring
+{
+    struct _log_slot *__slots;      ///< 槽位数组
+    size_t __mask;                  ///< 槽位数 - 1
+    size_t __head __attribute__((aligned(64)));    ///< 下一个入队位置（生产者 CAS 推进）
+    size_t __tail __attribute__((aligned(64)));    ///< 下一个出队位置（刷写线程或覆盖策略 CAS 推进）
+    size_t __done __attribute__((aligned(64)));    ///< 已处理（写出或被覆盖）的条数
+};
+
+/**
+ * @struct _log_sink
+ * @brief  附加 sink（内部使用）
+ *
+ * 生产者只把已格式化的文本行复制进该 sink 自己的队列，队列满时丢弃并计数，从不阻塞；
+ * 刷写线程在积累 __batch 条或休眠 __interval_ms 毫秒后一次写出。
+ */
+struct _log_sink
+{
+    int __type;                 ///< sink 类型（log_sink_type_t）
+    int __level;                ///< 等级阈值
+    unsigned __batch;           ///< 积累多少条唤醒刷写线程，也是单次写出的最大条数
+    unsigned __interval_ms;     ///< 刷写线程空闲时的最长休眠时间（毫秒）
+    int __fd;                   ///< 输出描述符
+    struct sockaddr_un __addr;  ///< LOG_SINK_UNIX：收集进程的套接字地址
+    socklen_t __addrlen;
+    struct _log_ring __ring;    ///< 待写出的日志行
+    pthread_t __flusher;        ///< 刷写线程
+    int __stop;                 ///< 刷写线程退出标志
+    int __sleeping;             ///< 刷写线程是否处于休眠等待
+    pthread_mutex_t __lock;     ///< 配合 __cond 唤醒刷写线程
+    pthread_cond_t __cond;
+    unsigned long __dropped;    ///< 累计丢弃的日志条数（队列满或写出失败）
+    unsigned long __reported;   ///< 已提示过的丢弃条数
+};
+
+/**
+ * @struct _log_stage
+ * @brief  分线程暂存缓冲区（内部使用）
+ *
+ * 由线程首次写日志时分配并通过 __thd_tls_t 绑定到该线程，同时登记到全局链表，
+ * 供 `_log_flush()` 与后台扫描线程写出长时间不再写日志的线程的内容。
+ * __lock 只在本线程写入与跨线程写出之间互斥，正常情况下无竞争。
+ */
+struct _log_stage
+{
+    pthread_mutex_t __lock;             ///< 保护 __len/__first/__buf
+    size_t __cap;                       ///< 缓冲区大小
+    size_t __len;                       ///< 已暂存字节数
+    uint64_t __first;                   ///< 最早一条暂存日志的时间（CLOCK_MONOTONIC_COARSE 毫秒）
+    struct _log_stage *__prev;          ///< 全局暂存缓冲区链表
+    struct _log_stage *__next;
+    char __buf[];                       ///< 暂存的日志行（文本或二进制记录）
+};
+
+/**
+ * @struct _log_site
+ * @brief  LOG_PRINT 调用点状态（每个调用点一个静态实例，内部使用）
+ *
+ * 限速采用 GCRA 形式的令牌桶：__tat 为下一个令牌的理论到达时间，一次 CAS 即可完成
+ * 取令牌，不需要定时补充，也不需要全局的调用点表。
+ */
+struct _log_site
+{
+    int __fid;                  ///< 格式串编号（二进制格式）
+    unsigned __limited;         ///< 被限速丢弃、尚未提示的条数
+    uint64_t __tat;             ///< 令牌桶理论到达时间（CLOCK_MONOTONIC_COARSE 纳秒）
+    uint64_t __hash;            ///< 上一条日志内容的哈希（合并重复内容）
+    unsigned __repeat;          ///< 与上一条相同而被合并、尚未提示的条数
+    uint64_t __rep_ts;          ///< 上次提示重复条数的时间（CLOCK_MONOTONIC_COARSE 秒）
+    const char *__file;         ///< 调用点所在文件
+    int __line;                 ///< 调用点所在行
+    int __tracked;              ///< 已加入待提示调用点链表
+    struct _log_site *__next;   ///< 待提示调用点链表
+};
+
 /**
  * @struct _log_struct
  * @brief  日志模块内部结构体
  */
 struct _log_struct
 {
-    _file_t *__pf;       ///< 日志文件对象指针
-    time_t __timer;      ///< 上次记录的时间戳（秒级）
-    char *__str;         ///< 日志输出临时缓冲区（拼接使用）
+    _file_t *__pf;              ///< 日志文件对象指针
+    time_t __timer;             ///< 上次记录的时间戳（秒级）
+    int __mode;                 ///< 写入模式（log_mode_t）
+    int __format;               ///< 记录格式（log_format_t）
+    int __backend;              ///< 启用的后端（log_backend_t 位掩码）
+    struct _log_flight_hdr *__flight;   ///< 飞行记录器映射地址
+    size_t __flight_len;        ///< 飞行记录器映射长度
+    int __level;                ///< 日志文件的等级阈值（sink 0）
+    unsigned __batch;           ///< 异步模式下积累多少条唤醒刷写线程
+    unsigned __interval_ms;     ///< 异步模式下刷写线程的最长休眠时间（毫秒）
+    int __policy;               ///< 背压策略（log_policy_t）
+    struct _log_ring __ring;    ///< 异步模式环形队列
+    pthread_t __flusher;        ///< 刷写线程（分线程暂存模式下为扫描线程）
+    int __stop;                 ///< 刷写线程退出标志
+    int __sleeping;             ///< 刷写线程是否处于休眠等待
+    pthread_mutex_t __lock;     ///< 配合 __cond 唤醒刷写线程
+    pthread_cond_t __cond;
+    size_t __stage_size;        ///< 分线程暂存模式每线程缓冲区大小
+    unsigned __stage_interval;  ///< 分线程暂存模式最长暂存时间（毫秒）
+    unsigned long __dropped;    ///< 累计丢弃的日志条数
+    unsigned long __reported;   ///< 已写入日志文件提示过的丢弃条数
+    unsigned long __lines;      ///< 累计写出的日志行数，用于按间隔检查文件
+    int __checking;             ///< 正在检查/重新打开日志文件
+    off_t __rot_size;           ///< 分段大小上限（字节），0 表示不按大小轮转
+    unsigned __rot_interval;    ///< 分段时长上限（秒），0 表示不按时间轮转
+    unsigned __rot_keep;        ///< 保留的历史分段数
+    off_t __seg_bytes;          ///< 当前分段已写入字节数
+    time_t __seg_start;         ///< 当前分段开始时间
+    int __rotating;             ///< 正在轮转
+    struct _log_sink __sinks[LOG_SINK_MAX];    ///< 附加 sink，只增不减
+    int __nsinks;               ///< 已启用的附加 sink 数
 };
 typedef struct _log_struct __log_t;
 
 extern __log_t *__log;
+extern int __log_level;
+extern int __log_noverride;
+extern uint64_t __log_rate_iv;
+extern uint64_t __log_rate_limit;
+extern int __log_dedup;
 
 int _log_init(void);
+int _log_open(const char *__path);
 void _log_free(void);
 int _log_write(const char *__name, const char *__fmt_str, ...);
+int _log_print(struct _log_site *__site ,const char *__name ,const char *__fmt_str ,...);
+int _log_set_format(int __format);
+int _log_set_rotate(off_t __size ,unsigned __interval ,unsigned __keep);
+int _log_set_backend(int __backend);
+int _log_flight_open(const char *__name ,unsigned __slots);
+void _log_flight_close(void);
+int _log_sink_add(int __type ,const char *__target ,int __level ,unsigned __batch ,unsigned __interval_ms);
+int _log_sink_set_level(int __id ,int __level);
+int _log_sink_set_batch(int __id ,unsigned __batch ,unsigned __interval_ms);
+int _log_config(const char *__spec);
+int _log_set_ratelimit(unsigned __rate ,unsigned __burst);
+int _log_set_dedup(int __on);
+void _log_site_track(struct _log_site *__site);
+void _log_site_report(void);
+int _log_set_level(int __level);
+int _log_get_level(void);
+int _log_set_level_for(const char *__name ,int __level);
+int _log_level_check(int __level ,const char *__pname ,const char *__tname);
+int _log_level_signal(void);
+
+/**
+ * @brief  运行期等级过滤：未设置按名称覆盖时只比较一次原子变量
+ */
+#define LOG_ENABLED(lvl, pname, tname)\
+                        ((__atomic_load_n(&__log_noverride ,__ATOMIC_RELAXED) == 0) ?\
+                            ((lvl) >= __atomic_load_n(&__log_level ,__ATOMIC_RELAXED)) :\
+                            _log_level_check((lvl) ,(pname) ,(tname)))
+
+/**
+ * @brief  调用点限速：未启用时只读一次原子变量；启用时读一次粗粒度时钟并做一次 CAS。
+ *
+ * @return  允许输出返回 1；超出速率返回 0 并计数，由该调用点下一条输出的日志提示。
+ */
+static inline int _log_rate_allow(struct _log_site *__site)
+{
+    uint64_t __iv = __atomic_load_n(&__log_rate_iv ,__ATOMIC_RELAXED);
+    if(__iv == 0)
+        return 1;
+
+    struct timespec __ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE ,&__ts);
+    uint64_t __now = (uint64_t)__ts.tv_sec * 1000000000ULL + __ts.tv_nsec;
+    uint64_t __tat = __atomic_load_n(&__site->__tat ,__ATOMIC_RELAXED);
+    do
+    {
+        uint64_t __next = ((__tat > __now) ? __tat : __now) + __iv;
+        if(__next - __now > __atomic_load_n(&__log_rate_limit ,__ATOMIC_RELAXED))
+        {
+            if(__atomic_add_fetch(&__site->__limited ,1 ,__ATOMIC_RELAXED) == 1)
+                _log_site_track(__site);
+            return 0;
+        }
+        if(__atomic_compare_exchange_n(&__site->__tat ,&__tat ,__next ,1 ,__ATOMIC_RELAXED ,__ATOMIC_RELAXED))
+            return 1;
+    }while(1);
+}
+
+int _log_async_start(unsigned __slots ,int __policy);
+int _log_stage_start(size_t __size ,unsigned __interval_ms);
+void _log_stage_stop(void);
+void _log_async_stop(void);
+void _log_flush(void);
+unsigned long _log_dropped(void);
 
 /**
  * @brief 通用日志打印宏
@@ -47,7 +475,7 @@ int _log_write(const char *__name, const char *__fmt_str, ...);
  * 该宏用于格式化并打印带有进程名和线程名标识的日志信息，支持不同日志等级，
  * 适用于进程和线程相关的日志记录。
  *
- * @param level  日志等级字符串，如 "INFO"、"WARN"、"ERROR" 等，打印时会加上中括号
+ * @param level  日志等级字符串，"TRACE"、"DEBUG"、"INFO"、"WARN"、"ERROR"、"FATAL"，打印时会加上中括号
  * @param proc   指向进程结构体的指针 (__proc_t * 类型)，支持 NULL，若为 NULL 则打印 "NULL"
  * @param thd    指向线程结构体的指针 (__thd_t * 类型)，支持 NULL，若为 NULL 则打印 "NULL"
  * @param fmt    格式化字符串，类似 printf 的格式
@@ -56,23 +484,35 @@ int _log_write(const char *__name, const char *__fmt_str, ...);
  * @details
  * - 根据传入的进程指针和线程指针，分别提取其 __name 字段，用于在日志中标识具体哪个进程、哪个线程
  * - 如果传入的指针为 NULL，会以字符串 "NULL" 代替，避免空指针访问导致崩溃
- * - 调用底层日志写入函数 `_log_write`，日志格式为：
+ * - 调用底层日志写入函数 `_log_print`，日志格式为：
  *     时间戳 [LEVEL] [proc_name][thread_name]: 格式化后的日志内容
+ * - 每个调用点有一个静态状态 __log_site：二进制格式下首次调用时登记格式串，之后只记录参数；
+ *   启用限速时按调用点取令牌，超出速率的调用不求值参数、不格式化；
+ *   启用合并时与该调用点上一条内容相同的日志只计数
+ * - 等级过滤在求值可变参数与格式化之前进行：
+ *   低于 LOG_LEVEL_MIN 的调用点整体被编译器删除；
+ *   低于运行期阈值（或该进程/线程名的单独阈值）时只付出一次原子读与比较
  *
  * @note
  * - 宏内部使用 do{ ... }while(0) 结构保证单条语句的完整性，避免宏展开时产生语法问题
  * - __thd_t 类型转换强制写入线程指针，保证能访问 __name 字段
- * - 该宏依赖 `_log_write` 函数正确实现日志写入功能
+ * - 该宏依赖 `_log_print` 函数正确实现日志写入功能；level 与 fmt 必须是字符串字面量
  *
  * @example
  * LOG_PRINT("INFO", proc_ptr, thread_ptr, "create thread tid=%lu", thread_ptr->__id);
  * 输出示例：
- * 2025-06-24 14:30:00 [INFO] [proc1][main]: create thread tid=12345
+ * 2025-06-24 14:30:00.123456 [INFO] [proc1][main]: create thread tid=12345
  */
 #define LOG_PRINT(level, proc, thd, fmt, ...)\
                                             do{\
-                                                const char *__pname = (proc) ? (proc)->__name : "NULL";\
-                                                const char *__tname = (thd) ? ((__thd_t *)(thd))->__name : "NULL";\
-                                                _log_write("[" level "]", "[%s][%s]: " fmt, __pname, __tname, ##__VA_ARGS__);\
+                                                if(LOG_LEVEL_OF(level) >= LOG_LEVEL_MIN){\
+                                                    const char *__pname = (proc) ? (proc)->__name : "NULL";\
+                                                    const char *__tname = (thd) ? ((__thd_t *)(thd))->__name : "NULL";\
+                                                    if(LOG_ENABLED(LOG_LEVEL_OF(level), __pname, __tname)){\
+                                                        static struct _log_site __log_site = { .__file = __FILE__ ,.__line = __LINE__ };\
+                                                        if(_log_rate_allow(&__log_site))\
+                                                            _log_print(&__log_site, "[" level "]", "[%s][%s]: " fmt, __pname, __tname, ##__VA_ARGS__);\
+                                                    }\
+                                                }\
                                             }while(0)
 #endif
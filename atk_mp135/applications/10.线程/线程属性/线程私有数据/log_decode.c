@@ -0,0 +1,466 @@
+/**
+ * @file    log_decode.c
+ * @brief   二进制日志解码工具（主机端）
+ *
+ * 将 LOG_FORMAT_BINARY 模式写出的日志文件还原为与文本模式相同的格式：
+ *   时间戳 [LEVEL] [proc_name][thread_name]: 格式化后的日志内容
+ *
+ * 用法：
+ *   make log_decode
+ *   ./log_decode [-t] run.log > run.txt
+ *     -t  在时间戳后附加线程号，如 "2025-06-24 14:30:00.123456 <1234> [INFO] ..."
+ *   ./log_decode -f /dev/shm/<name>
+ *     导出飞行记录器（_log_flight_open）中最近的日志，进程运行中或崩溃后均可使用
+ *
+ * @note
+ * - 记录格式见 log.h 中的“二进制日志格式”说明，本工具只使用其中的常量与记录头定义；
+ * - 整数参数统一按 64 位还原，格式串中的长度修饰在输出时替换为 ll，因此在 64 位主机上解码
+ *   32 位设备的日志结果一致；
+ * - 时间戳按主机本地时区显示，可通过 TZ 环境变量指定设备所在时区；
+ * - 只支持与主机相同字节序的日志文件。
+ */
+#include "log.h"
+
+static const char **__names = NULL;    ///< 按格式串编号索引的名称
+static const char **__fmts = NULL;     ///< 按格式串编号索引的格式串
+static uint32_t __nfmts = 0;
+
+/**
+ * @func   decode_def
+ * @brief  记录一条格式串登记
+ */
+static int decode_def(uint32_t __fid ,const char *__p ,size_t __len)
+{
+    const char *__name = __p;
+    const char *__end = memchr(__p ,'\0' ,__len);
+    if(__end == NULL || __fid == 0)
+        return -1;
+    const char *__fmt = __end + 1;
+    if(memchr(__fmt ,'\0' ,__len - (__fmt - __p)) == NULL)
+        return -1;
+
+    if(__fid > __nfmts)
+    {
+        uint32_t __n = (__fid < 64) ? 64 : __fid * 2;
+        __names = realloc(__names ,__n * sizeof(char *));
+        __fmts = realloc(__fmts ,__n * sizeof(char *));
+        if(__names == NULL || __fmts == NULL)
+            return -1;
+        memset(__names + __nfmts ,0 ,(__n - __nfmts) * sizeof(char *));
+        memset(__fmts + __nfmts ,0 ,(__n - __nfmts) * sizeof(char *));
+        __nfmts = __n;
+    }
+
+    /* 同一编号在分段开头会重复登记，以最后一次为准 */
+    free((void *)__names[__fid - 1]);
+    free((void *)__fmts[__fid - 1]);
+    __names[__fid - 1] = strdup(__name);
+    __fmts[__fid - 1] = strdup(__fmt);
+    return 0;
+}
+
+/**
+ * @func   decode_time
+ * @brief  输出 "YYYY-MM-DD HH:MM:SS.uuuuuu"（可选线程号）
+ */
+static void decode_time(const struct _log_rec *__h ,int __show_tid)
+{
+    time_t __sec = (time_t)(__h->__ts / 1000000000ULL);
+    long __us = (long)(__h->__ts % 1000000000ULL) / 1000;
+    struct tm _tm;
+    char __buf[32];
+
+    localtime_r(&__sec ,&_tm);
+    strftime(__buf ,sizeof(__buf) ,"%Y-%m-%d %H:%M:%S" ,&_tm);
+    fprintf(stdout ,"%s.%06ld " ,__buf ,__us);
+    if(__show_tid)
+        fprintf(stdout ,"<%u> " ,__h->__tid);
+}
+
+/**
+ * @struct decode_args
+ * @brief  LOG_REC_MSG 参数读取游标
+ */
+struct decode_args
+{
+    const unsigned char *p;
+    const unsigned char *end;
+    int left;
+};
+
+/**
+ * @func   decode_next
+ * @brief  取出下一个参数；参数已取完或数据损坏时返回 0
+ */
+static int decode_next(struct decode_args *__a ,int *__tag ,uint64_t *__v ,const char **__s ,uint16_t *__sl)
+{
+    if(__a->left <= 0 || __a->p >= __a->end)
+        return 0;
+
+    *__tag = *__a->p++;
+    if(*__tag == LOG_ARG_STR)
+    {
+        if(__a->end - __a->p < 2)
+            return 0;
+        memcpy(__sl ,__a->p ,2);
+        __a->p += 2;
+        if(__a->end - __a->p < *__sl)
+            return 0;
+        *__s = (const char *)__a->p;
+        __a->p += *__sl;
+    }
+    else if(*__tag == LOG_ARG_F64)
+    {
+        if(__a->end - __a->p < 8)
+            return 0;
+        memcpy(__v ,__a->p ,8);
+        __a->p += 8;
+    }
+    else
+    {
+        /* LEB128，I64 为 zigzag 编码 */
+        uint64_t __u = 0;
+        int __shift = 0;
+        unsigned char __b;
+        do
+        {
+            if(__a->p >= __a->end || __shift > 63)
+                return 0;
+            __b = *__a->p++;
+            __u |= (uint64_t)(__b & 0x7f) << __shift;
+            __shift += 7;
+        }while(__b & 0x80);
+        *__v = (*__tag == LOG_ARG_I64) ? ((__u >> 1) ^ (~(__u & 1) + 1)) : __u;
+    }
+    __a->left--;
+    return 1;
+}
+
+/**
+ * @func   decode_int
+ * @brief  取出一个整数参数（用于 '*' 宽度/精度）
+ */
+static int decode_int(struct decode_args *__a ,int *__out)
+{
+    int __tag;
+    uint64_t __v = 0;
+    const char *__s;
+    uint16_t __sl;
+    if(!decode_next(__a ,&__tag ,&__v ,&__s ,&__sl) || __tag == LOG_ARG_STR)
+        return 0;
+    *__out = (int)(int64_t)__v;
+    return 1;
+}
+
+/**
+ * @func   decode_msg
+ * @brief  按登记的格式串逐个转换说明符还原一条 LOG_REC_MSG
+ */
+static void decode_msg(const char *__fmt ,const unsigned char *__p ,size_t __len ,int __nargs)
+{
+    struct decode_args __a = { __p ,__p + __len ,__nargs };
+    char __spec[64];
+
+    while(*__fmt != '\0')
+    {
+        if(*__fmt != '%')
+        {
+            const char *__q = strchr(__fmt ,'%');
+            size_t __n = (__q == NULL) ? strlen(__fmt) : (size_t)(__q - __fmt);
+            fwrite(__fmt ,1 ,__n ,stdout);
+            __fmt += __n;
+            continue;
+        }
+        if(__fmt[1] == '%')
+        {
+            fputc('%' ,stdout);
+            __fmt += 2;
+            continue;
+        }
+
+        /* 重建转换说明：保留标志、宽度、精度，长度修饰统一替换 */
+        const char *__start = __fmt++;
+        size_t __sn = 0;
+        int __star[2] ,__nstar = 0 ,__ok = 1;
+        __spec[__sn++] = '%';
+        while(*__fmt != '\0' && strchr("-+ #0'" ,*__fmt) != NULL && __sn < 16)
+            __spec[__sn++] = *__fmt++;
+        if(*__fmt == '*')
+        {
+            __ok &= decode_int(&__a ,&__star[__nstar++]);
+            __spec[__sn++] = *__fmt++;
+        }
+        while(*__fmt >= '0' && *__fmt <= '9' && __sn < 32)
+            __spec[__sn++] = *__fmt++;
+        if(*__fmt == '.')
+        {
+            __spec[__sn++] = *__fmt++;
+            if(*__fmt == '*')
+            {
+                __ok &= decode_int(&__a ,&__star[__nstar++]);
+                __spec[__sn++] = *__fmt++;
+            }
+            while(*__fmt >= '0' && *__fmt <= '9' && __sn < 48)
+                __spec[__sn++] = *__fmt++;
+        }
+        while(*__fmt != '\0' && strchr("hlqLzjt" ,*__fmt) != NULL)
+            __fmt++;
+        char __conv = *__fmt;
+        if(__conv != '\0')
+            __fmt++;
+
+        int __tag = 0;
+        uint64_t __v = 0;
+        const char *__s = NULL;
+        uint16_t __sl = 0;
+        if(!__ok || !decode_next(&__a ,&__tag ,&__v ,&__s ,&__sl))
+        {
+            /* 参数被截断：原样输出转换说明 */
+            fwrite(__start ,1 ,__fmt - __start ,stdout);
+            continue;
+        }
+
+        switch(__conv)
+        {
+            case 'c':
+                __spec[__sn++] = 'c';
+                __spec[__sn] = '\0';
+                if(__nstar == 2)
+                    fprintf(stdout ,__spec ,__star[0] ,__star[1] ,(int)__v);
+                else if(__nstar == 1)
+                    fprintf(stdout ,__spec ,__star[0] ,(int)__v);
+                else
+                    fprintf(stdout ,__spec ,(int)__v);
+                break;
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                __spec[__sn++] = 'l';
+                __spec[__sn++] = 'l';
+                __spec[__sn++] = __conv;
+                __spec[__sn] = '\0';
+                if(__nstar == 2)
+                    fprintf(stdout ,__spec ,__star[0] ,__star[1] ,(long long)__v);
+                else if(__nstar == 1)
+                    fprintf(stdout ,__spec ,__star[0] ,(long long)__v);
+                else
+                    fprintf(stdout ,__spec ,(long long)__v);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            {
+                double __d;
+                memcpy(&__d ,&__v ,sizeof(__d));
+                __spec[__sn++] = __conv;
+                __spec[__sn] = '\0';
+                if(__nstar == 2)
+                    fprintf(stdout ,__spec ,__star[0] ,__star[1] ,__d);
+                else if(__nstar == 1)
+                    fprintf(stdout ,__spec ,__star[0] ,__d);
+                else
+                    fprintf(stdout ,__spec ,__d);
+                break;
+            }
+            case 's':
+            {
+                /* 字符串不以 '\0' 结尾，精度由 '.*' 传入长度 */
+                char *__str = strndup(__s ,__sl);
+                __spec[__sn++] = 's';
+                __spec[__sn] = '\0';
+                if(__str == NULL)
+                    break;
+                if(__nstar == 2)
+                    fprintf(stdout ,__spec ,__star[0] ,__star[1] ,__str);
+                else if(__nstar == 1)
+                    fprintf(stdout ,__spec ,__star[0] ,__str);
+                else
+                    fprintf(stdout ,__spec ,__str);
+                free(__str);
+                break;
+            }
+            case 'p':
+                if(__v == 0)
+                    fputs("(nil)" ,stdout);
+                else
+                    fprintf(stdout ,"0x%llx" ,(unsigned long long)__v);
+                break;
+            default:
+                fwrite(__start ,1 ,__fmt - __start ,stdout);
+                break;
+        }
+    }
+    fputc('\n' ,stdout);
+}
+
+/**
+ * @func   decode_flight
+ * @brief  按序号导出飞行记录器中仍然有效的日志行
+ *
+ * 以只读共享映射读取，写入进程仍在运行时同样适用：读取前后槽位序号不一致
+ * （正在被改写）的记录被跳过。
+ */
+static int decode_flight(const char *__path)
+{
+    int __fd = open(__path ,O_RDONLY);
+    if(__fd == -1)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    struct stat __st;
+    if(fstat(__fd ,&__st) == -1 || (size_t)__st.st_size < sizeof(struct _log_flight_hdr))
+    {
+        fprintf(stderr ,"log_decode: %s is not a flight recorder\n" ,__path);
+        close(__fd);
+        return -1;
+    }
+
+    const struct _log_flight_hdr *__h = mmap(NULL ,__st.st_size ,PROT_READ ,MAP_SHARED ,__fd ,0);
+    close(__fd);
+    if(__h == MAP_FAILED)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    if(__h->__magic != LOG_FLIGHT_MAGIC || __h->__version != LOG_FLIGHT_VERSION ||
+       __h->__slot_size != sizeof(struct _log_flight_slot) || __h->__nslots == 0 ||
+       (__h->__nslots & (__h->__nslots - 1)) != 0 ||
+       sizeof(*__h) + (size_t)__h->__nslots * __h->__slot_size > (size_t)__st.st_size)
+    {
+        fprintf(stderr ,"log_decode: %s is not a flight recorder (or version differs)\n" ,__path);
+        munmap((void *)__h ,__st.st_size);
+        return -1;
+    }
+
+    const struct _log_flight_slot *__slots = (const struct _log_flight_slot *)(__h + 1);
+    uint64_t __head = __atomic_load_n(&__h->__head ,__ATOMIC_ACQUIRE);
+    uint64_t __start = (__head > __h->__nslots) ? __head - __h->__nslots : 0;
+    unsigned long __ok = 0 ,__skip = 0;
+    char __line[LOG_LINE_MAX];
+
+    for(uint64_t __pos = __start; __pos < __head; __pos++)
+    {
+        const struct _log_flight_slot *__s = &__slots[__pos & (__h->__nslots - 1)];
+        if(__atomic_load_n(&__s->__seq ,__ATOMIC_ACQUIRE) != __pos + 1)
+        {
+            __skip++;
+            continue;
+        }
+        uint32_t __len = __s->__len;
+        if(__len > sizeof(__line))
+            __len = sizeof(__line);
+        memcpy(__line ,__s->__data ,__len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&__s->__seq ,__ATOMIC_RELAXED) != __pos + 1)
+        {
+            __skip++;
+            continue;
+        }
+        fwrite(__line ,1 ,__len ,stdout);
+        __ok++;
+    }
+
+    fprintf(stderr ,"log_decode: pid %d, %llu records written, %lu shown, %lu skipped, %llu overwritten\n",
+        __h->__pid ,(unsigned long long)__head ,__ok ,__skip ,(unsigned long long)__start);
+    munmap((void *)__h ,__st.st_size);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int __show_tid = 0 ,__flight = 0;
+    const char *__path = NULL;
+
+    for(int __i = 1; __i < argc; __i++)
+    {
+        if(strcmp(argv[__i] ,"-t") == 0)
+            __show_tid = 1;
+        else if(strcmp(argv[__i] ,"-f") == 0)
+            __flight = 1;
+        else
+            __path = argv[__i];
+    }
+    if(__path == NULL)
+    {
+        fprintf(stderr ,"usage: %s [-t] <binary log file>\n"
+                        "       %s -f <flight recorder file>\n" ,argv[0] ,argv[0]);
+        return -1;
+    }
+    if(__flight)
+        return decode_flight(__path);
+
+    FILE *__fp = fopen(__path ,"rb");
+    if(__fp == NULL)
+    {
+        PRINT_ERROR();
+        return -1;
+    }
+
+    struct _log_rec __h;
+    unsigned char __body[65536];
+    long __nrec = 0;
+    int __ret = 0;
+
+    while(fread(&__h ,sizeof(__h) ,1 ,__fp) == 1)
+    {
+        if(__h.__len < sizeof(__h))
+        {
+            fprintf(stderr ,"log_decode: bad record at #%ld\n" ,__nrec);
+            __ret = -1;
+            break;
+        }
+        size_t __len = __h.__len - sizeof(__h);
+        if(__len > 0 && fread(__body ,1 ,__len ,__fp) != __len)
+        {
+            fprintf(stderr ,"log_decode: truncated record at #%ld\n" ,__nrec);
+            __ret = -1;
+            break;
+        }
+        __body[__len] = '\0';
+
+        if(__nrec == 0 && (__h.__type != LOG_REC_HDR || __h.__fid != LOG_BIN_MAGIC))
+        {
+            fprintf(stderr ,"log_decode: %s is not a binary log (or byte order differs)\n" ,__path);
+            __ret = -1;
+            break;
+        }
+        __nrec++;
+
+        switch(__h.__type)
+        {
+            case LOG_REC_HDR:
+                if(__h.__nargs != LOG_BIN_VERSION)
+                    fprintf(stderr ,"log_decode: version %u, expected %d\n" ,__h.__nargs ,LOG_BIN_VERSION);
+                break;
+            case LOG_REC_DEF:
+                if(decode_def(__h.__fid ,(const char *)__body ,__len) == -1)
+                    fprintf(stderr ,"log_decode: bad format definition #%u\n" ,__h.__fid);
+                break;
+            case LOG_REC_MSG:
+                decode_time(&__h ,__show_tid);
+                if(__h.__fid == 0 || __h.__fid > __nfmts || __fmts[__h.__fid - 1] == NULL)
+                {
+                    fprintf(stdout ,"<unknown format #%u>\n" ,__h.__fid);
+                    break;
+                }
+                fprintf(stdout ,"%s " ,__names[__h.__fid - 1]);
+                decode_msg(__fmts[__h.__fid - 1] ,__body ,__len ,__h.__nargs);
+                break;
+            case LOG_REC_TEXT:
+            {
+                const char *__end = memchr(__body ,'\0' ,__len);
+                decode_time(&__h ,__show_tid);
+                if(__end == NULL)
+                    fprintf(stdout ,"%s\n" ,(const char *)__body);
+                else
+                    fprintf(stdout ,"%s %s\n" ,(const char *)__body ,__end + 1);
+                break;
+            }
+            default:
+                fprintf(stderr ,"log_decode: unknown record type %u\n" ,__h.__type);
+                break;
+        }
+    }
+
+    fclose(__fp);
+    return __ret;
+}
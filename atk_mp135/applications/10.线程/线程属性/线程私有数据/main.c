@@ -6,14 +6,20 @@
 int main(int argc, char *argv[])
 {
     __tim1 = _time_get_timestamp();
+    /*-- 划分实时/杂务 CPU --*/
+    cpu_affinity_init();
+    /*-- 预分配线程栈 --*/
+    thread_stack_init();
     /*-- 初始化日志 --*/
     log_init();
     /*-- 初始化进程 --*/
     process_init();
     /* 初始化相关线程同步 */
     thread_sync_init();
-    /*-- 初始化线程链表 --*/
+    /*-- 初始化线程注册表 --*/
     thread_init();
+    /*-- 初始化线程池 --*/
+    thread_pool_init();
 #if 0   
     while(1)
     {
@@ -22,8 +28,7 @@ int main(int argc, char *argv[])
     }
 #endif
     /*-- 退出主线程 --*/
-    __thd_list_find_nd(&__proc->__pthdl, "main");
-    pthread_cleanup_push(thread_exit_handler, __proc->__pthdl->__pthd->__name);
+    pthread_cleanup_push(thread_exit_handler, __treg_self(__proc->__preg));
     pthread_cleanup_pop(1);
 }
 
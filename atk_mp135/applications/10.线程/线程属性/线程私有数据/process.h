@@ -23,7 +23,7 @@
 #include "file_looplist.h"
 #include <sys/wait.h>
 #include "signal.h"
-#include "thread_list.h"
+#include "thread_reg.h"
 
 #define CHILD_PROCESS_MAX_SIZE  256
 /**
@@ -82,7 +82,7 @@ struct __proc_struct
 
     char *__command;         ///< 原始命令字符串，保存用户输入的命令，常用于日志或 system 实现
     __flist_t *__pfl;        ///< 文件资源链表头，管理进程打开的文件（可封装 open/close 逻辑）
-    __tlist_t *__pthdl;      ///< 线程链表头指针，挂载该进程所属的线程列表（用于主线程+子线程管理）
+    __treg_t *__preg;        ///< 线程注册表，按名称/线程 ID 索引该进程所属的线程（用于主线程+子线程管理）
 };
 
 typedef struct __proc_struct __proc_t;
@@ -205,8 +205,8 @@ __proc_t* __proc_init(char *__name);
                                                                 _sig_free(&(*__proc)->__sig);\
                                                             if((*__proc)->__pfl != NULL)\
                                                                 __file_list_free(&(*__proc)->__pfl);\
-                                                            if((*__proc)->__pthdl != NULL)\
-                                                                __thd_list_free(&(*__proc)->__pthdl);\
+                                                            if((*__proc)->__preg != NULL)\
+                                                                __treg_free(&(*__proc)->__preg);\
                                                             __proc_free(__proc);\
                                                         }\
                                                         __exit_fn(__ret);\
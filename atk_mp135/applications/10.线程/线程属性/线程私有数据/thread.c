@@ -414,6 +414,59 @@ int __thread_attr_setdetachstate(__thd_t *__pthd ,int __detachstate)
     return 0;
 }
 
+/**
+ * @func   __thread_attr_setaffinity
+ * @brief  按放置策略计算 CPU 亲和性并写入线程属性对象
+ *
+ * @param[in,out] __pthd  线程结构体指针，不能为空。使用 __placement 与 __op 中的 THREAD_OP_REALTIME，
+ *                        非 PIN 策略会把计算出的掩码写回 __cpuset。
+ *
+ * @return
+ *   -  0  ：设置成功，或当前拓扑下该策略无需设置（如单核上的 ISOLATE_RT）；
+ *   - -1  ：参数非法（PIN 策略掩码为空、未知策略或拓扑读取失败）；
+ *   - >0  ：pthread_attr_setaffinity_np 返回的错误码。
+ *
+ * @note
+ *  需在 __thread_attr_init() 之后、pthread_create() 之前调用，__thread_create 会自动完成。
+ */
+int __thread_attr_setaffinity(__thd_t *__pthd)
+{
+    if(__pthd == NULL)
+        return -1;
+
+    int __realtime = ((__pthd->__op & THREAD_OP_REALTIME) == THREAD_OP_REALTIME);
+    int __ret = __topo_place(__pthd->__placement ,__realtime ,&__pthd->__cpuset);
+    if(__ret == 1)
+        return 0;
+    if(__ret != 0)
+        return -1;
+
+    __ret = pthread_attr_setaffinity_np(&__pthd->__attr ,sizeof(cpu_set_t) ,&__pthd->__cpuset);
+    if(__ret != 0)
+    {
+        /* 错误码处理（如日志记录等） */
+        return __ret;
+    }
+    return 0;
+}
+
+/**
+ * @func   __thread_getaffinity
+ * @brief  获取已创建线程的 CPU 亲和性掩码
+ *
+ * @param[in]  __id      线程 ID
+ * @param[out] __cpuset  亲和性掩码，不能为空
+ *
+ * @return 0 成功；-1 参数非法；>0 pthread_getaffinity_np 返回的错误码。
+ */
+int __thread_getaffinity(pthread_t __id ,cpu_set_t *__cpuset)
+{
+    if(__cpuset == NULL)
+        return -1;
+
+    return pthread_getaffinity_np(__id ,sizeof(cpu_set_t) ,__cpuset);
+}
+
 /**
  * @brief 获取已创建线程的调度策略和调度参数
  *
@@ -699,7 +752,8 @@ pthread_t __thread_getid(void)
  *   - 若线程是分离（detached）状态，则不能调用 pthread_join，否则返回 EINVAL；
  *   - 不应对同一线程调用多次 pthread_join；
  *   - 调用前建议确保目标线程已启动；
- *   - 若线程函数未显式 return，返回值为 NULL。
+ *   - 若线程函数未显式 return，返回值为 NULL；
+ *   - join 成功后线程使用的栈池栈（__stack）立即交还栈池。
  *
  * @example
  *   void *tret = NULL;
@@ -717,7 +771,12 @@ int __thread_join(__thd_t *__pthd ,void *__ret)
     if(__rc != 0)
     {
         /* 错误码处理（如日志记录等） */
+        return __rc;
     }
+
+    /* 线程已结束，栈交还栈池 */
+    __tstack_put(__pthd->__stack);
+    __pthd->__stack = NULL;
     return __rc;
 }
 
@@ -768,7 +827,8 @@ int __thread_cancel(__thd_t *__pthd)
  * @note
  *   - 分离线程不能再调用 pthread_join，否则行为未定义；
  *   - 应在新线程创建后尽早调用 __thread_detach；
- *   - 若线程未分离且未被 join，将成为“僵尸线程”造成资源泄露。
+ *   - 若线程未分离且未被 join，将成为“僵尸线程”造成资源泄露；
+ *   - 线程使用栈池栈时必须经由本函数分离（而非直接 pthread_detach），栈池才能在其退出后回收栈。
  */
 int __thread_detach(__thd_t *__pthd)
 {
@@ -779,7 +839,12 @@ int __thread_detach(__thd_t *__pthd)
     if(__ret != 0)
     {
         /* 错误码处理（如日志记录等） */
+        return __ret;
     }
+
+    /* 栈改由栈池在线程退出后回收 */
+    __tstack_detach(__pthd->__stack);
+    __pthd->__stack = NULL;
     return __ret;
 }
 
@@ -822,6 +887,17 @@ __thd_t *__thread_init(char *__name)
     return __pthd;
 }
 
+/**
+ * @name    __thread_trampoline
+ * @brief   使用栈池栈的线程入口：先登记内核线程号供栈池判断线程是否退出，再进入 __start_routine。
+ */
+static void *__thread_trampoline(void *__arg)
+{
+    __thd_t *__pthd = (__thd_t *)__arg;
+    __tstack_bind_self(__pthd->__stack);
+    return __pthd->__start_routine(__pthd);
+}
+
 /**
  * @func   __thread_create
  * @brief  创建一个新的线程，并根据操作标志配置线程属性
@@ -846,16 +922,20 @@ __thd_t *__thread_init(char *__name)
  *       - __thread_attr_setschedparam() 设置调度优先级；
  *    4. 若设置 THREAD_OP_DETACHED 标志，则调用
  *       __thread_attr_setdetachstate() 设置线程为分离状态；
- *    5. 若设置 THREAD_OP_STACKSIZE 标志，且栈大小合法，则调用
- *       __thread_attr_setstack() 设置线程栈地址和大小；
- *    6. 使用 pthread_create() 创建线程，入口函数参数为结构体指针；
- *    7. 若创建失败，调用 PRINT_ERROR 宏输出错误信息；
- *    8. 返回线程创建结果，成功返回 0，失败返回错误码。
+ *    5. 若设置 THREAD_OP_STACKSIZE 标志，且栈大小合法：
+ *       - 指定了 __stack_addr 时调用 __thread_attr_setstack() 使用调用者的栈；
+ *       - 否则从栈池取带保护页的栈（实时线程预触碰全部页面），栈池无法提供时
+ *         调用 __thread_attr_setstacksize() 交给 glibc 分配；
+ *    6. 若设置 THREAD_OP_CPUAFFINITY 标志，则调用
+ *       __thread_attr_setaffinity() 按 __placement 策略设置 CPU 亲和性；
+ *    7. 使用 pthread_create() 创建线程，入口函数参数为结构体指针；
+ *    8. 若创建失败，调用 PRINT_ERROR 宏输出错误信息；
+ *    9. 返回线程创建结果，成功返回 0，失败返回错误码。
  *
  * @note
  *  - __start_routine 必须为有效函数指针；
  *  - 若使用显式调度策略/优先级配置，建议具备 root 权限；
- *  - 可通过设置 __op 字段组合 THREAD_OP_REALTIME / THREAD_OP_DETACHED / THREAD_OP_STACKSIZE；
+ *  - 可通过设置 __op 字段组合 THREAD_OP_REALTIME / THREAD_OP_DETACHED / THREAD_OP_STACKSIZE / THREAD_OP_CPUAFFINITY；
  *  - 自定义栈大小不能小于系统最小值 PTHREAD_STACK_MIN；
  *  - __thread_attr_* 系列函数需保证幂等和错误处理；
  *  - 若需等待线程退出，可在外部调用 pthread_join(__pthd->__id, NULL)。
@@ -912,28 +992,68 @@ int __thread_create(__thd_t *__pthd)
     /* 是否设置线程栈属性 */
     if((__pthd->__op & THREAD_OP_STACKSIZE) == THREAD_OP_STACKSIZE)
     {
-        if(__pthd->__stack_sz < PTHREAD_STACK_MIN)
+        if(__pthd->__stack_sz < (size_t)PTHREAD_STACK_MIN)
             return -1;
 
-        if(__pthd->__stack_addr == NULL)
-            __ret = __thread_attr_setstacksize(__pthd ,__pthd->__stack_sz);
-        else
+        if(__pthd->__stack_addr != NULL)
+        {
             __ret = __thread_attr_setstack(__pthd ,__pthd->__stack_addr ,__pthd->__stack_sz);
+        }
+        else
+        {
+            /* 优先从栈池取栈，实时线程要求预触碰；超出最大级别或 mmap 失败时退回 glibc 分配 */
+            __pthd->__stack = __tstack_get(__pthd->__stack_sz ,(__pthd->__op & THREAD_OP_REALTIME) == THREAD_OP_REALTIME);
+            if(__pthd->__stack != NULL)
+                __ret = __thread_attr_setstack(__pthd ,__pthd->__stack->__addr ,__pthd->__stack->__size);
+            else
+                __ret = __thread_attr_setstacksize(__pthd ,__pthd->__stack_sz);
+        }
 
         if(__ret != 0)
         {
-            return __ret;
+            goto fail;
+        }
+    }
+
+    /* 是否设置 CPU 亲和性 */
+    if((__pthd->__op & THREAD_OP_CPUAFFINITY) == THREAD_OP_CPUAFFINITY)
+    {
+        __ret = __thread_attr_setaffinity(__pthd);
+        if(__ret != 0)
+        {
+            goto fail;
         }
     }
 
-    /* 创建线程，线程入口函数接收结构体指针作为参数 */
-    __ret = pthread_create(&__pthd->__id ,&__pthd->__attr ,__pthd->__start_routine ,__pthd);
+    /* 
+     * 创建线程，线程入口函数接收结构体指针作为参数；使用栈池栈时经跳板登记内核线程号。
+     * 分离线程可能在 pthread_create 返回前就已退出并被注销，之后不能再访问 __pthd。
+     */
+    __tstack_t *__stk = __pthd->__stack;
+    int __detached = ((__pthd->__op & THREAD_OP_DETACHED) == THREAD_OP_DETACHED);
+    if(__stk != NULL)
+        __ret = pthread_create(&__pthd->__id ,&__pthd->__attr ,__thread_trampoline ,__pthd);
+    else
+        __ret = pthread_create(&__pthd->__id ,&__pthd->__attr ,__pthd->__start_routine ,__pthd);
     if(__ret != 0)
     {
         PRINT_ERROR();  /* 创建失败时打印错误信息 */
+        goto fail;
     }
 
-    return 0;
+    /* 分离线程的栈交给栈池，在线程退出后回收 */
+    if(__stk != NULL && __detached)
+        __tstack_detach(__stk);
+    return __ret;
+
+fail:
+    /* 创建失败，栈池栈立即归还 */
+    if(__pthd->__stack != NULL)
+    {
+        __tstack_put(__pthd->__stack);
+        __pthd->__stack = NULL;
+    }
+    return __ret;
 }
 
 /**
@@ -977,7 +1097,7 @@ void __thread_free(__thd_t **__pthd)
  * - 推荐在线程执行逻辑结束前调用此函数；
  * - 若线程结构或进程结构为空，则不执行任何操作；
  * - __ret 用于线程返回值，可通过 pthread_join 获取；
- * - 要确保 __thd_list_delete_nd 是线程安全的，必要时需加锁。
+ * - __treg_del 之后 __pthd 由注册表在宽限期后释放，本函数不再访问它。
  */
 #include "process.h"
 void __thread_exit(__proc_t *__proc ,__thd_t *__pthd ,int __ret)
@@ -993,7 +1113,7 @@ void __thread_exit(__proc_t *__proc ,__thd_t *__pthd ,int __ret)
         return;
 
     /* 删除线程节点 */
-    __rc = __thd_list_delete_nd(&__proc->__pthdl ,__pthd->__name); 
+    __rc = __treg_del(__proc->__preg ,__pthd);
     if(__rc != 0)
         return;
 
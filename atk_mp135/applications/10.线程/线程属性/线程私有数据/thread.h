@@ -28,6 +28,8 @@
 #include "file.h"
 #include "log.h"
 #include "tsync.h"
+#include "thread_topo.h"
+#include "thread_stack.h"
 
 /* 
  * 前向声明及类型别名定义：
@@ -125,6 +127,10 @@ int __thread_key_delete(__thd_tls_t *__tls);
  * - __op            : 操作标志，指示是否启用实时调度策略相关设置（0=默认，1=启用）；
  * - __stack_addr    : 线程栈的起始地址，若为 0 或 NULL，表示使用系统默认栈；
  * - __stack_sz      : 线程栈大小（字节数），需不小于系统定义的 PTHREAD_STACK_MIN；
+ * - __stack         : 从栈池取得的栈（见 thread_stack.h），可 join 线程由 __thread_join 交还，
+ *                     分离线程的栈由栈池在线程退出后回收，调用者勿修改；
+ * - __cpuset        : CPU 亲和性掩码，PIN 策略时由调用者填写，其他策略创建时写回实际结果；
+ * - __placement     : CPU 放置策略（thread_place_t），配合 THREAD_OP_CPUAFFINITY 使用；
  * - __start_routine : 线程入口函数指针，函数签名为 void* (*)(void*)；
  * - __data          : 传递给线程入口函数的参数指针。
  */
@@ -141,6 +147,10 @@ struct __thread_struct
 
     void *__stack_addr;                ///< 线程栈起始地址，0/NULL 表示默认栈
     size_t __stack_sz;                 ///< 线程栈大小，单位字节，需≥ PTHREAD_STACK_MIN
+    __tstack_t *__stack;               ///< 栈池中的栈，NULL 表示未使用栈池
+
+    cpu_set_t __cpuset;                ///< CPU 亲和性掩码
+    int __placement;                   ///< CPU 放置策略（thread_place_t）
 
     void *(*__start_routine) (void *); ///< 线程入口函数指针，线程执行的函数
     void *__data;                      ///< 线程函数参数指针，传递给线程入口函数的数据
@@ -157,15 +167,16 @@ typedef struct __thread_struct __thd_t;
  *   - 是否启用实时调度（设置显式调度策略与优先级）；
  *   - 是否设置线程为分离（detached）状态；
  *   - 是否显式设置线程栈大小；
- *   - 可拓展绑定 CPU、线程名称等其他功能。
+ *   - 是否按放置策略绑定 CPU（拓扑见 thread_topo.h）；
+ *   - 可拓展线程名称等其他功能。
  */
 typedef enum 
 {
     THREAD_OP_DEFAULT        = 0,         ///< 0b000：默认操作，使用系统默认调度策略与属性
     THREAD_OP_REALTIME       = (1 << 0),  ///< 0b001：启用实时调度策略（SCHED_FIFO / SCHED_RR），并设置优先级
     THREAD_OP_DETACHED       = (1 << 1),  ///< 0b010：将线程设置为分离状态，线程退出后自动释放资源
-    THREAD_OP_STACKSIZE      = (1 << 2)   ///< 0b100：启用自定义栈大小，需设置 __stacksize 字段
-    // 可拓展更多操作标志，如 THREAD_OP_CPUAFFINITY = (1 << 3) 表示绑定 CPU 等
+    THREAD_OP_STACKSIZE      = (1 << 2),  ///< 0b100：启用自定义栈大小，需设置 __stacksize 字段；未指定 __stack_addr 时从栈池取栈
+    THREAD_OP_CPUAFFINITY    = (1 << 3)   ///< 0b1000：按 __placement 策略设置 CPU 亲和性
 }thread_op_t;
 
 
@@ -175,6 +186,8 @@ int __thread_attr_setstacksize(__thd_t *__pthd ,size_t __stacksize);
 int __thread_attr_setstack(__thd_t *__pthd ,void *__stackaddr, size_t __stacksize);
 int __thread_attr_getdetachstate(__thd_t *__pthd ,int *__detachstate);
 int __thread_attr_setdetachstate(__thd_t *__pthd ,int __detachstate);
+int __thread_attr_setaffinity(__thd_t *__pthd);
+int __thread_getaffinity(pthread_t __id ,cpu_set_t *__cpuset);
 
 int __thread_getschedparam(pthread_t __id ,int *__policy ,struct sched_param *__param);
 int __thread_setschedparam(pthread_t __id ,int __policy ,struct sched_param __param);
@@ -200,6 +213,7 @@ void __thread_exit(__proc_t *__proc ,__thd_t *__pthd ,int __ret);
  *  1. 调用 __thread_getid() 获取当前线程的 pthread_t 线程ID，并保存到线程结构体的 __id 成员；
  *  2. 调用 __thread_getschedparam() 获取该线程的调度策略（__policy）和调度参数（__param）；
  *  3. 调用 __thread_attr_getstack() 获取线程属性中栈的起始地址（__stack_addr）和大小（__stack_sz）。
+ *  4. 调用 __thread_getaffinity() 获取线程实际的 CPU 亲和性掩码（__cpuset）。
  *
  * @param __pthd  指向自定义线程结构体 __thd_t 的有效指针，结构体必须已初始化。
  *
@@ -215,6 +229,7 @@ void __thread_exit(__proc_t *__proc ,__thd_t *__pthd ,int __ret);
                             (__pthd)->__id = __thread_getid();\
                             __thread_getschedparam((__pthd)->__id, &(__pthd)->__policy, &(__pthd)->__param);\
                             __thread_attr_getstack((__pthd) ,&((__pthd)->__stack_addr) ,&(__pthd)->__stack_sz);\
+                            __thread_getaffinity((__pthd)->__id ,&(__pthd)->__cpuset);\
                         }while(0)
 
 #endif
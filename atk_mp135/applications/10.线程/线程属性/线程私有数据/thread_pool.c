@@ -0,0 +1,591 @@
+/**
+ * @file    thread_pool.c
+ * @brief   基于 __thd_t 的固定大小工作线程池实现
+ *
+ * @details
+ * 工作线程通过 __thread_init/__thread_create 创建，线程入口收到自身的 __thd_t，
+ * 经 __data 取回所属线程池。任务队列为受 __lock 保护的有界环形数组，
+ * __not_empty/__not_full 两个条件变量分别唤醒工作线程与被背压阻塞的提交者。
+ * 所有限时等待都基于 CLOCK_MONOTONIC，不受系统时间调整影响。
+ *
+ * 锁顺序：线程池 __lock → future __lock，工作线程执行任务时不持有线程池锁。
+ */
+#include "thread_pool.h"
+
+/*****************************************************************************************/
+/*                                   内部辅助函数                                         */
+/*****************************************************************************************/
+
+/**
+ * @name    __tpool_now_ns
+ * @brief   单调时钟（纳秒），用于排队与执行耗时统计。
+ */
+static uint64_t __tpool_now_ns(void)
+{
+    struct timespec __ts;
+    clock_gettime(CLOCK_MONOTONIC ,&__ts);
+    return (uint64_t)__ts.tv_sec * 1000000000ULL + (uint64_t)__ts.tv_nsec;
+}
+
+/**
+ * @name    __tpool_deadline
+ * @brief   计算 __ms 毫秒后的单调时钟绝对时刻，供 pthread_cond_timedwait 使用。
+ */
+static void __tpool_deadline(struct timespec *__ts ,int __ms)
+{
+    clock_gettime(CLOCK_MONOTONIC ,__ts);
+    __ts->tv_sec += __ms / 1000;
+    __ts->tv_nsec += (long)(__ms % 1000) * 1000000L;
+    if(__ts->tv_nsec >= 1000000000L)
+    {
+        __ts->tv_sec++;
+        __ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * @name    __tpool_cond_init
+ * @brief   初始化使用 CLOCK_MONOTONIC 计时的条件变量。
+ *
+ * @return  0 成功；>0 pthread 错误码。
+ */
+static int __tpool_cond_init(pthread_cond_t *__cond)
+{
+    pthread_condattr_t __attr;
+    int __ret = pthread_condattr_init(&__attr);
+    if(__ret != 0)
+        return __ret;
+
+    pthread_condattr_setclock(&__attr ,CLOCK_MONOTONIC);
+    __ret = pthread_cond_init(__cond ,&__attr);
+    pthread_condattr_destroy(&__attr);
+    return __ret;
+}
+
+/**
+ * @name    __tpool_future_new
+ * @brief   分配 future，初始引用计数为 2（线程池一份、调用者一份）。
+ */
+static __tpool_future_t *__tpool_future_new(__tpool_fn_t __fn ,void *__arg)
+{
+    __tpool_future_t *__fut = (__tpool_future_t *)calloc(1 ,sizeof(__tpool_future_t));
+    if(__fut == NULL)
+        return NULL;
+
+    if(pthread_mutex_init(&__fut->__lock ,NULL) != 0)
+    {
+        free(__fut);
+        return NULL;
+    }
+    if(__tpool_cond_init(&__fut->__cond) != 0)
+    {
+        pthread_mutex_destroy(&__fut->__lock);
+        free(__fut);
+        return NULL;
+    }
+
+    __fut->__state = TPOOL_FUT_PENDING;
+    __fut->__refs = 2;
+    __fut->__fn = __fn;
+    __fut->__arg = __arg;
+    return __fut;
+}
+
+/**
+ * @name    __tpool_future_put
+ * @brief   释放一份 future 引用，最后一份引用释放时销毁 future。
+ */
+static void __tpool_future_put(__tpool_future_t *__fut)
+{
+    pthread_mutex_lock(&__fut->__lock);
+    int __refs = --__fut->__refs;
+    pthread_mutex_unlock(&__fut->__lock);
+
+    if(__refs == 0)
+    {
+        pthread_cond_destroy(&__fut->__cond);
+        pthread_mutex_destroy(&__fut->__lock);
+        free(__fut);
+    }
+}
+
+/**
+ * @name    __tpool_future_finish
+ * @brief   写入终态与结果并唤醒全部等待者。
+ */
+static void __tpool_future_finish(__tpool_future_t *__fut ,int __state ,void *__ret)
+{
+    pthread_mutex_lock(&__fut->__lock);
+    __fut->__ret = __ret;
+    __atomic_store_n(&__fut->__state ,__state ,__ATOMIC_RELEASE);
+    pthread_cond_broadcast(&__fut->__cond);
+    pthread_mutex_unlock(&__fut->__lock);
+}
+
+/**
+ * @name    __tpool_worker
+ * @brief   工作线程入口：循环取任务执行，线程池关闭且队列为空时退出。
+ *
+ * @param[in] __arg  工作线程自身的 __thd_t，__data 指向所属线程池。
+ */
+static void *__tpool_worker(void *__arg)
+{
+    __thd_t *__pthd = (__thd_t *)__arg;
+    __tpool_t *__pool = (__tpool_t *)__pthd->__data;
+
+    pthread_mutex_lock(&__pool->__lock);
+    for(;;)
+    {
+        while(__pool->__count == 0 && __pool->__state == TPOOL_RUNNING)
+            pthread_cond_wait(&__pool->__not_empty ,&__pool->__lock);
+
+        /* 排空关闭：队列为空才退出；丢弃关闭：队列已由 __tpool_shutdown 清空 */
+        if(__pool->__count == 0)
+            break;
+
+        __tpool_future_t *__fut = __pool->__queue[__pool->__head];
+        __pool->__queue[__pool->__head] = NULL;
+        __pool->__head = (__pool->__head + 1) % __pool->__cap;
+        __pool->__count--;
+        __pool->__active++;
+
+        uint64_t __t0 = __tpool_now_ns();
+        uint64_t __wait = __t0 - __fut->__t_submit;
+        __pool->__wait_ns += __wait;
+        if(__wait > __pool->__wait_max_ns)
+            __pool->__wait_max_ns = __wait;
+
+        pthread_cond_signal(&__pool->__not_full);
+        pthread_mutex_unlock(&__pool->__lock);
+
+        /* 执行任务，不持有线程池锁 */
+        __atomic_store_n(&__fut->__state ,TPOOL_FUT_RUNNING ,__ATOMIC_RELAXED);
+        void *__ret = __fut->__fn(__fut->__arg);
+        uint64_t __run = __tpool_now_ns() - __t0;
+
+        __tpool_future_finish(__fut ,TPOOL_FUT_DONE ,__ret);
+        __tpool_future_put(__fut);
+
+        pthread_mutex_lock(&__pool->__lock);
+        __pool->__active--;
+        __pool->__completed++;
+        __pool->__run_ns += __run;
+        if(__run > __pool->__run_max_ns)
+            __pool->__run_max_ns = __run;
+    }
+    pthread_mutex_unlock(&__pool->__lock);
+
+    return NULL;
+}
+
+/**
+ * @name    __tpool_worker_release
+ * @brief   回收一个工作线程：join（当前线程自身则改为分离）并释放其 __thd_t。
+ */
+static void __tpool_worker_release(__thd_t *__pthd)
+{
+    /* 经 __thread_detach 分离，池化的栈交给栈池在线程退出后回收 */
+    if(pthread_equal(__pthd->__id ,pthread_self()))
+        __thread_detach(__pthd);
+    else
+        __thread_join(__pthd ,NULL);
+
+    __thread_attr_destroy(__pthd);
+    __thread_free(&__pthd);
+}
+
+/*****************************************************************************************/
+/*                                     接口函数                                           */
+/*****************************************************************************************/
+
+/**
+ * @func   __tpool_init
+ * @brief  创建线程池并启动全部工作线程
+ *
+ * @param[in] __name      线程池名称，不能为空，超过 11 字符截断
+ * @param[in] __nworkers  工作线程数，<=0 时取 TPOOL_WORKERS_DEFAULT
+ * @param[in] __qcap      任务队列容量，0 时取 TPOOL_QUEUE_DEFAULT
+ * @param[in] __tmpl      工作线程属性模板，可为 NULL（使用系统默认属性）；
+ *                        使用其 __op、__policy、__inheritsched、__param、__stack_sz、__placement、__cpuset 字段
+ *
+ * @retval __tpool_t*  成功返回线程池指针
+ * @retval NULL        参数非法、内存不足或工作线程创建失败
+ *
+ * @details
+ *  每个工作线程都是一个 __thd_t，按模板设置调度与栈属性后交给 __thread_create 创建。
+ *  模板要求实时调度但进程无权限（EPERM）时，向 stderr 打印提示并退回默认调度重试，
+ *  保证在开发主机上也能正常运行；其余创建错误会回收已启动的线程并返回 NULL。
+ *
+ * @note
+ *  - THREAD_OP_DETACHED 与 __stack_addr 会被忽略：线程池需要 join 工作线程，且多个线程不能共用一块栈；
+ *  - 返回的线程池应通过 __tpool_free() 释放。
+ */
+__tpool_t *__tpool_init(const char *__name ,int __nworkers ,unsigned __qcap ,const __thd_t *__tmpl)
+{
+    if(__name == NULL)
+        return NULL;
+    if(__nworkers <= 0)
+        __nworkers = TPOOL_WORKERS_DEFAULT;
+    if(__qcap == 0)
+        __qcap = TPOOL_QUEUE_DEFAULT;
+
+    __tpool_t *__pool = (__tpool_t *)calloc(1 ,sizeof(__tpool_t));
+    if(__pool == NULL)
+        return NULL;
+
+    strncpy(__pool->__name ,__name ,sizeof(__pool->__name) - 1);
+    __pool->__nworkers = __nworkers;
+    __pool->__cap = __qcap;
+    __pool->__state = TPOOL_RUNNING;
+    __pool->__queue = (__tpool_future_t **)calloc(__qcap ,sizeof(__tpool_future_t *));
+    __pool->__workers = (__thd_t **)calloc(__nworkers ,sizeof(__thd_t *));
+    if(__pool->__queue == NULL || __pool->__workers == NULL)
+        goto __err_mem;
+
+    if(pthread_mutex_init(&__pool->__lock ,NULL) != 0)
+        goto __err_mem;
+    if(__tpool_cond_init(&__pool->__not_empty) != 0)
+        goto __err_lock;
+    if(__tpool_cond_init(&__pool->__not_full) != 0)
+        goto __err_cond;
+
+    for(int __i = 0; __i < __nworkers; __i++)
+    {
+        char __tname[32];
+        snprintf(__tname ,sizeof(__tname) ,"%s-%d" ,__pool->__name ,__i);
+
+        __thd_t *__pthd = __thread_init(__tname);
+        if(__pthd == NULL)
+            break;
+
+        if(__tmpl != NULL)
+        {
+            __pthd->__op = __tmpl->__op & ~THREAD_OP_DETACHED;
+            __pthd->__policy = __tmpl->__policy;
+            __pthd->__inheritsched = __tmpl->__inheritsched;
+            __pthd->__param = __tmpl->__param;
+            __pthd->__stack_sz = __tmpl->__stack_sz;
+            __pthd->__placement = __tmpl->__placement;
+            __pthd->__cpuset = __tmpl->__cpuset;
+        }
+        __pthd->__stack_addr = NULL;
+        __pthd->__start_routine = __tpool_worker;
+        __pthd->__data = __pool;
+
+        int __ret = __thread_create(__pthd);
+        if(__ret == EPERM && (__pthd->__op & THREAD_OP_REALTIME) == THREAD_OP_REALTIME)
+        {
+            fprintf(stderr ,"%s: no permission for realtime policy ,fall back to default scheduling\n" ,__pthd->__name);
+            __thread_attr_destroy(__pthd);
+            __pthd->__op &= ~THREAD_OP_REALTIME;
+            __ret = __thread_create(__pthd);
+        }
+        if(__ret != 0)
+        {
+            __thread_attr_destroy(__pthd);
+            __thread_free(&__pthd);
+            break;
+        }
+
+        __pool->__workers[__i] = __pthd;
+        __pool->__started++;
+    }
+
+    if(__pool->__started != __nworkers)
+    {
+        __tpool_free(&__pool);
+        return NULL;
+    }
+    return __pool;
+
+__err_cond:
+    pthread_cond_destroy(&__pool->__not_empty);
+__err_lock:
+    pthread_mutex_destroy(&__pool->__lock);
+__err_mem:
+    free(__pool->__workers);
+    free(__pool->__queue);
+    free(__pool);
+    return NULL;
+}
+
+/**
+ * @func   __tpool_submit
+ * @brief  提交任务到线程池
+ *
+ * @param[in] __pool        线程池指针，不能为空
+ * @param[in] __fn          任务函数，不能为空
+ * @param[in] __arg         传给任务函数的参数
+ * @param[in] __timeout_ms  队列满时的等待时间：<0 一直等待，0 立即返回，>0 最多等待的毫秒数
+ *
+ * @retval __tpool_future_t*  成功返回任务句柄，用完需 __tpool_future_free()
+ * @retval NULL               失败，errno 为 EINVAL（参数非法）、ENOMEM（内存不足）、
+ *                            EAGAIN（队列满且等待超时）或 ESHUTDOWN（线程池已关闭）
+ *
+ * @note
+ *  - 不关心结果的调用者可在提交后立即 __tpool_future_free()，任务照常执行；
+ *  - 任务函数中不要调用 pthread_exit/__thread_exit，否则会带走工作线程。
+ */
+__tpool_future_t *__tpool_submit(__tpool_t *__pool ,__tpool_fn_t __fn ,void *__arg ,int __timeout_ms)
+{
+    if(__pool == NULL || __fn == NULL)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    __tpool_future_t *__fut = __tpool_future_new(__fn ,__arg);
+    if(__fut == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    struct timespec __ts;
+    if(__timeout_ms > 0)
+        __tpool_deadline(&__ts ,__timeout_ms);
+
+    pthread_mutex_lock(&__pool->__lock);
+    while(__pool->__count == __pool->__cap && __pool->__state == TPOOL_RUNNING)
+    {
+        if(__timeout_ms == 0)
+            break;
+        if(__timeout_ms < 0)
+            pthread_cond_wait(&__pool->__not_full ,&__pool->__lock);
+        else if(pthread_cond_timedwait(&__pool->__not_full ,&__pool->__lock ,&__ts) == ETIMEDOUT)
+            break;
+    }
+
+    if(__pool->__state != TPOOL_RUNNING || __pool->__count == __pool->__cap)
+    {
+        int __err = (__pool->__state != TPOOL_RUNNING) ? ESHUTDOWN : EAGAIN;
+        __pool->__rejected++;
+        pthread_mutex_unlock(&__pool->__lock);
+
+        __fut->__refs = 1;
+        __tpool_future_put(__fut);
+        errno = __err;
+        return NULL;
+    }
+
+    __fut->__t_submit = __tpool_now_ns();
+    __pool->__queue[(__pool->__head + __pool->__count) % __pool->__cap] = __fut;
+    __pool->__count++;
+    __pool->__submitted++;
+    if(__pool->__count > __pool->__depth_max)
+        __pool->__depth_max = __pool->__count;
+
+    pthread_cond_signal(&__pool->__not_empty);
+    pthread_mutex_unlock(&__pool->__lock);
+
+    return __fut;
+}
+
+/**
+ * @func   __tpool_future_timedwait
+ * @brief  限时等待任务结束并取回结果
+ *
+ * @param[in]  __fut         任务句柄，不能为空
+ * @param[out] __ret         任务返回值，可为 NULL
+ * @param[in]  __timeout_ms  <0 一直等待，0 仅查询，>0 最多等待的毫秒数
+ *
+ * @return
+ *   -  0         ：任务已完成，结果写入 __ret；
+ *   - -1         ：参数非法；
+ *   - ETIMEDOUT  ：超时仍未完成（句柄依然有效，可再次等待）；
+ *   - ECANCELED  ：任务在线程池非排空关闭时被丢弃，未执行。
+ */
+int __tpool_future_timedwait(__tpool_future_t *__fut ,void **__ret ,int __timeout_ms)
+{
+    if(__fut == NULL)
+        return -1;
+
+    struct timespec __ts;
+    if(__timeout_ms > 0)
+        __tpool_deadline(&__ts ,__timeout_ms);
+
+    int __rc = 0;
+    pthread_mutex_lock(&__fut->__lock);
+    while(__fut->__state < TPOOL_FUT_DONE)
+    {
+        if(__timeout_ms == 0)
+        {
+            __rc = ETIMEDOUT;
+            break;
+        }
+        if(__timeout_ms < 0)
+            pthread_cond_wait(&__fut->__cond ,&__fut->__lock);
+        else if(pthread_cond_timedwait(&__fut->__cond ,&__fut->__lock ,&__ts) == ETIMEDOUT)
+        {
+            __rc = (__fut->__state < TPOOL_FUT_DONE) ? ETIMEDOUT : 0;
+            break;
+        }
+    }
+
+    if(__rc == 0)
+    {
+        if(__fut->__state == TPOOL_FUT_CANCELLED)
+            __rc = ECANCELED;
+        else if(__ret != NULL)
+            *__ret = __fut->__ret;
+    }
+    pthread_mutex_unlock(&__fut->__lock);
+
+    return __rc;
+}
+
+/**
+ * @func   __tpool_future_wait
+ * @brief  阻塞等待任务结束并取回结果
+ *
+ * @return 同 __tpool_future_timedwait（不会返回 ETIMEDOUT）。
+ */
+int __tpool_future_wait(__tpool_future_t *__fut ,void **__ret)
+{
+    return __tpool_future_timedwait(__fut ,__ret ,-1);
+}
+
+/**
+ * @func   __tpool_future_state
+ * @brief  非阻塞查询任务状态
+ *
+ * @return tpool_fut_state_t；参数非法返回 -1。
+ */
+int __tpool_future_state(__tpool_future_t *__fut)
+{
+    if(__fut == NULL)
+        return -1;
+    return __atomic_load_n(&__fut->__state ,__ATOMIC_ACQUIRE);
+}
+
+/**
+ * @func   __tpool_future_free
+ * @brief  释放调用者持有的任务句柄并置空
+ *
+ * @note
+ *  任务尚未执行完时释放句柄是安全的，任务照常执行，结果被丢弃。
+ */
+void __tpool_future_free(__tpool_future_t **__fut)
+{
+    if(__fut == NULL || (*__fut) == NULL)
+        return;
+
+    __tpool_future_put(*__fut);
+    (*__fut) = NULL;
+}
+
+/**
+ * @func   __tpool_stat
+ * @brief  获取线程池计数快照
+ *
+ * @param[in]  __pool  线程池指针，不能为空
+ * @param[out] __st    计数快照，不能为空
+ *
+ * @return 0 成功；-1 参数非法。
+ */
+int __tpool_stat(__tpool_t *__pool ,__tpool_stat_t *__st)
+{
+    if(__pool == NULL || __st == NULL)
+        return -1;
+
+    pthread_mutex_lock(&__pool->__lock);
+    __st->__submitted = __pool->__submitted;
+    __st->__completed = __pool->__completed;
+    __st->__rejected = __pool->__rejected;
+    __st->__cancelled = __pool->__cancelled;
+    __st->__depth = __pool->__count;
+    __st->__depth_max = __pool->__depth_max;
+    __st->__active = __pool->__active;
+    __st->__wait_max_ns = __pool->__wait_max_ns;
+    __st->__run_max_ns = __pool->__run_max_ns;
+
+    /* 排队时间在出队时累计，执行时间在完成时累计，分母分别取对应的任务数 */
+    uint64_t __started = __pool->__completed + __pool->__active;
+    __st->__wait_avg_ns = __started ? __pool->__wait_ns / __started : 0;
+    __st->__run_avg_ns = __pool->__completed ? __pool->__run_ns / __pool->__completed : 0;
+    pthread_mutex_unlock(&__pool->__lock);
+
+    return 0;
+}
+
+/**
+ * @func   __tpool_shutdown
+ * @brief  关闭线程池：停止接收任务并回收全部工作线程
+ *
+ * @param[in] __pool   线程池指针，不能为空
+ * @param[in] __drain  非 0：执行完队列中剩余任务后退出；
+ *                     0  ：丢弃队列中剩余任务（对应 future 返回 ECANCELED），只等正在执行的任务
+ *
+ * @return 0 成功；-1 参数非法。
+ *
+ * @details
+ *  被背压阻塞的提交者会被唤醒并以 ESHUTDOWN 失败。可重复调用，
+ *  已处于排空关闭时再以 __drain=0 调用会升级为丢弃关闭。
+ *  在工作线程内调用（例如任务中调用 exit() 触发进程退出处理）时，
+ *  该工作线程不会 join 自身，而是改为分离。
+ */
+int __tpool_shutdown(__tpool_t *__pool ,int __drain)
+{
+    if(__pool == NULL)
+        return -1;
+
+    pthread_mutex_lock(&__pool->__lock);
+    if(__pool->__state == TPOOL_RUNNING)
+        __pool->__state = __drain ? TPOOL_DRAINING : TPOOL_ABORTING;
+    else if(!__drain)
+        __pool->__state = TPOOL_ABORTING;
+
+    if(__pool->__state == TPOOL_ABORTING)
+    {
+        while(__pool->__count > 0)
+        {
+            __tpool_future_t *__fut = __pool->__queue[__pool->__head];
+            __pool->__queue[__pool->__head] = NULL;
+            __pool->__head = (__pool->__head + 1) % __pool->__cap;
+            __pool->__count--;
+            __pool->__cancelled++;
+
+            __tpool_future_finish(__fut ,TPOOL_FUT_CANCELLED ,NULL);
+            __tpool_future_put(__fut);
+        }
+    }
+    pthread_cond_broadcast(&__pool->__not_empty);
+    pthread_cond_broadcast(&__pool->__not_full);
+
+    /* 取走工作线程表，重复调用时不会重复 join */
+    int __started = __pool->__started;
+    __pool->__started = 0;
+    pthread_mutex_unlock(&__pool->__lock);
+
+    for(int __i = 0; __i < __started; __i++)
+    {
+        __tpool_worker_release(__pool->__workers[__i]);
+        __pool->__workers[__i] = NULL;
+    }
+
+    return 0;
+}
+
+/**
+ * @func   __tpool_free
+ * @brief  排空关闭线程池并释放全部资源，随后将指针置空
+ *
+ * @param[in,out] __pool  指向线程池指针的地址
+ */
+void __tpool_free(__tpool_t **__pool)
+{
+    if(__pool == NULL || (*__pool) == NULL)
+        return;
+
+    __tpool_t *__p = *__pool;
+    __tpool_shutdown(__p ,1);
+
+    pthread_cond_destroy(&__p->__not_full);
+    pthread_cond_destroy(&__p->__not_empty);
+    pthread_mutex_destroy(&__p->__lock);
+    free(__p->__workers);
+    free(__p->__queue);
+    free(__p);
+
+    (*__pool) = NULL;
+}
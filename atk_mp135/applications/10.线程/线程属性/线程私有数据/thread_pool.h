@@ -0,0 +1,155 @@
+/**
+ * @file    thread_pool.h
+ * @brief   基于 __thd_t 的固定大小工作线程池接口定义
+ *
+ * @details
+ * 本头文件定义了固定数量工作线程 + 有界任务队列 + future 的线程池，
+ * 工作线程全部通过 __thread_init/__thread_create 创建，因此沿用 __thd_t 的属性开关：
+ *  - 调度策略、继承方式与优先级（THREAD_OP_REALTIME + __policy/__inheritsched/__param）；
+ *  - 栈大小（THREAD_OP_STACKSIZE + __stack_sz）；
+ *  - CPU 放置（THREAD_OP_CPUAFFINITY + __placement/__cpuset），SPREAD/COMPACT 下每个工作线程各取一个 CPU。
+ *
+ * 主要内容：
+ *  - __tpool_future_t：任务句柄，submit 返回，可阻塞等待或限时等待任务结果；
+ *  - __tpool_t       ：线程池本体，环形有界队列，满时按超时参数阻塞/立即失败；
+ *  - __tpool_stat_t  ：队列深度、排队延迟、执行耗时等计数快照。
+ *
+ * 使用流程：
+ *  1. __tpool_init() 按模板线程属性创建线程池；
+ *  2. __tpool_submit() 提交任务，得到 future；
+ *  3. __tpool_future_wait()/__tpool_future_timedwait() 取结果，__tpool_future_free() 释放句柄；
+ *  4. __tpool_shutdown() 排空（或丢弃）剩余任务并回收工作线程，__tpool_free() 释放线程池。
+ *
+ * @note
+ * - 工作线程由线程池自己 join，模板中的 THREAD_OP_DETACHED 与 __stack_addr 会被忽略；
+ * - 在工作线程内以阻塞方式向同一线程池提交任务、或等待同一线程池中的 future，
+ *   在队列满/工作线程耗尽时可能死锁，应使用带超时的提交与等待。
+ */
+#ifndef __THREAD_POOL_H
+#define __THREAD_POOL_H
+
+#include "thread.h"
+
+#define TPOOL_WORKERS_DEFAULT   (4)      ///< 默认工作线程数
+#define TPOOL_QUEUE_DEFAULT     (256)    ///< 默认任务队列容量
+#define TPOOL_STACK_DEFAULT     (256 * 1024) ///< 默认工作线程栈大小（init.c 使用）
+
+/**
+ * @typedef __tpool_fn_t
+ * @brief   任务函数类型，返回值通过 future 交给等待者
+ */
+typedef void *(*__tpool_fn_t)(void *__arg);
+
+/**
+ * @enum   tpool_fut_state_t
+ * @brief  future 状态
+ */
+typedef enum
+{
+    TPOOL_FUT_PENDING   = 0,    ///< 在队列中等待执行
+    TPOOL_FUT_RUNNING   = 1,    ///< 正在被工作线程执行
+    TPOOL_FUT_DONE      = 2,    ///< 执行完成，结果可取
+    TPOOL_FUT_CANCELLED = 3     ///< 未执行即被丢弃（非排空关闭）
+}tpool_fut_state_t;
+
+/**
+ * @enum   tpool_state_t
+ * @brief  线程池运行状态
+ */
+typedef enum
+{
+    TPOOL_RUNNING  = 0,         ///< 正常接收任务
+    TPOOL_DRAINING = 1,         ///< 拒绝新任务，执行完队列中剩余任务后退出
+    TPOOL_ABORTING = 2          ///< 拒绝新任务，丢弃队列中剩余任务后退出
+}tpool_state_t;
+
+/**
+ * @struct __tpool_future_struct
+ * @brief  任务句柄
+ *
+ * @details
+ * 由 __tpool_submit 分配，线程池与调用者各持有一份引用，
+ * 任务结束且调用者调用 __tpool_future_free 后才真正释放。
+ */
+struct __tpool_future_struct
+{
+    pthread_mutex_t __lock;     ///< 保护 __state/__ret
+    pthread_cond_t __cond;      ///< 任务结束时广播
+    int __state;                ///< tpool_fut_state_t
+    int __refs;                 ///< 引用计数（线程池 + 调用者）
+    void *__ret;                ///< 任务返回值
+
+    __tpool_fn_t __fn;          ///< 任务函数
+    void *__arg;                ///< 任务参数
+    uint64_t __t_submit;        ///< 入队时刻（CLOCK_MONOTONIC，纳秒）
+};
+typedef struct __tpool_future_struct __tpool_future_t;
+
+/**
+ * @struct __tpool_stat_t
+ * @brief  线程池计数快照（__tpool_stat 填充）
+ *
+ * @details
+ * wait 为提交到开始执行的排队时间，run 为任务函数执行时间，单位纳秒。
+ */
+typedef struct
+{
+    uint64_t __submitted;       ///< 成功入队的任务数
+    uint64_t __completed;       ///< 执行完成的任务数
+    uint64_t __rejected;        ///< 队列满超时或线程池已关闭而被拒绝的提交数
+    uint64_t __cancelled;       ///< 非排空关闭时被丢弃的任务数
+    unsigned __depth;           ///< 当前队列深度
+    unsigned __depth_max;       ///< 历史最大队列深度
+    unsigned __active;          ///< 正在执行任务的工作线程数
+    uint64_t __wait_avg_ns;     ///< 平均排队时间
+    uint64_t __wait_max_ns;     ///< 最大排队时间
+    uint64_t __run_avg_ns;      ///< 平均执行时间
+    uint64_t __run_max_ns;      ///< 最大执行时间
+}__tpool_stat_t;
+
+/**
+ * @struct __tpool_struct
+ * @brief  线程池（内部使用）
+ */
+struct __tpool_struct
+{
+    char __name[12];            ///< 线程池名称，工作线程命名为 "<name>-<i>"
+    int __nworkers;             ///< 工作线程数
+    int __started;              ///< 实际创建成功的工作线程数
+    __thd_t **__workers;        ///< 工作线程结构体
+
+    __tpool_future_t **__queue; ///< 环形任务队列
+    unsigned __cap;             ///< 队列容量
+    unsigned __head;            ///< 队头下标
+    unsigned __count;           ///< 队列中任务数
+
+    pthread_mutex_t __lock;     ///< 保护队列、状态与计数
+    pthread_cond_t __not_empty; ///< 有任务或状态改变
+    pthread_cond_t __not_full;  ///< 有空位或状态改变
+    int __state;                ///< tpool_state_t
+
+    unsigned __active;          ///< 正在执行任务的工作线程数
+    unsigned __depth_max;
+    uint64_t __submitted;
+    uint64_t __completed;
+    uint64_t __rejected;
+    uint64_t __cancelled;
+    uint64_t __wait_ns;         ///< 排队时间累计
+    uint64_t __wait_max_ns;
+    uint64_t __run_ns;          ///< 执行时间累计
+    uint64_t __run_max_ns;
+};
+typedef struct __tpool_struct __tpool_t;
+
+/* 接口函数声明 */
+__tpool_t *__tpool_init(const char *__name ,int __nworkers ,unsigned __qcap ,const __thd_t *__tmpl);
+__tpool_future_t *__tpool_submit(__tpool_t *__pool ,__tpool_fn_t __fn ,void *__arg ,int __timeout_ms);
+int __tpool_future_wait(__tpool_future_t *__fut ,void **__ret);
+int __tpool_future_timedwait(__tpool_future_t *__fut ,void **__ret ,int __timeout_ms);
+int __tpool_future_state(__tpool_future_t *__fut);
+void __tpool_future_free(__tpool_future_t **__fut);
+int __tpool_stat(__tpool_t *__pool ,__tpool_stat_t *__st);
+int __tpool_shutdown(__tpool_t *__pool ,int __drain);
+void __tpool_free(__tpool_t **__pool);
+
+#endif /* __THREAD_POOL_H */
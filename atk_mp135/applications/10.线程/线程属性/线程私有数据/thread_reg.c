@@ -0,0 +1,609 @@
+/**
+ * @file    thread_reg.c
+ * @brief   并发安全的线程注册表实现
+ *
+ * @details
+ * 读写分离：
+ *  - 写者持 __lock 修改哈希链与遍历链，新节点先初始化完整再以 release 语义挂入；
+ *    摘除节点时只改前驱的指针，不改被摘节点自身的后继指针，
+ *    因此正停在该节点上的读者仍能沿原链继续前进；
+ *  - 读者不加锁，以 acquire 语义沿链读取。
+ *
+ * 回收（epoch-based reclamation）：
+ *  - 全局纪元 __treg_epoch；每个读线程一条记录，进入读临界区时发布 (纪元 << 1) | 1；
+ *  - 删除的节点记下当时的全局纪元后挂入 __retired；
+ *  - 写者每次删除后尝试推进纪元：所有活跃记录都已处于当前纪元时才加一；
+ *    节点在全局纪元超过其删除纪元 2 之后才释放，此时不可能还有读者持有它。
+ * 纪元域为全进程共享，一个线程可在同一临界区内访问多个注册表。
+ */
+#include "thread_reg.h"
+#include <stddef.h>
+
+/**
+ * @struct __treg_rec
+ * @brief  读线程的纪元记录，线程退出后可被其他线程复用，永不释放
+ */
+struct __treg_rec
+{
+    uint64_t __epoch;           ///< 活跃时为 (纪元 << 1) | 1，空闲时为 0
+    int __nest;                 ///< 读临界区嵌套深度（仅本线程访问）
+    int __used;                 ///< 是否已被某个线程占用
+    struct __treg_rec *__next;  ///< 全部记录链（只增不减）
+};
+
+static void __treg_tls_init(void);
+static void __treg_rec_release(void *__arg);
+
+static uint64_t __treg_epoch = 0;                       ///< 全局纪元
+static struct __treg_rec *__treg_recs = NULL;           ///< 全部读记录
+static __thread struct __treg_rec *__treg_my = NULL;    ///< 当前线程的读记录
+static int __treg_tls_ok = 0;
+static __thd_tls_t __treg_tls = {
+    .__destructor = __treg_rec_release,
+    .__once = { PTHREAD_ONCE_INIT ,__treg_tls_init }
+};
+
+/*****************************************************************************************/
+/*                                     纪元与回收                                         */
+/*****************************************************************************************/
+
+/**
+ * @name    __treg_tls_init
+ * @brief   创建读记录的 TLS 键（只执行一次），线程退出时由析构函数归还记录。
+ */
+static void __treg_tls_init(void)
+{
+    __treg_tls_ok = (__thread_key_create(&__treg_tls) == 0);
+}
+
+/**
+ * @name    __treg_rec_release
+ * @brief   TLS 析构函数：线程退出时清除活跃标记并归还记录。
+ */
+static void __treg_rec_release(void *__arg)
+{
+    struct __treg_rec *__rec = (struct __treg_rec *)__arg;
+    __rec->__nest = 0;
+    __atomic_store_n(&__rec->__epoch ,0 ,__ATOMIC_RELEASE);
+    __atomic_store_n(&__rec->__used ,0 ,__ATOMIC_RELEASE);
+}
+
+/**
+ * @name    __treg_rec_get
+ * @brief   取当前线程的读记录，首次调用时复用空闲记录或新建一条。
+ *
+ * @return  记录指针；内存不足返回 NULL。
+ */
+static struct __treg_rec *__treg_rec_get(void)
+{
+    if(__treg_my != NULL)
+        return __treg_my;
+
+    struct __treg_rec *__rec;
+    for(__rec = __atomic_load_n(&__treg_recs ,__ATOMIC_ACQUIRE); __rec != NULL; __rec = __rec->__next)
+    {
+        int __free = 0;
+        if(__atomic_compare_exchange_n(&__rec->__used ,&__free ,1 ,0 ,__ATOMIC_ACQ_REL ,__ATOMIC_RELAXED))
+            break;
+    }
+
+    if(__rec == NULL)
+    {
+        __rec = (struct __treg_rec *)calloc(1 ,sizeof(struct __treg_rec));
+        if(__rec == NULL)
+            return NULL;
+        __rec->__used = 1;
+        __rec->__next = __atomic_load_n(&__treg_recs ,__ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&__treg_recs ,&__rec->__next ,__rec ,1 ,__ATOMIC_RELEASE ,__ATOMIC_RELAXED))
+            ;
+    }
+
+    __thread_once(&__treg_tls.__once);
+    if(__treg_tls_ok)
+        __thread_key_setspecific(&__treg_tls ,__rec);
+    __treg_my = __rec;
+    return __rec;
+}
+
+/**
+ * @name    __treg_try_advance
+ * @brief   所有活跃读者都已观察到当前纪元时推进全局纪元（调用者持有写锁）。
+ */
+static void __treg_try_advance(void)
+{
+    uint64_t __g = __atomic_load_n(&__treg_epoch ,__ATOMIC_SEQ_CST);
+    for(struct __treg_rec *__rec = __atomic_load_n(&__treg_recs ,__ATOMIC_ACQUIRE); __rec != NULL; __rec = __rec->__next)
+    {
+        uint64_t __v = __atomic_load_n(&__rec->__epoch ,__ATOMIC_SEQ_CST);
+        if((__v & 1) && (__v >> 1) != __g)
+            return;
+    }
+    __atomic_store_n(&__treg_epoch ,__g + 1 ,__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @name    __treg_node_free
+ * @brief   释放节点及其拥有的线程结构体。
+ */
+static void __treg_node_free(struct __treg_node *__nd)
+{
+    __thread_free(&__nd->__pthd);
+    free(__nd);
+}
+
+/**
+ * @name    __treg_reclaim
+ * @brief   推进纪元并释放已过宽限期的节点（调用者持有写锁）。
+ */
+static void __treg_reclaim(__treg_t *__preg)
+{
+    __treg_try_advance();
+    uint64_t __g = __atomic_load_n(&__treg_epoch ,__ATOMIC_SEQ_CST);
+
+    struct __treg_node **__pp = &__preg->__retired;
+    while(*__pp != NULL)
+    {
+        struct __treg_node *__nd = *__pp;
+        if(__nd->__retire + 2 <= __g)
+        {
+            *__pp = __nd->__next_free;
+            __treg_node_free(__nd);
+        }
+        else
+        {
+            __pp = &__nd->__next_free;
+        }
+    }
+}
+
+/*****************************************************************************************/
+/*                                     哈希与链表                                         */
+/*****************************************************************************************/
+
+/**
+ * @name    __treg_hash_name
+ * @brief   FNV-1a 名称哈希。
+ */
+static uint32_t __treg_hash_name(const char *__name)
+{
+    uint32_t __h = 2166136261u;
+    while(*__name != '\0')
+    {
+        __h ^= (uint8_t)*__name++;
+        __h *= 16777619u;
+    }
+    return __h;
+}
+
+/**
+ * @name    __treg_hash_id
+ * @brief   pthread_t 哈希（乘法散列，取高位）。
+ */
+static uint32_t __treg_hash_id(pthread_t __id)
+{
+    return (uint32_t)(((uint64_t)__id * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/**
+ * @name    __treg_lookup_name
+ * @brief   按名称查找节点（读者在临界区内调用，写者持锁调用）。
+ */
+static struct __treg_node *__treg_lookup_name(__treg_t *__preg ,const char *__name)
+{
+    uint32_t __h = __treg_hash_name(__name);
+    struct __treg_node *__nd = __atomic_load_n(&__preg->__by_name[__h & (TREG_BUCKETS - 1)] ,__ATOMIC_ACQUIRE);
+    for(; __nd != NULL; __nd = __atomic_load_n(&__nd->__next_name ,__ATOMIC_ACQUIRE))
+    {
+        if(__nd->__hname == __h && strcmp(__nd->__name ,__name) == 0 && !__atomic_load_n(&__nd->__dead ,__ATOMIC_ACQUIRE))
+            return __nd;
+    }
+    return NULL;
+}
+
+/**
+ * @name    __treg_unlink
+ * @brief   在单链表中摘除 __nd，只改前驱的后继指针（调用者持有写锁）。
+ *
+ * @param[in] __head    链表头地址
+ * @param[in] __nd      待摘除节点
+ * @param[in] __offset  后继指针在节点中的偏移
+ */
+static void __treg_unlink(struct __treg_node **__head ,struct __treg_node *__nd ,size_t __offset)
+{
+    struct __treg_node **__pp = __head;
+    while(*__pp != NULL)
+    {
+        if(*__pp == __nd)
+        {
+            struct __treg_node *__next = *(struct __treg_node **)((char *)__nd + __offset);
+            __atomic_store_n(__pp ,__next ,__ATOMIC_RELEASE);
+            return;
+        }
+        __pp = (struct __treg_node **)((char *)(*__pp) + __offset);
+    }
+}
+
+/**
+ * @name    __treg_remove
+ * @brief   把节点从全部索引中摘除并挂入待回收链（调用者持有写锁）。
+ */
+static void __treg_remove(__treg_t *__preg ,struct __treg_node *__nd)
+{
+    __atomic_store_n(&__nd->__dead ,1 ,__ATOMIC_RELEASE);
+
+    __treg_unlink(&__preg->__by_name[__nd->__hname & (TREG_BUCKETS - 1)] ,__nd ,offsetof(struct __treg_node ,__next_name));
+    if(__nd->__id != 0)
+        __treg_unlink(&__preg->__by_id[__treg_hash_id(__nd->__id) & (TREG_BUCKETS - 1)] ,__nd ,offsetof(struct __treg_node ,__next_id));
+
+    /* 遍历链为双向（前驱仅写者使用），O(1) 摘除 */
+    if(__nd->__prev_all != NULL)
+        __atomic_store_n(&__nd->__prev_all->__next_all ,__nd->__next_all ,__ATOMIC_RELEASE);
+    else
+        __atomic_store_n(&__preg->__all ,__nd->__next_all ,__ATOMIC_RELEASE);
+    if(__nd->__next_all != NULL)
+        __nd->__next_all->__prev_all = __nd->__prev_all;
+    else
+        __preg->__all_tail = __nd->__prev_all;
+
+    __preg->__count--;
+    __nd->__retire = __atomic_load_n(&__treg_epoch ,__ATOMIC_SEQ_CST);
+    __nd->__next_free = __preg->__retired;
+    __preg->__retired = __nd;
+
+    __treg_reclaim(__preg);
+}
+
+/*****************************************************************************************/
+/*                                     接口函数                                           */
+/*****************************************************************************************/
+
+/**
+ * @func   __treg_init
+ * @brief  创建空的线程注册表
+ *
+ * @retval __treg_t*  成功返回注册表指针
+ * @retval NULL       内存分配失败
+ */
+__treg_t *__treg_init(void)
+{
+    __treg_t *__preg = (__treg_t *)calloc(1 ,sizeof(__treg_t));
+    if(__preg == NULL)
+        return NULL;
+
+    if(pthread_mutex_init(&__preg->__lock ,NULL) != 0)
+    {
+        free(__preg);
+        return NULL;
+    }
+    return __preg;
+}
+
+/**
+ * @func   __treg_free
+ * @brief  释放注册表、全部节点及其线程结构体，并将指针置空
+ *
+ * @note
+ *  调用者需保证此时已没有其他线程访问该注册表（通常在进程退出时调用），
+ *  因此待回收链上尚未过宽限期的节点也在此一并释放。
+ */
+void __treg_free(__treg_t **__preg)
+{
+    if(__preg == NULL || (*__preg) == NULL)
+        return;
+
+    __treg_t *__p = *__preg;
+    struct __treg_node *__nd = __p->__all;
+    while(__nd != NULL)
+    {
+        struct __treg_node *__next = __nd->__next_all;
+        __treg_node_free(__nd);
+        __nd = __next;
+    }
+    __nd = __p->__retired;
+    while(__nd != NULL)
+    {
+        struct __treg_node *__next = __nd->__next_free;
+        __treg_node_free(__nd);
+        __nd = __next;
+    }
+
+    pthread_mutex_destroy(&__p->__lock);
+    free(__p);
+    (*__preg) = NULL;
+}
+
+/**
+ * @func   __treg_add
+ * @brief  把线程结构体加入注册表
+ *
+ * @param[in] __preg  注册表指针，不能为空
+ * @param[in] __pthd  线程结构体，不能为空，名称在注册表内必须唯一
+ *
+ * @return 0 成功；-1 参数非法、名称重复或内存不足。
+ *
+ * @details
+ *  总是按名称索引；__pthd->__id 非 0（线程已创建）时同时按线程 ID 索引，
+ *  否则需在 __thread_create 之后调用 __treg_bind_id 补充。
+ *  成功后 __pthd 归注册表所有。
+ */
+int __treg_add(__treg_t *__preg ,__thd_t *__pthd)
+{
+    if(__preg == NULL || __pthd == NULL || __pthd->__name[0] == '\0')
+        return -1;
+
+    struct __treg_node *__nd = (struct __treg_node *)calloc(1 ,sizeof(struct __treg_node));
+    if(__nd == NULL)
+        return -1;
+
+    __nd->__pthd = __pthd;
+    strncpy(__nd->__name ,__pthd->__name ,sizeof(__nd->__name) - 1);
+    __nd->__hname = __treg_hash_name(__nd->__name);
+
+    pthread_mutex_lock(&__preg->__lock);
+    if(__treg_lookup_name(__preg ,__nd->__name) != NULL)
+    {
+        pthread_mutex_unlock(&__preg->__lock);
+        free(__nd);
+        return -1;
+    }
+
+    /* 先写好节点自身的链接，再以 release 语义发布 */
+    struct __treg_node **__bucket = &__preg->__by_name[__nd->__hname & (TREG_BUCKETS - 1)];
+    __nd->__next_name = *__bucket;
+    __atomic_store_n(__bucket ,__nd ,__ATOMIC_RELEASE);
+
+    if(__pthd->__id != 0)
+    {
+        __nd->__id = __pthd->__id;
+        __bucket = &__preg->__by_id[__treg_hash_id(__nd->__id) & (TREG_BUCKETS - 1)];
+        __nd->__next_id = *__bucket;
+        __atomic_store_n(__bucket ,__nd ,__ATOMIC_RELEASE);
+    }
+
+    __nd->__prev_all = __preg->__all_tail;
+    if(__preg->__all_tail != NULL)
+        __atomic_store_n(&__preg->__all_tail->__next_all ,__nd ,__ATOMIC_RELEASE);
+    else
+        __atomic_store_n(&__preg->__all ,__nd ,__ATOMIC_RELEASE);
+    __preg->__all_tail = __nd;
+    __preg->__count++;
+
+    /* 顺带回收之前删除留下的节点，避免最后一次删除的内存一直滞留 */
+    __treg_reclaim(__preg);
+    pthread_mutex_unlock(&__preg->__lock);
+
+    return 0;
+}
+
+/**
+ * @func   __treg_bind_id
+ * @brief  按 __pthd->__id 为已加入的线程补充 ID 索引
+ *
+ * @return 0 成功（或已按相同 ID 索引）；-1 参数非法、线程不在注册表中、ID 为 0 或已绑定其他 ID。
+ *
+ * @note
+ *  每个节点只绑定一次 ID：读者可能正停在节点上，改写其 ID 链指针会让读者走错链。
+ *  调用者需保证 __pthd 此时尚未被注销（线程未退出，或由该线程自己调用）。
+ */
+int __treg_bind_id(__treg_t *__preg ,__thd_t *__pthd)
+{
+    if(__preg == NULL || __pthd == NULL || __pthd->__id == 0)
+        return -1;
+
+    int __ret = -1;
+    pthread_mutex_lock(&__preg->__lock);
+    struct __treg_node *__nd = __treg_lookup_name(__preg ,__pthd->__name);
+    if(__nd != NULL && __nd->__pthd == __pthd)
+    {
+        if(__nd->__id == 0)
+        {
+            __nd->__id = __pthd->__id;
+            struct __treg_node **__bucket = &__preg->__by_id[__treg_hash_id(__nd->__id) & (TREG_BUCKETS - 1)];
+            __nd->__next_id = *__bucket;
+            __atomic_store_n(__bucket ,__nd ,__ATOMIC_RELEASE);
+            __ret = 0;
+        }
+        else if(pthread_equal(__nd->__id ,__pthd->__id))
+        {
+            __ret = 0;
+        }
+    }
+    pthread_mutex_unlock(&__preg->__lock);
+
+    return __ret;
+}
+
+/**
+ * @func   __treg_del
+ * @brief  从注册表删除线程，其 __thd_t 在宽限期后释放
+ *
+ * @return 0 成功；-1 参数非法或线程不在注册表中。
+ *
+ * @note
+ *  调用后调用者不应再访问 __pthd（线程自身注销后可继续使用到 pthread_exit 为止）。
+ */
+int __treg_del(__treg_t *__preg ,__thd_t *__pthd)
+{
+    if(__preg == NULL || __pthd == NULL)
+        return -1;
+
+    int __ret = -1;
+    pthread_mutex_lock(&__preg->__lock);
+    struct __treg_node *__nd = __treg_lookup_name(__preg ,__pthd->__name);
+    if(__nd != NULL && __nd->__pthd == __pthd)
+    {
+        __treg_remove(__preg ,__nd);
+        __ret = 0;
+    }
+    pthread_mutex_unlock(&__preg->__lock);
+
+    return __ret;
+}
+
+/**
+ * @func   __treg_del_name
+ * @brief  按名称删除线程
+ *
+ * @return 0 成功；-1 参数非法或未找到。
+ */
+int __treg_del_name(__treg_t *__preg ,const char *__name)
+{
+    if(__preg == NULL || __name == NULL)
+        return -1;
+
+    int __ret = -1;
+    pthread_mutex_lock(&__preg->__lock);
+    struct __treg_node *__nd = __treg_lookup_name(__preg ,__name);
+    if(__nd != NULL)
+    {
+        __treg_remove(__preg ,__nd);
+        __ret = 0;
+    }
+    pthread_mutex_unlock(&__preg->__lock);
+
+    return __ret;
+}
+
+/**
+ * @func   __treg_read_lock
+ * @brief  进入读临界区（可嵌套，不阻塞写者）
+ *
+ * @note   临界区内不应长时间阻塞，否则已删除节点迟迟不能回收。
+ */
+void __treg_read_lock(void)
+{
+    struct __treg_rec *__rec = __treg_rec_get();
+    if(__rec == NULL || __rec->__nest++ > 0)
+        return;
+
+    uint64_t __g = __atomic_load_n(&__treg_epoch ,__ATOMIC_SEQ_CST);
+    __atomic_store_n(&__rec->__epoch ,(__g << 1) | 1 ,__ATOMIC_SEQ_CST);
+    /* 活跃标记必须先于临界区内的任何读取对写者可见 */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * @func   __treg_read_unlock
+ * @brief  离开读临界区
+ */
+void __treg_read_unlock(void)
+{
+    struct __treg_rec *__rec = __treg_my;
+    if(__rec == NULL || __rec->__nest == 0)
+        return;
+
+    if(--__rec->__nest == 0)
+        __atomic_store_n(&__rec->__epoch ,0 ,__ATOMIC_RELEASE);
+}
+
+/**
+ * @func   __treg_find_name
+ * @brief  按名称查找线程（无锁）
+ *
+ * @return 线程结构体指针；未找到或参数非法返回 NULL。
+ *
+ * @note   返回值只在调用者自己的读临界区内有效，见 __treg_read_lock。
+ */
+__thd_t *__treg_find_name(__treg_t *__preg ,const char *__name)
+{
+    if(__preg == NULL || __name == NULL)
+        return NULL;
+
+    __treg_read_lock();
+    struct __treg_node *__nd = __treg_lookup_name(__preg ,__name);
+    __thd_t *__pthd = (__nd != NULL) ? __nd->__pthd : NULL;
+    __treg_read_unlock();
+
+    return __pthd;
+}
+
+/**
+ * @func   __treg_find_id
+ * @brief  按线程 ID 查找线程（无锁）
+ *
+ * @return 线程结构体指针；未找到或参数非法返回 NULL。
+ *
+ * @note   返回值只在调用者自己的读临界区内有效，见 __treg_read_lock。
+ */
+__thd_t *__treg_find_id(__treg_t *__preg ,pthread_t __id)
+{
+    if(__preg == NULL || __id == 0)
+        return NULL;
+
+    __thd_t *__pthd = NULL;
+    __treg_read_lock();
+    struct __treg_node *__nd = __atomic_load_n(&__preg->__by_id[__treg_hash_id(__id) & (TREG_BUCKETS - 1)] ,__ATOMIC_ACQUIRE);
+    for(; __nd != NULL; __nd = __atomic_load_n(&__nd->__next_id ,__ATOMIC_ACQUIRE))
+    {
+        if(pthread_equal(__nd->__id ,__id) && !__atomic_load_n(&__nd->__dead ,__ATOMIC_ACQUIRE))
+        {
+            __pthd = __nd->__pthd;
+            break;
+        }
+    }
+    __treg_read_unlock();
+
+    return __pthd;
+}
+
+/**
+ * @func   __treg_self
+ * @brief  查找当前线程自己的线程结构体（无锁）
+ *
+ * @return 线程结构体指针；当前线程未注册或尚未绑定 ID 返回 NULL。
+ *
+ * @note   线程只会被自己注销，因此返回值在本线程调用 __treg_del 之前一直有效。
+ */
+__thd_t *__treg_self(__treg_t *__preg)
+{
+    return __treg_find_id(__preg ,pthread_self());
+}
+
+/**
+ * @func   __treg_foreach
+ * @brief  按加入顺序遍历注册表中的线程（无锁）
+ *
+ * @param[in] __preg  注册表指针，不能为空
+ * @param[in] __fn    回调函数，返回非 0 时停止遍历
+ * @param[in] __arg   传给回调的参数
+ *
+ * @return 已回调的线程数；参数非法返回 -1。
+ *
+ * @details
+ *  整个遍历处于读临界区内：其他线程可同时退出并注销自己，遍历既不会访问到已释放的内存，
+ *  也不会因此中断；遍历开始后加入的线程可能被访问到，也可能访问不到。
+ *  回调中不要调用 __treg_free，也不要长时间阻塞。
+ */
+int __treg_foreach(__treg_t *__preg ,__treg_iter_t __fn ,void *__arg)
+{
+    if(__preg == NULL || __fn == NULL)
+        return -1;
+
+    int __n = 0;
+    __treg_read_lock();
+    struct __treg_node *__nd = __atomic_load_n(&__preg->__all ,__ATOMIC_ACQUIRE);
+    for(; __nd != NULL; __nd = __atomic_load_n(&__nd->__next_all ,__ATOMIC_ACQUIRE))
+    {
+        if(__atomic_load_n(&__nd->__dead ,__ATOMIC_ACQUIRE))
+            continue;
+        __n++;
+        if(__fn(__nd->__pthd ,__arg) != 0)
+            break;
+    }
+    __treg_read_unlock();
+
+    return __n;
+}
+
+/**
+ * @func   __treg_count
+ * @brief  当前注册的线程数
+ *
+ * @return 线程数；参数非法返回 -1。
+ */
+int __treg_count(__treg_t *__preg)
+{
+    if(__preg == NULL)
+        return -1;
+    return __atomic_load_n(&__preg->__count ,__ATOMIC_RELAXED);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file    thread_reg.h
+ * @brief   并发安全的线程注册表接口定义
+ *
+ * @details
+ * 本模块取代原先基于双向循环链表 (__tlist_t) 的线程管理：
+ *  - 两张哈希表分别按线程名称与 pthread_t 索引，查找为 O(1)；
+ *  - 另有一条按加入顺序排列的遍历链（读者只沿后继指针前进，前驱指针仅写者使用）；
+ *  - 写操作（加入、删除、更新线程 ID）由互斥锁串行化；
+ *  - 读操作（查找、遍历）不加锁，只进入基于纪元（epoch）的读临界区，
+ *    被删除的节点及其 __thd_t 推迟到所有读者离开后才释放（RCU 风格），
+ *    因此遍历过程中其他线程可以安全地退出并注销自己。
+ *
+ * 使用约定：
+ *  - __treg_find_name/__treg_find_id 返回的指针只在读临界区内有效，需要跨越临界区使用时自行复制；
+ *  - __treg_self 返回当前线程自己的 __thd_t，线程只会注销自己，因此无需读临界区；
+ *  - 加入注册表后，__thd_t 的所有权归注册表，删除时由注册表（延迟）调用 __thread_free 释放。
+ *
+ * @note
+ * 桶数固定为 TREG_BUCKETS（不扩容），面向数十个线程的规模；读临界区可嵌套。
+ */
+#ifndef __THREAD_REG_H
+#define __THREAD_REG_H
+
+#include "thread.h"
+
+#define TREG_BUCKETS    (64)    ///< 每张哈希表的桶数（2 的幂）
+
+/**
+ * @struct __treg_node
+ * @brief  注册表节点（内部使用）
+ */
+struct __treg_node
+{
+    __thd_t *__pthd;                    ///< 线程结构体（归注册表所有）
+    char __name[20];                    ///< 名称副本，节点存续期间不变，读者比较时不触碰 __pthd
+    pthread_t __id;                     ///< 已索引的线程 ID，0 表示尚未按 ID 索引（只绑定一次）
+    uint32_t __hname;                   ///< 名称哈希
+    int __dead;                         ///< 已从注册表删除
+
+    struct __treg_node *__next_name;    ///< 名称哈希链
+    struct __treg_node *__next_id;      ///< ID 哈希链
+    struct __treg_node *__next_all;     ///< 遍历链
+    struct __treg_node *__prev_all;     ///< 遍历链前驱（仅写者使用）
+    struct __treg_node *__next_free;    ///< 待回收链
+    uint64_t __retire;                  ///< 删除时的全局纪元
+};
+
+/**
+ * @struct __thread_reg_struct
+ * @brief  线程注册表
+ */
+struct __thread_reg_struct
+{
+    pthread_mutex_t __lock;                         ///< 串行化写操作
+    struct __treg_node *__by_name[TREG_BUCKETS];    ///< 按名称索引
+    struct __treg_node *__by_id[TREG_BUCKETS];      ///< 按 pthread_t 索引
+    struct __treg_node *__all;                      ///< 遍历链表头（按加入顺序）
+    struct __treg_node *__all_tail;                 ///< 遍历链表尾
+    struct __treg_node *__retired;                  ///< 已删除待回收的节点
+    int __count;                                    ///< 当前线程数
+};
+typedef struct __thread_reg_struct __treg_t;
+
+/**
+ * @typedef __treg_iter_t
+ * @brief   遍历回调，返回非 0 时停止遍历
+ */
+typedef int (*__treg_iter_t)(__thd_t *__pthd ,void *__arg);
+
+/* 接口函数声明 */
+__treg_t *__treg_init(void);
+void __treg_free(__treg_t **__preg);
+int __treg_add(__treg_t *__preg ,__thd_t *__pthd);
+int __treg_bind_id(__treg_t *__preg ,__thd_t *__pthd);
+int __treg_del(__treg_t *__preg ,__thd_t *__pthd);
+int __treg_del_name(__treg_t *__preg ,const char *__name);
+void __treg_read_lock(void);
+void __treg_read_unlock(void);
+__thd_t *__treg_find_name(__treg_t *__preg ,const char *__name);
+__thd_t *__treg_find_id(__treg_t *__preg ,pthread_t __id);
+__thd_t *__treg_self(__treg_t *__preg);
+int __treg_foreach(__treg_t *__preg ,__treg_iter_t __fn ,void *__arg);
+int __treg_count(__treg_t *__preg);
+
+#endif /* __THREAD_REG_H */
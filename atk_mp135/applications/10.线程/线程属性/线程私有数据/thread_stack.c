@@ -0,0 +1,528 @@
+/**
+ * @file    thread_stack.c
+ * @brief   带保护页的线程栈池实现
+ *
+ * @details
+ * 布局（栈向低地址增长）：
+ *
+ *     __base                __addr                                  __base + __len
+ *       | 保护页 PROT_NONE   |            可用栈 __size                     |
+ *
+ * glibc 使用调用者提供的栈时会把线程控制块与静态 TLS 放在栈顶，并且不再额外设置保护页，
+ * 因此保护页由本模块负责。所有链表操作在 __lock 下完成，mmap/munmap 与预触碰在锁外进行。
+ */
+#include "thread.h"
+#include <sys/syscall.h>
+
+/**
+ * @struct __tstack_class
+ * @brief  一个尺寸级别
+ */
+struct __tstack_class
+{
+    size_t __size;              ///< 可用栈大小（页对齐）
+    __tstack_t *__free;         ///< 空闲栈链表
+    unsigned __nfree;           ///< 空闲栈数
+    unsigned __max_free;        ///< 最多缓存的空闲栈数
+};
+
+/**
+ * @struct __tstack_pool_struct
+ * @brief  全局栈池
+ */
+static struct __tstack_pool_struct
+{
+    pthread_mutex_t __lock;
+    int __ready;                                    ///< 尺寸级别已配置
+    int __nclass;
+    struct __tstack_class __cls[TSTACK_CLASSES_MAX];
+    int __prefault;                                 ///< 新栈默认预触碰
+    __tstack_t *__detached;                         ///< 分离线程占用的栈
+
+    unsigned __mapped;
+    unsigned __ndetached;
+    size_t __bytes;
+    uint64_t __hits;
+    uint64_t __misses;
+    uint64_t __reclaimed;
+}__tstack_pool = { .__lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* 未调用 __tstack_pool_init 时使用的默认级别，覆盖线程池工作线程与常见实时线程的栈大小 */
+static const __tstack_class_t __tstack_default_cls[] = {
+    { 64 * 1024 ,0 } ,{ 256 * 1024 ,0 } ,{ 1024 * 1024 ,0 } ,{ 2 * 1024 * 1024 ,0 } ,{ 4 * 1024 * 1024 ,0 } ,{ 8 * 1024 * 1024 ,0 }
+};
+
+/*****************************************************************************************/
+/*                                   内部辅助函数                                         */
+/*****************************************************************************************/
+
+/**
+ * @name    __tstack_page
+ * @brief   系统页大小。
+ */
+static size_t __tstack_page(void)
+{
+    static size_t __pg = 0;
+    if(__pg == 0)
+    {
+        long __v = sysconf(_SC_PAGESIZE);
+        __pg = (__v > 0) ? (size_t)__v : 4096;
+    }
+    return __pg;
+}
+
+/**
+ * @name    __tstack_round
+ * @brief   栈大小取整：不小于 PTHREAD_STACK_MIN，并向上对齐到页。
+ */
+static size_t __tstack_round(size_t __sz)
+{
+    size_t __pg = __tstack_page();
+    if(__sz < (size_t)PTHREAD_STACK_MIN)
+        __sz = (size_t)PTHREAD_STACK_MIN;
+    return (__sz + __pg - 1) & ~(__pg - 1);
+}
+
+/**
+ * @name    __tstack_config_locked
+ * @brief   设置尺寸级别：取整后升序去重，重复级别的预分配数取最大值（调用者持有 __lock）。
+ *
+ * @return  0 成功；-1 参数非法。
+ */
+static int __tstack_config_locked(const __tstack_class_t *__cls ,int __nclass ,unsigned __max_free ,int __prefault)
+{
+    if(__cls == NULL || __nclass <= 0 || __nclass > TSTACK_CLASSES_MAX)
+        return -1;
+
+    struct __tstack_class *__c = __tstack_pool.__cls;
+    int __n = 0;
+    for(int __i = 0; __i < __nclass; __i++)
+    {
+        size_t __sz = __tstack_round(__cls[__i].__size);
+        unsigned __keep = (__cls[__i].__prealloc > __max_free) ? __cls[__i].__prealloc : __max_free;
+
+        /* 插入排序并去重 */
+        int __j = __n;
+        while(__j > 0 && __c[__j - 1].__size > __sz)
+            __j--;
+        if(__j > 0 && __c[__j - 1].__size == __sz)
+        {
+            if(__c[__j - 1].__max_free < __keep)
+                __c[__j - 1].__max_free = __keep;
+            continue;
+        }
+        memmove(&__c[__j + 1] ,&__c[__j] ,(__n - __j) * sizeof(struct __tstack_class));
+        memset(&__c[__j] ,0 ,sizeof(struct __tstack_class));
+        __c[__j].__size = __sz;
+        __c[__j].__max_free = __keep;
+        __n++;
+    }
+
+    __tstack_pool.__nclass = __n;
+    __tstack_pool.__prefault = __prefault;
+    __tstack_pool.__ready = 1;
+    return 0;
+}
+
+/**
+ * @name    __tstack_class_of
+ * @brief   不小于 __size 的最小级别下标，超过最大级别返回 -1（调用者持有 __lock）。
+ */
+static int __tstack_class_of(size_t __size)
+{
+    for(int __c = 0; __c < __tstack_pool.__nclass; __c++)
+        if(__tstack_pool.__cls[__c].__size >= __size)
+            return __c;
+    return -1;
+}
+
+/**
+ * @name    __tstack_ensure_locked
+ * @brief   尚未配置时使用默认级别（调用者持有 __lock）。
+ */
+static void __tstack_ensure_locked(void)
+{
+    if(!__tstack_pool.__ready)
+        __tstack_config_locked(__tstack_default_cls ,sizeof(__tstack_default_cls) / sizeof(__tstack_default_cls[0]) ,
+            TSTACK_MAX_FREE_DEFAULT ,0);
+}
+
+/**
+ * @name    __tstack_prefault
+ * @brief   逐页写入一次，使整段栈在线程运行前就已建立物理页映射。
+ */
+static void __tstack_prefault(__tstack_t *__stk)
+{
+    size_t __pg = __tstack_page();
+    volatile char *__p = (volatile char *)__stk->__addr;
+    for(size_t __off = 0; __off < __stk->__size; __off += __pg)
+        __p[__off] = 0;
+    __stk->__faulted = 1;
+}
+
+/**
+ * @name    __tstack_map
+ * @brief   为第 __cls 级 mmap 一个新栈，并把最低的 TSTACK_GUARD_PAGES 页设为保护页。
+ *
+ * @return  栈指针；失败返回 NULL 并设置 errno。
+ */
+static __tstack_t *__tstack_map(int __cls ,size_t __size)
+{
+    __tstack_t *__stk = (__tstack_t *)calloc(1 ,sizeof(__tstack_t));
+    if(__stk == NULL)
+        return NULL;
+
+    size_t __guard = (size_t)TSTACK_GUARD_PAGES * __tstack_page();
+    __stk->__len = __size + __guard;
+    __stk->__base = mmap(NULL ,__stk->__len ,PROT_READ | PROT_WRITE ,MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK ,-1 ,0);
+    if(__stk->__base == MAP_FAILED)
+    {
+        free(__stk);
+        return NULL;
+    }
+    if(__guard > 0 && mprotect(__stk->__base ,__guard ,PROT_NONE) != 0)
+    {
+        int __err = errno;
+        munmap(__stk->__base ,__stk->__len);
+        free(__stk);
+        errno = __err;
+        return NULL;
+    }
+
+    __stk->__addr = (char *)__stk->__base + __guard;
+    __stk->__size = __size;
+    __stk->__class = __cls;
+    return __stk;
+}
+
+/**
+ * @name    __tstack_unmap
+ * @brief   释放一串通过 __next 链接的栈（在锁外调用）。
+ */
+static void __tstack_unmap(__tstack_t *__stk)
+{
+    while(__stk != NULL)
+    {
+        __tstack_t *__next = __stk->__next;
+        munmap(__stk->__base ,__stk->__len);
+        free(__stk);
+        __stk = __next;
+    }
+}
+
+/**
+ * @name    __tstack_release_locked
+ * @brief   把栈放回所属级别的空闲链表；该级别已缓存满时挂到 __excess 等待锁外 munmap。
+ */
+static void __tstack_release_locked(__tstack_t *__stk ,__tstack_t **__excess)
+{
+    struct __tstack_class *__c = &__tstack_pool.__cls[__stk->__class];
+    __stk->__state = TSTACK_FREE;
+    __stk->__tid = 0;
+    if(__c->__nfree < __c->__max_free)
+    {
+        __stk->__next = __c->__free;
+        __c->__free = __stk;
+        __c->__nfree++;
+    }
+    else
+    {
+        __stk->__next = *__excess;
+        *__excess = __stk;
+        __tstack_pool.__mapped--;
+        __tstack_pool.__bytes -= __stk->__len;
+    }
+}
+
+/**
+ * @name    __tstack_reclaim_locked
+ * @brief   探测分离线程是否已退出，回收其栈（调用者持有 __lock）。
+ *
+ * @return  回收的栈数。
+ *
+ * @details
+ * tgkill(pid, tid, 0) 返回 ESRCH 说明内核已注销该线程号，此前内核已完成清除 glibc
+ * 线程控制块中 tid 字段（CLONE_CHILD_CLEARTID）等最后的用户态写入，栈可以安全复用。
+ * 线程号被本进程新线程复用时只会推迟回收，不会误判。
+ */
+static int __tstack_reclaim_locked(__tstack_t **__excess)
+{
+    int __n = 0;
+    pid_t __pid = getpid();
+    __tstack_t **__pp = &__tstack_pool.__detached;
+    while(*__pp != NULL)
+    {
+        __tstack_t *__stk = *__pp;
+        pid_t __tid = __atomic_load_n(&__stk->__tid ,__ATOMIC_ACQUIRE);
+        if(__tid != 0 && syscall(SYS_tgkill ,__pid ,__tid ,0) == -1 && errno == ESRCH)
+        {
+            *__pp = __stk->__next;
+            __tstack_pool.__ndetached--;
+            __tstack_pool.__reclaimed++;
+            __tstack_release_locked(__stk ,__excess);
+            __n++;
+        }
+        else
+        {
+            __pp = &__stk->__next;
+        }
+    }
+    return __n;
+}
+
+/*****************************************************************************************/
+/*                                     接口函数                                           */
+/*****************************************************************************************/
+
+/**
+ * @func   __tstack_pool_init
+ * @brief  配置栈池尺寸级别并预分配栈
+ *
+ * @param[in] __cls       级别配置数组：可用栈大小（向上取整到页，重复的合并）与预分配数
+ * @param[in] __nclass    级别数，1 ~ TSTACK_CLASSES_MAX
+ * @param[in] __max_free  每个级别最多缓存的空闲栈数，小于该级别预分配数时取预分配数
+ * @param[in] __prefault  非 0 时新栈全部预先触碰（实时线程无论此值都会预触碰）
+ *
+ * @return
+ *   -  0  ：成功；
+ *   - -1  ：参数非法；
+ *   - >0  ：EALREADY 已配置过（显式配置或首次 __tstack_get 时的默认配置），ENOMEM 预分配失败
+ *           （已成功预分配的栈保留在池中）。
+ *
+ * @note   应在创建任何线程之前调用一次，通常放在进程初始化最前面。
+ */
+int __tstack_pool_init(const __tstack_class_t *__cls ,int __nclass ,unsigned __max_free ,int __prefault)
+{
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    if(__tstack_pool.__ready)
+    {
+        pthread_mutex_unlock(&__tstack_pool.__lock);
+        return EALREADY;
+    }
+    int __ret = __tstack_config_locked(__cls ,__nclass ,__max_free ,__prefault);
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+    if(__ret != 0)
+        return __ret;
+
+    /* 预分配在锁外 mmap/触碰，逐个挂入空闲链表 */
+    for(int __i = 0; __i < __nclass; __i++)
+    {
+        size_t __sz = __tstack_round(__cls[__i].__size);
+        for(unsigned __k = 0; __k < __cls[__i].__prealloc; __k++)
+        {
+            pthread_mutex_lock(&__tstack_pool.__lock);
+            int __c = __tstack_class_of(__sz);
+            pthread_mutex_unlock(&__tstack_pool.__lock);
+
+            __tstack_t *__stk = __tstack_map(__c ,__sz);
+            if(__stk == NULL)
+                return ENOMEM;
+            if(__prefault)
+                __tstack_prefault(__stk);
+
+            __tstack_t *__excess = NULL;
+            pthread_mutex_lock(&__tstack_pool.__lock);
+            __tstack_pool.__mapped++;
+            __tstack_pool.__bytes += __stk->__len;
+            __tstack_release_locked(__stk ,&__excess);
+            pthread_mutex_unlock(&__tstack_pool.__lock);
+            __tstack_unmap(__excess);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @func   __tstack_get
+ * @brief  取一个不小于 __size 的栈
+ *
+ * @param[in] __size      需要的可用栈大小（字节）
+ * @param[in] __prefault  非 0 时保证返回前全部页面已触碰
+ *
+ * @retval __tstack_t*  成功，状态为 TSTACK_JOINABLE
+ * @retval NULL         超过最大级别（errno = ERANGE）或 mmap 失败（errno 由 mmap 设置）
+ *
+ * @details
+ * 优先取对应级别的空闲栈；该级别为空时先回收已退出的分离线程的栈，仍为空才新 mmap。
+ */
+__tstack_t *__tstack_get(size_t __size ,int __prefault)
+{
+    __tstack_t *__excess = NULL;
+    __tstack_t *__stk = NULL;
+
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    __tstack_ensure_locked();
+
+    int __c = __tstack_class_of(__size);
+    if(__c < 0)
+    {
+        pthread_mutex_unlock(&__tstack_pool.__lock);
+        errno = ERANGE;
+        return NULL;
+    }
+
+    struct __tstack_class *__cls = &__tstack_pool.__cls[__c];
+    if(__cls->__free == NULL && __tstack_pool.__detached != NULL)
+        __tstack_reclaim_locked(&__excess);
+
+    if(__cls->__free != NULL)
+    {
+        __stk = __cls->__free;
+        __cls->__free = __stk->__next;
+        __cls->__nfree--;
+        __tstack_pool.__hits++;
+    }
+    else
+    {
+        __tstack_pool.__misses++;
+    }
+    size_t __csize = __cls->__size;
+    __prefault = __prefault || __tstack_pool.__prefault;
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+
+    __tstack_unmap(__excess);
+
+    if(__stk == NULL)
+    {
+        __stk = __tstack_map(__c ,__csize);
+        if(__stk == NULL)
+            return NULL;
+
+        pthread_mutex_lock(&__tstack_pool.__lock);
+        __tstack_pool.__mapped++;
+        __tstack_pool.__bytes += __stk->__len;
+        pthread_mutex_unlock(&__tstack_pool.__lock);
+    }
+
+    if(__prefault && !__stk->__faulted)
+        __tstack_prefault(__stk);
+
+    __stk->__next = NULL;
+    __stk->__tid = 0;
+    __stk->__state = TSTACK_JOINABLE;
+    return __stk;
+}
+
+/**
+ * @func   __tstack_put
+ * @brief  归还栈（线程已被 join，或线程创建失败）
+ *
+ * @note   调用者需保证已没有线程运行在该栈上。
+ */
+void __tstack_put(__tstack_t *__stk)
+{
+    if(__stk == NULL)
+        return;
+
+    __tstack_t *__excess = NULL;
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    __tstack_release_locked(__stk ,&__excess);
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+
+    __tstack_unmap(__excess);
+}
+
+/**
+ * @func   __tstack_detach
+ * @brief  把栈交给分离线程，线程退出后由 __tstack_reclaim 回收
+ *
+ * @note   线程需经 __tstack_bind_self 记录内核线程号后才可能被回收。
+ */
+void __tstack_detach(__tstack_t *__stk)
+{
+    if(__stk == NULL)
+        return;
+
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    __stk->__state = TSTACK_DETACHED;
+    __stk->__next = __tstack_pool.__detached;
+    __tstack_pool.__detached = __stk;
+    __tstack_pool.__ndetached++;
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+}
+
+/**
+ * @func   __tstack_bind_self
+ * @brief  由运行在该栈上的线程调用，记录自己的内核线程号
+ */
+void __tstack_bind_self(__tstack_t *__stk)
+{
+    if(__stk == NULL)
+        return;
+    __atomic_store_n(&__stk->__tid ,(pid_t)syscall(SYS_gettid) ,__ATOMIC_RELEASE);
+}
+
+/**
+ * @func   __tstack_reclaim
+ * @brief  回收已退出的分离线程的栈
+ *
+ * @return 回收的栈数。
+ *
+ * @note   __tstack_get 在级别缺栈时会自动调用，一般无需手动调用。
+ */
+int __tstack_reclaim(void)
+{
+    __tstack_t *__excess = NULL;
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    int __n = __tstack_reclaim_locked(&__excess);
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+
+    __tstack_unmap(__excess);
+    return __n;
+}
+
+/**
+ * @func   __tstack_stat
+ * @brief  获取栈池计数快照
+ *
+ * @return 0 成功；-1 参数非法。
+ */
+int __tstack_stat(__tstack_stat_t *__st)
+{
+    if(__st == NULL)
+        return -1;
+
+    memset(__st ,0 ,sizeof(__tstack_stat_t));
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    for(int __c = 0; __c < __tstack_pool.__nclass; __c++)
+        __st->__free += __tstack_pool.__cls[__c].__nfree;
+    __st->__mapped = __tstack_pool.__mapped;
+    __st->__detached = __tstack_pool.__ndetached;
+    __st->__bytes = __tstack_pool.__bytes;
+    __st->__hits = __tstack_pool.__hits;
+    __st->__misses = __tstack_pool.__misses;
+    __st->__reclaimed = __tstack_pool.__reclaimed;
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+
+    return 0;
+}
+
+/**
+ * @func   __tstack_pool_free
+ * @brief  释放全部空闲栈以及已退出分离线程的栈
+ *
+ * @note   仍被线程占用的栈保持不动；尺寸级别配置保留，之后仍可继续取栈。
+ */
+void __tstack_pool_free(void)
+{
+    __tstack_t *__excess = NULL;
+    pthread_mutex_lock(&__tstack_pool.__lock);
+    __tstack_reclaim_locked(&__excess);
+    for(int __c = 0; __c < __tstack_pool.__nclass; __c++)
+    {
+        struct __tstack_class *__cls = &__tstack_pool.__cls[__c];
+        while(__cls->__free != NULL)
+        {
+            __tstack_t *__stk = __cls->__free;
+            __cls->__free = __stk->__next;
+            __tstack_pool.__mapped--;
+            __tstack_pool.__bytes -= __stk->__len;
+            __stk->__next = __excess;
+            __excess = __stk;
+        }
+        __cls->__nfree = 0;
+    }
+    pthread_mutex_unlock(&__tstack_pool.__lock);
+
+    __tstack_unmap(__excess);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file    thread_stack.h
+ * @brief   带保护页的线程栈池接口定义
+ *
+ * @details
+ * THREAD_OP_STACKSIZE 且未指定 __stack_addr 时，__thread_create 从本模块取栈，
+ * 不再由 glibc 为每个线程 mmap 一段新栈：
+ *  - 栈按尺寸分级（size class），请求大小向上取整到最近的级别；
+ *  - 每个栈为一段独立 mmap，最低地址处 TSTACK_GUARD_PAGES 页设为 PROT_NONE 作保护页，
+ *    栈溢出时立即 SIGSEGV，而不是悄悄踩坏相邻内存；
+ *  - 可预先分配（prealloc）并预先触碰（prefault）全部页面，实时线程首次运行时不产生缺页；
+ *  - 线程结束后栈回到空闲链表供下一个线程复用：
+ *      可 join 的线程在 __thread_join 成功后立即回收；
+ *      分离线程记录内核线程号，由 tgkill(..., 0) 返回 ESRCH 判定其已退出后回收
+ *      （内核在线程号失效前已完成对栈上 glibc 线程控制块的最后写入）。
+ *
+ * 使用流程：
+ *  1. 进程启动时 __tstack_pool_init() 配置尺寸级别及各级预分配数（不调用则首次使用时按默认级别初始化）；
+ *  2. __thread_create/__thread_join/__thread_detach 自动调用 __tstack_get/__tstack_put/__tstack_detach；
+ *  3. __tstack_stat() 查看命中率与占用；进程退出时 __tstack_pool_free() 归还空闲栈。
+ *
+ * @note
+ * - 超过最大级别的请求不进入栈池，仍由 glibc 分配；
+ * - 未 join 也未分离的线程，其栈一直处于占用状态，与 glibc 行为一致。
+ */
+#ifndef __THREAD_STACK_H
+#define __THREAD_STACK_H
+
+#include "file.h"
+
+#define TSTACK_CLASSES_MAX      (8)     ///< 最多尺寸级别数
+#define TSTACK_GUARD_PAGES      (1)     ///< 每个栈底部的保护页数
+#define TSTACK_MAX_FREE_DEFAULT (8)     ///< 每个级别默认最多缓存的空闲栈数
+
+/**
+ * @enum   tstack_state_t
+ * @brief  栈的归属状态
+ */
+typedef enum
+{
+    TSTACK_FREE     = 0,    ///< 在空闲链表中
+    TSTACK_JOINABLE = 1,    ///< 被可 join 的线程占用，join 后归还
+    TSTACK_DETACHED = 2     ///< 被分离线程占用，线程退出后由探测回收
+}tstack_state_t;
+
+/**
+ * @struct __tstack_class_t
+ * @brief  尺寸级别配置（__tstack_pool_init 参数）
+ */
+typedef struct
+{
+    size_t __size;          ///< 可用栈大小（字节），向上取整到页
+    unsigned __prealloc;    ///< 预先 mmap 的栈数，该级别至少缓存这么多空闲栈
+}__tstack_class_t;
+
+/**
+ * @struct __tstack_struct
+ * @brief  栈池中的一个栈（内部使用）
+ */
+struct __tstack_struct
+{
+    void *__base;                   ///< mmap 起始地址（含保护页）
+    size_t __len;                   ///< mmap 总长度
+    void *__addr;                   ///< 可用栈的最低地址（保护页之上），传给 pthread_attr_setstack
+    size_t __size;                  ///< 可用栈大小
+    int __class;                    ///< 所属尺寸级别下标
+    int __faulted;                  ///< 页面已全部触碰过
+    int __state;                    ///< tstack_state_t
+    pid_t __tid;                    ///< 使用者的内核线程号，线程开始运行前为 0
+    struct __tstack_struct *__next; ///< 空闲链表/分离链表
+};
+typedef struct __tstack_struct __tstack_t;
+
+/**
+ * @struct __tstack_stat_t
+ * @brief  栈池计数快照（__tstack_stat 填充）
+ */
+typedef struct
+{
+    unsigned __mapped;      ///< 已 mmap 的栈数（空闲 + 占用）
+    unsigned __free;        ///< 空闲栈数
+    unsigned __detached;    ///< 被分离线程占用、等待回收的栈数
+    size_t __bytes;         ///< 已 mmap 的总字节数
+    uint64_t __hits;        ///< 直接从空闲链表取得的次数
+    uint64_t __misses;      ///< 需要新 mmap 的次数
+    uint64_t __reclaimed;   ///< 从已退出的分离线程回收的次数
+}__tstack_stat_t;
+
+/* 接口函数声明 */
+int __tstack_pool_init(const __tstack_class_t *__cls ,int __nclass ,unsigned __max_free ,int __prefault);
+__tstack_t *__tstack_get(size_t __size ,int __prefault);
+void __tstack_put(__tstack_t *__stk);
+void __tstack_detach(__tstack_t *__stk);
+void __tstack_bind_self(__tstack_t *__stk);
+int __tstack_reclaim(void);
+int __tstack_stat(__tstack_stat_t *__st);
+void __tstack_pool_free(void);
+
+#endif /* __THREAD_STACK_H */
@@ -0,0 +1,540 @@
+/**
+ * @file    thread_steal.c
+ * @brief   基于 Chase-Lev 双端队列的 work-stealing 执行器实现
+ *
+ * @details
+ * 双端队列按 Lê/Pop/Cohen/Zappa Nardelli《Correct and Efficient Work-Stealing for
+ * Weak Memory Models》中的 C11 版本实现，内存序用 GCC __atomic 内建函数表达。
+ *
+ * 休眠协议（避免丢失唤醒）：
+ *  - 工作线程：__nsleep++ → 读 __epoch → 再检查一次全部队列 → 仍为空才 futex_wait(__epoch)；
+ *  - 提交者  ：压入任务 → 全序栅栏 → 读到 __nsleep > 0 时 __epoch++ 并 futex_wake 一个。
+ *  两侧都经过全序操作，提交者要么看到休眠者并推进 __epoch（对方 futex_wait 立即返回），
+ *  要么休眠者在再检查时看到新任务。
+ */
+#include "thread_steal.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#define TSTEAL_SYNC_SPIN        (64)    ///< sync 帮忙无果时先让出 CPU 的次数，之后改为短暂 futex 等待
+#define TSTEAL_SYNC_WAIT_NS     (1000000L)  ///< sync 单次 futex 等待上限，到时回来继续帮忙
+
+/* 当前线程所属的工作线程，非工作线程为 NULL */
+static __thread struct __tsteal_worker *__tsteal_self = NULL;
+
+/*****************************************************************************************/
+/*                                   futex 与双端队列                                     */
+/*****************************************************************************************/
+
+/**
+ * @name    __tsteal_futex_wait
+ * @brief   *__addr 仍等于 __val 时休眠，__ns 为 0 表示不限时。
+ */
+static void __tsteal_futex_wait(uint32_t *__addr ,uint32_t __val ,long __ns)
+{
+    struct timespec __ts = { 0 ,__ns };
+    syscall(SYS_futex ,__addr ,FUTEX_WAIT_PRIVATE ,__val ,__ns ? &__ts : NULL ,NULL ,0);
+}
+
+/**
+ * @name    __tsteal_futex_wake
+ * @brief   唤醒最多 __n 个在 __addr 上休眠的线程。
+ */
+static void __tsteal_futex_wake(uint32_t *__addr ,int __n)
+{
+    syscall(SYS_futex ,__addr ,FUTEX_WAKE_PRIVATE ,__n ,NULL ,NULL ,0);
+}
+
+/**
+ * @name    __tsteal_push
+ * @brief   所属工作线程从底部压入任务。
+ *
+ * @return  0 成功；-1 队列已满。
+ */
+static int __tsteal_push(struct __tsteal_deque *__dq ,__tsteal_task_t *__task)
+{
+    int64_t __b = __atomic_load_n(&__dq->__bottom ,__ATOMIC_RELAXED);
+    int64_t __t = __atomic_load_n(&__dq->__top ,__ATOMIC_ACQUIRE);
+    if(__b - __t > TSTEAL_DEQUE_SIZE - 1)
+        return -1;
+
+    __atomic_store_n(&__dq->__buf[__b & (TSTEAL_DEQUE_SIZE - 1)] ,__task ,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&__dq->__bottom ,__b + 1 ,__ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @name    __tsteal_take
+ * @brief   所属工作线程从底部弹出任务（LIFO）。
+ *
+ * @return  任务指针；队列为空或最后一个任务被窃取者抢走时返回 NULL。
+ */
+static __tsteal_task_t *__tsteal_take(struct __tsteal_deque *__dq)
+{
+    int64_t __b = __atomic_load_n(&__dq->__bottom ,__ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&__dq->__bottom ,__b ,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t __t = __atomic_load_n(&__dq->__top ,__ATOMIC_RELAXED);
+
+    __tsteal_task_t *__task = NULL;
+    if(__t <= __b)
+    {
+        __task = __atomic_load_n(&__dq->__buf[__b & (TSTEAL_DEQUE_SIZE - 1)] ,__ATOMIC_RELAXED);
+        if(__t == __b)
+        {
+            /* 只剩最后一个任务，与窃取者竞争 */
+            if(!__atomic_compare_exchange_n(&__dq->__top ,&__t ,__t + 1 ,0 ,__ATOMIC_SEQ_CST ,__ATOMIC_RELAXED))
+                __task = NULL;
+            __atomic_store_n(&__dq->__bottom ,__b + 1 ,__ATOMIC_RELAXED);
+        }
+    }
+    else
+    {
+        __atomic_store_n(&__dq->__bottom ,__b + 1 ,__ATOMIC_RELAXED);
+    }
+    return __task;
+}
+
+/**
+ * @name    __tsteal_steal
+ * @brief   其他线程从顶部窃取任务（FIFO）。
+ *
+ * @return  任务指针；队列为空或与其他窃取者竞争失败时返回 NULL。
+ */
+static __tsteal_task_t *__tsteal_steal(struct __tsteal_deque *__dq)
+{
+    int64_t __t = __atomic_load_n(&__dq->__top ,__ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t __b = __atomic_load_n(&__dq->__bottom ,__ATOMIC_ACQUIRE);
+    if(__t >= __b)
+        return NULL;
+
+    __tsteal_task_t *__task = __atomic_load_n(&__dq->__buf[__t & (TSTEAL_DEQUE_SIZE - 1)] ,__ATOMIC_RELAXED);
+    if(!__atomic_compare_exchange_n(&__dq->__top ,&__t ,__t + 1 ,0 ,__ATOMIC_SEQ_CST ,__ATOMIC_RELAXED))
+        return NULL;
+    return __task;
+}
+
+/*****************************************************************************************/
+/*                                    调度内部函数                                        */
+/*****************************************************************************************/
+
+/**
+ * @name    __tsteal_wake
+ * @brief   新任务入队后调用：存在休眠的工作线程时推进事件计数并唤醒一个。
+ */
+static void __tsteal_wake(__tsteal_t *__exec)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&__exec->__nsleep ,__ATOMIC_SEQ_CST) > 0)
+    {
+        __atomic_add_fetch(&__exec->__epoch ,1 ,__ATOMIC_SEQ_CST);
+        __tsteal_futex_wake(&__exec->__epoch ,1);
+    }
+}
+
+/**
+ * @name    __tsteal_execute
+ * @brief   执行任务并标记完成，有外部等待者时唤醒。
+ *
+ * @note    标记完成后任务可能立即被其所有者释放，之后只能把地址交给 futex_wake。
+ */
+static void __tsteal_execute(struct __tsteal_worker *__w ,__tsteal_task_t *__task)
+{
+    __task->__fn(__task->__arg);
+    __w->__executed++;
+
+    if(__atomic_exchange_n(&__task->__state ,TSTEAL_TASK_DONE ,__ATOMIC_SEQ_CST) == TSTEAL_TASK_WAITED)
+        __tsteal_futex_wake(&__task->__state ,INT_MAX);
+}
+
+/**
+ * @name    __tsteal_find
+ * @brief   随机挑选其他工作线程窃取，全部落空后再查注入队列。
+ *
+ * @return  任务指针；没有可执行的任务返回 NULL。
+ */
+static __tsteal_task_t *__tsteal_find(struct __tsteal_worker *__w)
+{
+    __tsteal_t *__exec = __w->__exec;
+    int __n = __atomic_load_n(&__exec->__started ,__ATOMIC_ACQUIRE);
+
+    for(int __i = 0; __i < __n * 2 && __n > 1; __i++)
+    {
+        /* xorshift32 */
+        __w->__rng ^= __w->__rng << 13;
+        __w->__rng ^= __w->__rng >> 17;
+        __w->__rng ^= __w->__rng << 5;
+
+        int __v = (int)(__w->__rng % (uint32_t)__n);
+        if(__v == __w->__index)
+            continue;
+
+        __tsteal_task_t *__task = __tsteal_steal(&__exec->__workers[__v].__dq);
+        if(__task != NULL)
+        {
+            __w->__stolen++;
+            return __task;
+        }
+    }
+
+    if(__atomic_load_n(&__exec->__inject_count ,__ATOMIC_ACQUIRE) == 0)
+        return NULL;
+
+    pthread_mutex_lock(&__exec->__inject_lock);
+    __tsteal_task_t *__task = __exec->__inject_head;
+    if(__task != NULL)
+    {
+        __exec->__inject_head = __task->__next;
+        if(__exec->__inject_head == NULL)
+            __exec->__inject_tail = NULL;
+        __atomic_store_n(&__exec->__inject_count ,__exec->__inject_count - 1 ,__ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&__exec->__inject_lock);
+    return __task;
+}
+
+/**
+ * @name    __tsteal_worker_routine
+ * @brief   工作线程入口：本地弹出 → 窃取/注入队列 → futex 休眠，直到执行器关闭且无任务。
+ *
+ * @param[in] __arg  工作线程自身的 __thd_t，__data 指向 struct __tsteal_worker。
+ */
+static void *__tsteal_worker_routine(void *__arg)
+{
+    __thd_t *__pthd = (__thd_t *)__arg;
+    struct __tsteal_worker *__w = (struct __tsteal_worker *)__pthd->__data;
+    __tsteal_t *__exec = __w->__exec;
+
+    __tsteal_self = __w;
+    for(;;)
+    {
+        __tsteal_task_t *__task = __tsteal_take(&__w->__dq);
+        if(__task == NULL)
+            __task = __tsteal_find(__w);
+        if(__task != NULL)
+        {
+            __tsteal_execute(__w ,__task);
+            continue;
+        }
+
+        /* 准备休眠：先登记，再取事件计数，最后再检查一次 */
+        __atomic_add_fetch(&__exec->__nsleep ,1 ,__ATOMIC_SEQ_CST);
+        uint32_t __e = __atomic_load_n(&__exec->__epoch ,__ATOMIC_SEQ_CST);
+        __task = __tsteal_find(__w);
+        if(__task == NULL && !__atomic_load_n(&__exec->__stop ,__ATOMIC_SEQ_CST))
+        {
+            __w->__parked++;
+            __tsteal_futex_wait(&__exec->__epoch ,__e ,0);
+        }
+        __atomic_sub_fetch(&__exec->__nsleep ,1 ,__ATOMIC_SEQ_CST);
+
+        if(__task != NULL)
+            __tsteal_execute(__w ,__task);
+        else if(__atomic_load_n(&__exec->__stop ,__ATOMIC_SEQ_CST))
+            break;
+    }
+    __tsteal_self = NULL;
+
+    return NULL;
+}
+
+/*****************************************************************************************/
+/*                                     接口函数                                           */
+/*****************************************************************************************/
+
+/**
+ * @func   __tsteal_init
+ * @brief  创建 work-stealing 执行器并启动全部工作线程
+ *
+ * @param[in] __name      执行器名称，不能为空，超过 11 字符截断
+ * @param[in] __nworkers  工作线程数，<=0 时取 TSTEAL_WORKERS_DEFAULT
+ * @param[in] __tmpl      工作线程属性模板，可为 NULL；
+ *                        使用其 __op、__policy、__inheritsched、__param、__stack_sz、__placement、__cpuset 字段
+ *
+ * @retval __tsteal_t*  成功返回执行器指针
+ * @retval NULL         参数非法、内存不足或工作线程创建失败
+ *
+ * @note
+ *  - 与 __tpool_init 相同：忽略 THREAD_OP_DETACHED 与 __stack_addr，
+ *    实时调度无权限（EPERM）时打印提示并退回默认调度；
+ *  - 递归任务运行在工作线程栈上，递归较深时应通过模板加大 __stack_sz。
+ */
+__tsteal_t *__tsteal_init(const char *__name ,int __nworkers ,const __thd_t *__tmpl)
+{
+    if(__name == NULL)
+        return NULL;
+    if(__nworkers <= 0)
+        __nworkers = TSTEAL_WORKERS_DEFAULT;
+
+    __tsteal_t *__exec = NULL;
+    if(posix_memalign((void **)&__exec ,64 ,sizeof(__tsteal_t)) != 0)
+        return NULL;
+    memset(__exec ,0 ,sizeof(__tsteal_t));
+
+    if(posix_memalign((void **)&__exec->__workers ,64 ,__nworkers * sizeof(struct __tsteal_worker)) != 0)
+    {
+        free(__exec);
+        return NULL;
+    }
+    memset(__exec->__workers ,0 ,__nworkers * sizeof(struct __tsteal_worker));
+
+    if(pthread_mutex_init(&__exec->__inject_lock ,NULL) != 0)
+    {
+        free(__exec->__workers);
+        free(__exec);
+        return NULL;
+    }
+    strncpy(__exec->__name ,__name ,sizeof(__exec->__name) - 1);
+    __exec->__nworkers = __nworkers;
+
+    /* 先填好全部工作线程结构，窃取时按 __started 访问已启动的部分 */
+    for(int __i = 0; __i < __nworkers; __i++)
+    {
+        __exec->__workers[__i].__exec = __exec;
+        __exec->__workers[__i].__index = __i;
+        __exec->__workers[__i].__rng = 0x9e3779b9u * (uint32_t)(__i + 1);
+    }
+
+    for(int __i = 0; __i < __nworkers; __i++)
+    {
+        struct __tsteal_worker *__w = &__exec->__workers[__i];
+        char __tname[32];
+        snprintf(__tname ,sizeof(__tname) ,"%s-%d" ,__exec->__name ,__i);
+
+        __thd_t *__pthd = __thread_init(__tname);
+        if(__pthd == NULL)
+            break;
+
+        if(__tmpl != NULL)
+        {
+            __pthd->__op = __tmpl->__op & ~THREAD_OP_DETACHED;
+            __pthd->__policy = __tmpl->__policy;
+            __pthd->__inheritsched = __tmpl->__inheritsched;
+            __pthd->__param = __tmpl->__param;
+            __pthd->__stack_sz = __tmpl->__stack_sz;
+            __pthd->__placement = __tmpl->__placement;
+            __pthd->__cpuset = __tmpl->__cpuset;
+        }
+        __pthd->__stack_addr = NULL;
+        __pthd->__start_routine = __tsteal_worker_routine;
+        __pthd->__data = __w;
+        __w->__pthd = __pthd;
+
+        int __ret = __thread_create(__pthd);
+        if(__ret == EPERM && (__pthd->__op & THREAD_OP_REALTIME) == THREAD_OP_REALTIME)
+        {
+            fprintf(stderr ,"%s: no permission for realtime policy ,fall back to default scheduling\n" ,__pthd->__name);
+            __thread_attr_destroy(__pthd);
+            __pthd->__op &= ~THREAD_OP_REALTIME;
+            __ret = __thread_create(__pthd);
+        }
+        if(__ret != 0)
+        {
+            __thread_attr_destroy(__pthd);
+            __thread_free(&__pthd);
+            __w->__pthd = NULL;
+            break;
+        }
+        __atomic_store_n(&__exec->__started ,__i + 1 ,__ATOMIC_RELEASE);
+    }
+
+    if(__exec->__started != __nworkers)
+    {
+        __tsteal_free(&__exec);
+        return NULL;
+    }
+    return __exec;
+}
+
+/**
+ * @func   __tsteal_task_init
+ * @brief  初始化任务（每次 spawn 前都需调用）
+ */
+void __tsteal_task_init(__tsteal_task_t *__task ,__tsteal_fn_t __fn ,void *__arg)
+{
+    if(__task == NULL)
+        return;
+
+    __task->__fn = __fn;
+    __task->__arg = __arg;
+    __task->__state = TSTEAL_TASK_PENDING;
+    __task->__next = NULL;
+}
+
+/**
+ * @func   __tsteal_spawn
+ * @brief  提交任务，之后必须对同一任务调用 __tsteal_sync
+ *
+ * @param[in] __exec  执行器指针，不能为空
+ * @param[in] __task  已初始化的任务，不能为空
+ *
+ * @return 0 成功；-1 参数非法或执行器已关闭。
+ *
+ * @details
+ *  - 在本执行器的工作线程内调用：压入该线程的双端队列，队列满时直接内联执行；
+ *  - 在其他线程调用：放入注入队列，由空闲工作线程取走。
+ */
+int __tsteal_spawn(__tsteal_t *__exec ,__tsteal_task_t *__task)
+{
+    if(__exec == NULL || __task == NULL || __task->__fn == NULL)
+        return -1;
+    if(__atomic_load_n(&__exec->__stop ,__ATOMIC_RELAXED))
+        return -1;
+
+    struct __tsteal_worker *__w = __tsteal_self;
+    if(__w != NULL && __w->__exec == __exec)
+    {
+        if(__tsteal_push(&__w->__dq ,__task) != 0)
+        {
+            __w->__inlined++;
+            __tsteal_execute(__w ,__task);
+            return 0;
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&__exec->__inject_lock);
+        __task->__next = NULL;
+        if(__exec->__inject_tail != NULL)
+            __exec->__inject_tail->__next = __task;
+        else
+            __exec->__inject_head = __task;
+        __exec->__inject_tail = __task;
+        __exec->__injected++;
+        __atomic_store_n(&__exec->__inject_count ,__exec->__inject_count + 1 ,__ATOMIC_RELEASE);
+        pthread_mutex_unlock(&__exec->__inject_lock);
+    }
+
+    __tsteal_wake(__exec);
+    return 0;
+}
+
+/**
+ * @func   __tsteal_sync
+ * @brief  等待已 spawn 的任务完成
+ *
+ * @param[in] __exec  执行器指针，不能为空
+ * @param[in] __task  已 spawn 的任务，不能为空
+ *
+ * @return 0 成功；-1 参数非法。
+ *
+ * @details
+ *  - 工作线程内调用：等待期间继续执行本地与窃取来的任务，任务已被别人取走且
+ *    暂时无事可做时，先让出 CPU，再在任务的 futex 上短暂等待，不会长时间忙等；
+ *  - 其他线程调用：直接在任务的 futex 上阻塞，直到任务完成。
+ */
+int __tsteal_sync(__tsteal_t *__exec ,__tsteal_task_t *__task)
+{
+    if(__exec == NULL || __task == NULL)
+        return -1;
+
+    struct __tsteal_worker *__w = __tsteal_self;
+    int __idle = 0;
+    while(__atomic_load_n(&__task->__state ,__ATOMIC_ACQUIRE) != TSTEAL_TASK_DONE)
+    {
+        if(__w != NULL && __w->__exec == __exec)
+        {
+            __tsteal_task_t *__t = __tsteal_take(&__w->__dq);
+            if(__t == NULL)
+                __t = __tsteal_find(__w);
+            if(__t != NULL)
+            {
+                __tsteal_execute(__w ,__t);
+                __idle = 0;
+                continue;
+            }
+            if(++__idle < TSTEAL_SYNC_SPIN)
+            {
+                sched_yield();
+                continue;
+            }
+        }
+
+        /* 登记等待者后在任务状态上休眠，完成者交换状态时看到 WAITED 会唤醒 */
+        uint32_t __s = TSTEAL_TASK_PENDING;
+        if(__atomic_compare_exchange_n(&__task->__state ,&__s ,TSTEAL_TASK_WAITED ,0 ,__ATOMIC_SEQ_CST ,__ATOMIC_SEQ_CST)
+            || __s == TSTEAL_TASK_WAITED)
+        {
+            __tsteal_futex_wait(&__task->__state ,TSTEAL_TASK_WAITED ,(__w != NULL) ? TSTEAL_SYNC_WAIT_NS : 0);
+        }
+        __idle = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @func   __tsteal_run
+ * @brief  在执行器上运行一个根任务并等待其（及其 spawn 出的全部子任务）完成
+ *
+ * @return 0 成功；-1 参数非法或执行器已关闭。
+ */
+int __tsteal_run(__tsteal_t *__exec ,__tsteal_fn_t __fn ,void *__arg)
+{
+    __tsteal_task_t __task;
+    __tsteal_task_init(&__task ,__fn ,__arg);
+    if(__tsteal_spawn(__exec ,&__task) != 0)
+        return -1;
+    return __tsteal_sync(__exec ,&__task);
+}
+
+/**
+ * @func   __tsteal_stat
+ * @brief  累加各工作线程计数
+ *
+ * @return 0 成功；-1 参数非法。
+ */
+int __tsteal_stat(__tsteal_t *__exec ,__tsteal_stat_t *__st)
+{
+    if(__exec == NULL || __st == NULL)
+        return -1;
+
+    memset(__st ,0 ,sizeof(*__st));
+    for(int __i = 0; __i < __exec->__nworkers; __i++)
+    {
+        struct __tsteal_worker *__w = &__exec->__workers[__i];
+        __st->__executed += __atomic_load_n(&__w->__executed ,__ATOMIC_RELAXED);
+        __st->__stolen += __atomic_load_n(&__w->__stolen ,__ATOMIC_RELAXED);
+        __st->__inlined += __atomic_load_n(&__w->__inlined ,__ATOMIC_RELAXED);
+        __st->__parked += __atomic_load_n(&__w->__parked ,__ATOMIC_RELAXED);
+    }
+    pthread_mutex_lock(&__exec->__inject_lock);
+    __st->__injected = __exec->__injected;
+    pthread_mutex_unlock(&__exec->__inject_lock);
+
+    return 0;
+}
+
+/**
+ * @func   __tsteal_free
+ * @brief  关闭执行器：唤醒全部工作线程，执行完剩余任务后 join，释放资源并将指针置空
+ *
+ * @note
+ *  调用前应已对所有 spawn 过的任务完成 sync；不能在本执行器的工作线程内调用。
+ */
+void __tsteal_free(__tsteal_t **__exec)
+{
+    if(__exec == NULL || (*__exec) == NULL)
+        return;
+
+    __tsteal_t *__p = *__exec;
+    __atomic_store_n(&__p->__stop ,1 ,__ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&__p->__epoch ,1 ,__ATOMIC_SEQ_CST);
+    __tsteal_futex_wake(&__p->__epoch ,INT_MAX);
+
+    for(int __i = 0; __i < __p->__started; __i++)
+    {
+        __thd_t *__pthd = __p->__workers[__i].__pthd;
+        __thread_join(__pthd ,NULL);
+        __thread_attr_destroy(__pthd);
+        __thread_free(&__pthd);
+    }
+
+    pthread_mutex_destroy(&__p->__inject_lock);
+    free(__p->__workers);
+    free(__p);
+
+    (*__exec) = NULL;
+}
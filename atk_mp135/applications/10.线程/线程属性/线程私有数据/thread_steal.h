@@ -0,0 +1,148 @@
+/**
+ * @file    thread_steal.h
+ * @brief   基于 Chase-Lev 双端队列的 work-stealing 执行器接口定义
+ *
+ * @details
+ * 面向 fork-join 类负载（切分缓冲区 → 分段处理 → 合并）：每个工作线程持有一个无锁双端队列，
+ * 自己从底部压入/弹出（LIFO，缓存友好），空闲时随机挑选其他工作线程从顶部窃取（FIFO，大块优先）。
+ * 工作线程全部通过 __thread_init/__thread_create 创建，THREAD_OP_REALTIME 与栈大小设置照常生效。
+ *
+ * 主要内容：
+ *  - __tsteal_task_t ：任务，由调用者分配（通常在递归函数的栈上），sync 返回前不得释放；
+ *  - __tsteal_t      ：执行器本体，含工作线程、各自的双端队列及外部线程的注入队列；
+ *  - spawn/sync      ：工作线程内 spawn 压入自己的队列，sync 在等待期间帮忙执行其他任务；
+ *                      外部线程 spawn 进入注入队列，sync 在 futex 上阻塞。
+ *
+ * 空闲工作线程在执行器的 futex 事件计数上休眠，不自旋；有新任务且存在休眠者时才唤醒一个。
+ *
+ * 使用示例：
+ *   static void sum(void *arg)
+ *   {
+ *       struct range *r = arg;
+ *       if(r->n <= GRAIN) { ... return; }
+ *       struct range lo = { r->p ,r->n / 2 } ,hi = { r->p + r->n / 2 ,r->n - r->n / 2 };
+ *       __tsteal_task_t t;
+ *       __tsteal_task_init(&t ,sum ,&hi);
+ *       __tsteal_spawn(exec ,&t);
+ *       sum(&lo);
+ *       __tsteal_sync(exec ,&t);
+ *       r->s = lo.s + hi.s;
+ *   }
+ */
+#ifndef __THREAD_STEAL_H
+#define __THREAD_STEAL_H
+
+#include "thread.h"
+
+#define TSTEAL_WORKERS_DEFAULT  (4)      ///< 默认工作线程数
+#define TSTEAL_DEQUE_SIZE       (1024)   ///< 每个工作线程双端队列容量（2 的幂），满时 spawn 直接内联执行
+
+/**
+ * @typedef __tsteal_fn_t
+ * @brief   任务函数类型
+ */
+typedef void (*__tsteal_fn_t)(void *__arg);
+
+/**
+ * @enum   tsteal_task_state_t
+ * @brief  任务状态（__state 字段同时作为外部等待者的 futex 字）
+ */
+typedef enum
+{
+    TSTEAL_TASK_PENDING = 0,    ///< 未完成
+    TSTEAL_TASK_DONE    = 1,    ///< 已完成
+    TSTEAL_TASK_WAITED  = 2     ///< 未完成，且有外部线程在 futex 上等待
+}tsteal_task_state_t;
+
+/**
+ * @struct __tsteal_task_struct
+ * @brief  任务
+ */
+struct __tsteal_task_struct
+{
+    __tsteal_fn_t __fn;                     ///< 任务函数
+    void *__arg;                            ///< 任务参数
+    uint32_t __state;                       ///< tsteal_task_state_t
+    struct __tsteal_task_struct *__next;    ///< 注入队列链接（内部使用）
+};
+typedef struct __tsteal_task_struct __tsteal_task_t;
+
+/**
+ * @struct __tsteal_deque
+ * @brief  Chase-Lev 双端队列（内部使用）
+ *
+ * @details
+ * __bottom 只由所属工作线程写，__top 由窃取者 CAS 推进，两者分处不同缓存行。
+ * 容量固定，不做扩容，省去旧数组的回收问题。
+ */
+struct __tsteal_deque
+{
+    int64_t __top __attribute__((aligned(64)));
+    int64_t __bottom __attribute__((aligned(64)));
+    __tsteal_task_t *__buf[TSTEAL_DEQUE_SIZE] __attribute__((aligned(64)));
+};
+
+/**
+ * @struct __tsteal_worker
+ * @brief  工作线程状态（内部使用）
+ */
+struct __tsteal_worker
+{
+    struct __tsteal_deque __dq;             ///< 本线程双端队列
+    __thd_t *__pthd;                        ///< 线程结构体，__data 指回本结构
+    struct __tsteal_struct *__exec;         ///< 所属执行器
+    int __index;                            ///< 工作线程编号
+    uint32_t __rng;                         ///< 随机选择窃取对象用的 xorshift 状态
+
+    uint64_t __executed;                    ///< 执行的任务数
+    uint64_t __stolen;                      ///< 从其他工作线程窃取的任务数
+    uint64_t __inlined;                     ///< 队列满而内联执行的 spawn 数
+    uint64_t __parked;                      ///< futex 休眠次数
+};
+
+/**
+ * @struct __tsteal_stat_t
+ * @brief  执行器计数快照（各工作线程累加，读取时不加锁，仅供观测）
+ */
+typedef struct
+{
+    uint64_t __executed;
+    uint64_t __stolen;
+    uint64_t __inlined;
+    uint64_t __parked;
+    uint64_t __injected;                    ///< 外部线程提交的任务数
+}__tsteal_stat_t;
+
+/**
+ * @struct __tsteal_struct
+ * @brief  work-stealing 执行器（内部使用）
+ */
+struct __tsteal_struct
+{
+    char __name[12];                        ///< 执行器名称，工作线程命名为 "<name>-<i>"
+    int __nworkers;                         ///< 工作线程数
+    int __started;                          ///< 实际创建成功的工作线程数
+    struct __tsteal_worker *__workers;      ///< 工作线程数组（64 字节对齐）
+
+    pthread_mutex_t __inject_lock;          ///< 保护注入队列
+    __tsteal_task_t *__inject_head;         ///< 外部线程提交的任务
+    __tsteal_task_t *__inject_tail;
+    unsigned __inject_count;
+    uint64_t __injected;
+
+    uint32_t __epoch __attribute__((aligned(64)));  ///< 休眠用 futex 事件计数
+    int __nsleep;                           ///< 正在或准备休眠的工作线程数
+    int __stop;                             ///< 退出标志
+};
+typedef struct __tsteal_struct __tsteal_t;
+
+/* 接口函数声明 */
+__tsteal_t *__tsteal_init(const char *__name ,int __nworkers ,const __thd_t *__tmpl);
+void __tsteal_task_init(__tsteal_task_t *__task ,__tsteal_fn_t __fn ,void *__arg);
+int __tsteal_spawn(__tsteal_t *__exec ,__tsteal_task_t *__task);
+int __tsteal_sync(__tsteal_t *__exec ,__tsteal_task_t *__task);
+int __tsteal_run(__tsteal_t *__exec ,__tsteal_fn_t __fn ,void *__arg);
+int __tsteal_stat(__tsteal_t *__exec ,__tsteal_stat_t *__st);
+void __tsteal_free(__tsteal_t **__exec);
+
+#endif /* __THREAD_STEAL_H */
@@ -0,0 +1,516 @@
+/**
+ * @file    thread_topo.c
+ * @brief   CPU 拓扑发现与线程放置策略实现
+ *
+ * @details
+ * 拓扑来源（均相对 TOPO_SYSFS_ROOT）：
+ *  - online                                   ：在线 CPU 列表；
+ *  - isolated                                 ：内核 isolcpus 列表（可能为空）；
+ *  - cpuN/topology/physical_package_id        ：物理封装；
+ *  - cpuN/topology/thread_siblings_list       ：SMT 兄弟，第一个编号作为物理核标识；
+ *  - cpuN/cache/indexK/{level,type,shared_cpu_list}：取级别最高的非指令缓存作为 LLC。
+ * 缺失的文件按单封装、单 LLC、无 SMT 处理，保证在精简内核或容器中也能工作。
+ */
+#include "thread.h"
+
+static __topo_t *__topo = NULL;
+static void __topo_once_init(void);
+static __thd_once_t __topo_once = { .__once_control = PTHREAD_ONCE_INIT ,.__init_routine = __topo_once_init };
+
+/*****************************************************************************************/
+/*                                   内部辅助函数                                         */
+/*****************************************************************************************/
+
+/**
+ * @name    __topo_read
+ * @brief   读取一个 sysfs 小文件到 __buf（以 '\0' 结尾）。
+ *
+ * @return  读到的字节数；文件不存在或读取失败返回 -1。
+ */
+static int __topo_read(const char *__path ,char *__buf ,size_t __size)
+{
+    int __fd = open(__path ,O_RDONLY | O_CLOEXEC);
+    if(__fd == -1)
+        return -1;
+
+    ssize_t __n = read(__fd ,__buf ,__size - 1);
+    close(__fd);
+    if(__n < 0)
+        return -1;
+
+    __buf[__n] = '\0';
+    return (int)__n;
+}
+
+/**
+ * @name    __topo_read_int
+ * @brief   读取 sysfs 整数文件，失败时返回 __def。
+ */
+static int __topo_read_int(const char *__path ,int __def)
+{
+    char __buf[32];
+    if(__topo_read(__path ,__buf ,sizeof(__buf)) <= 0)
+        return __def;
+    return atoi(__buf);
+}
+
+/**
+ * @name    __topo_read_list
+ * @brief   读取 sysfs CPU 列表文件，失败时返回 -1 且 __set 为空。
+ */
+static int __topo_read_list(const char *__path ,cpu_set_t *__set)
+{
+    char __buf[4096];
+    CPU_ZERO(__set);
+    if(__topo_read(__path ,__buf ,sizeof(__buf)) < 0)
+        return -1;
+    return __topo_parse_list(__buf ,__set);
+}
+
+/**
+ * @name    __topo_first
+ * @brief   集合中编号最小的 CPU，空集合返回 -1。
+ */
+static int __topo_first(const cpu_set_t *__set)
+{
+    for(int __i = 0; __i < CPU_SETSIZE; __i++)
+        if(CPU_ISSET(__i ,__set))
+            return __i;
+    return -1;
+}
+
+/**
+ * @name    __topo_llc
+ * @brief   取 CPU 的最后一级缓存域标识（共享该缓存的第一个 CPU），无缓存信息返回 -1。
+ */
+static int __topo_llc(const char *__root ,int __cpu)
+{
+    char __path[256];
+    char __type[32];
+    int __best_level = 0 ,__llc = -1;
+
+    for(int __k = 0; __k < 16; __k++)
+    {
+        snprintf(__path ,sizeof(__path) ,"%s/cpu%d/cache/index%d/type" ,__root ,__cpu ,__k);
+        if(__topo_read(__path ,__type ,sizeof(__type)) <= 0)
+            break;
+        if(strncmp(__type ,"Instruction" ,11) == 0)
+            continue;
+
+        snprintf(__path ,sizeof(__path) ,"%s/cpu%d/cache/index%d/level" ,__root ,__cpu ,__k);
+        int __level = __topo_read_int(__path ,0);
+        if(__level <= __best_level)
+            continue;
+
+        cpu_set_t __shared;
+        snprintf(__path ,sizeof(__path) ,"%s/cpu%d/cache/index%d/shared_cpu_list" ,__root ,__cpu ,__k);
+        if(__topo_read_list(__path ,&__shared) == 0 && CPU_COUNT(&__shared) > 0)
+        {
+            __best_level = __level;
+            __llc = __topo_first(&__shared);
+        }
+    }
+    return __llc;
+}
+
+/* qsort 比较函数使用的拓扑（仅在 __topo_load 中、加载线程内有效） */
+static const struct __topo_cpu *__topo_sort_cpus = NULL;
+static const int *__topo_sort_rank = NULL;
+
+/**
+ * @name    __topo_cmp_compact
+ * @brief   集中顺序：封装 → LLC → 物理核 → SMT 序号。
+ */
+static int __topo_cmp_compact(const void *__a ,const void *__b)
+{
+    const struct __topo_cpu *__x = &__topo_sort_cpus[*(const int *)__a];
+    const struct __topo_cpu *__y = &__topo_sort_cpus[*(const int *)__b];
+
+    if(__x->__pkg != __y->__pkg)    return __x->__pkg - __y->__pkg;
+    if(__x->__llc != __y->__llc)    return __x->__llc - __y->__llc;
+    if(__x->__core != __y->__core)  return __x->__core - __y->__core;
+    if(__x->__smt != __y->__smt)    return __x->__smt - __y->__smt;
+    return __x->__cpu - __y->__cpu;
+}
+
+/**
+ * @name    __topo_cmp_spread
+ * @brief   分散顺序：SMT 序号 → 核在 LLC 内的序号 → LLC，即轮流占用各 LLC 的各物理核。
+ */
+static int __topo_cmp_spread(const void *__a ,const void *__b)
+{
+    int __i = *(const int *)__a ,__j = *(const int *)__b;
+    const struct __topo_cpu *__x = &__topo_sort_cpus[__i];
+    const struct __topo_cpu *__y = &__topo_sort_cpus[__j];
+
+    if(__x->__smt != __y->__smt)                    return __x->__smt - __y->__smt;
+    if(__topo_sort_rank[__i] != __topo_sort_rank[__j]) return __topo_sort_rank[__i] - __topo_sort_rank[__j];
+    if(__x->__llc != __y->__llc)                    return __x->__llc - __y->__llc;
+    return __x->__cpu - __y->__cpu;
+}
+
+/**
+ * @name    __topo_split_rt
+ * @brief   划分 ISOLATE_RT 的实时集合与杂务集合。
+ */
+static void __topo_split_rt(__topo_t *__t ,const char *__root ,int __rt_cores)
+{
+    char __path[256];
+    cpu_set_t __iso;
+
+    cpu_set_t __online ,__both;
+
+    /* isolcpus 中的 CPU 通常不在进程默认亲和性内，因此与在线 CPU 求交，而不是与 __allowed */
+    CPU_ZERO(&__online);
+    for(int __i = 0; __i < __t->__ncpu; __i++)
+        CPU_SET(__t->__cpus[__i].__cpu ,&__online);
+
+    CPU_ZERO(&__t->__rt);
+    snprintf(__path ,sizeof(__path) ,"%s/isolated" ,__root);
+    if(__topo_read_list(__path ,&__iso) == 0)
+        CPU_AND(&__t->__rt ,&__iso ,&__online);
+
+    /* 杂务集合：进程允许的 CPU 去掉实时集合 */
+    CPU_AND(&__both ,&__t->__allowed ,&__t->__rt);
+    CPU_XOR(&__t->__house ,&__t->__allowed ,&__both);
+
+    /* isolcpus 不可用或没有留下杂务 CPU 时，在允许的 CPU 中保留编号最大的 __rt_cores 个物理核 */
+    if(CPU_COUNT(&__t->__rt) == 0 || CPU_COUNT(&__t->__house) == 0)
+    {
+        int __ncore = 0;
+        for(int __i = 0; __i < __t->__ncpu; __i++)
+        {
+            int __new = CPU_ISSET(__t->__cpus[__i].__cpu ,&__t->__allowed);
+            for(int __j = 0; __new && __j < __i; __j++)
+                if(__t->__cpus[__j].__core == __t->__cpus[__i].__core && CPU_ISSET(__t->__cpus[__j].__cpu ,&__t->__allowed))
+                    __new = 0;
+            __ncore += __new;
+        }
+
+        CPU_ZERO(&__t->__rt);
+        if(__rt_cores > __ncore - 1)
+            __rt_cores = __ncore - 1;
+
+        for(int __n = 0; __n < __rt_cores; __n++)
+        {
+            int __core = -1;
+            for(int __i = 0; __i < __t->__ncpu; __i++)
+                if(CPU_ISSET(__t->__cpus[__i].__cpu ,&__t->__allowed) &&
+                   !CPU_ISSET(__t->__cpus[__i].__cpu ,&__t->__rt) && __t->__cpus[__i].__core > __core)
+                    __core = __t->__cpus[__i].__core;
+            for(int __i = 0; __i < __t->__ncpu; __i++)
+                if(__t->__cpus[__i].__core == __core && CPU_ISSET(__t->__cpus[__i].__cpu ,&__t->__allowed))
+                    CPU_SET(__t->__cpus[__i].__cpu ,&__t->__rt);
+        }
+        CPU_XOR(&__t->__house ,&__t->__allowed ,&__t->__rt);
+    }
+}
+
+/**
+ * @name    __topo_next
+ * @brief   从放置顺序 __order 的游标处取下一个进程允许运行的 CPU（__cpus 下标）。
+ *
+ * 拓扑表包含全部在线 CPU，SPREAD/COMPACT 跳过不在 __allowed 中的 CPU（如 isolcpus）。
+ *
+ * @return  __cpus 下标；没有允许的 CPU 返回 -1。
+ */
+static int __topo_next(__topo_t *__t ,const int *__order ,unsigned *__cursor)
+{
+    for(int __n = 0; __n < __t->__ncpu; __n++)
+    {
+        int __idx = __order[__atomic_fetch_add(__cursor ,1 ,__ATOMIC_RELAXED) % (unsigned)__t->__ncpu];
+        if(CPU_ISSET(__t->__cpus[__idx].__cpu ,&__t->__allowed))
+            return __idx;
+    }
+    return -1;
+}
+
+/**
+ * @name    __topo_release
+ * @brief   释放拓扑结构。
+ */
+static void __topo_release(__topo_t *__t)
+{
+    if(__t == NULL)
+        return;
+    free(__t->__cpus);
+    free(__t->__spread);
+    free(__t->__compact);
+    free(__t);
+}
+
+/**
+ * @name    __topo_once_init
+ * @brief   第一次使用时从默认 sysfs 路径加载拓扑。
+ */
+static void __topo_once_init(void)
+{
+    if(__atomic_load_n(&__topo ,__ATOMIC_ACQUIRE) == NULL)
+        __topo_load(TOPO_SYSFS_ROOT ,TOPO_RT_CORES ,NULL);
+}
+
+/*****************************************************************************************/
+/*                                     接口函数                                           */
+/*****************************************************************************************/
+
+/**
+ * @func   __topo_parse_list
+ * @brief  解析内核 CPU 列表格式（如 "0-3,8,10-11"）
+ *
+ * @param[in]  __str  列表字符串，可带结尾换行；空串得到空集合
+ * @param[out] __set  解析结果
+ *
+ * @return 0 成功；-1 参数非法或格式错误。
+ */
+int __topo_parse_list(const char *__str ,cpu_set_t *__set)
+{
+    if(__str == NULL || __set == NULL)
+        return -1;
+
+    CPU_ZERO(__set);
+    const char *__p = __str;
+    while(*__p != '\0' && *__p != '\n')
+    {
+        char *__end;
+        long __lo = strtol(__p ,&__end ,10);
+        if(__end == __p || __lo < 0)
+            return -1;
+
+        long __hi = __lo;
+        __p = __end;
+        if(*__p == '-')
+        {
+            __hi = strtol(__p + 1 ,&__end ,10);
+            if(__end == __p + 1 || __hi < __lo)
+                return -1;
+            __p = __end;
+        }
+        for(long __c = __lo; __c <= __hi && __c < CPU_SETSIZE; __c++)
+            CPU_SET((int)__c ,__set);
+
+        if(*__p == ',')
+            __p++;
+        else if(*__p != '\0' && *__p != '\n')
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @func   __topo_load
+ * @brief  （重新）加载 CPU 拓扑
+ *
+ * @param[in] __root      拓扑根目录，NULL 取 TOPO_SYSFS_ROOT；可指向离线采集的目录树用于验证
+ * @param[in] __rt_cores  无 isolcpus 时为实时线程保留的物理核数
+ * @param[in] __aff       进程允许运行的 CPU，NULL 时默认根目录取 sched_getaffinity()，
+ *                        其它根目录视为允许全部在线 CPU
+ *
+ * @return 0 成功；-1 内存不足、读取在线 CPU 列表失败或没有允许的 CPU（原拓扑保留）。
+ *
+ * @note
+ *  拓扑表覆盖全部在线 CPU；isolcpus 通常不在进程默认亲和性内，实时集合取 isolated ∩ online，
+ *  亲和性只用于得到杂务集合与 SPREAD/COMPACT 可用的 CPU，因此应在任何缩小亲和性的操作之前加载；
+ *  重新加载不是线程安全的，应在创建线程前调用。
+ */
+int __topo_load(const char *__root ,int __rt_cores ,const cpu_set_t *__aff)
+{
+    char __path[256];
+    if(__root == NULL)
+        __root = TOPO_SYSFS_ROOT;
+
+    __topo_t *__t = (__topo_t *)calloc(1 ,sizeof(__topo_t));
+    if(__t == NULL)
+        return -1;
+
+    cpu_set_t __online;
+    snprintf(__path ,sizeof(__path) ,"%s/online" ,__root);
+    if(__topo_read_list(__path ,&__online) != 0 || CPU_COUNT(&__online) == 0)
+    {
+        __topo_release(__t);
+        return -1;
+    }
+    memcpy(&__t->__allowed ,&__online ,sizeof(cpu_set_t));
+    if(__aff != NULL)
+        CPU_AND(&__t->__allowed ,&__t->__allowed ,__aff);
+    else if(strcmp(__root ,TOPO_SYSFS_ROOT) == 0)
+    {
+        cpu_set_t __cur;
+        if(sched_getaffinity(0 ,sizeof(__cur) ,&__cur) == 0)
+            CPU_AND(&__t->__allowed ,&__t->__allowed ,&__cur);
+    }
+    if(CPU_COUNT(&__t->__allowed) == 0)
+    {
+        __topo_release(__t);
+        return -1;
+    }
+
+    /* 拓扑表覆盖全部在线 CPU（含 isolcpus），进程亲和性只用于 __allowed/__house */
+    __t->__ncpu = CPU_COUNT(&__online);
+    __t->__cpus = (struct __topo_cpu *)calloc(__t->__ncpu ,sizeof(struct __topo_cpu));
+    __t->__spread = (int *)calloc(__t->__ncpu ,sizeof(int));
+    __t->__compact = (int *)calloc(__t->__ncpu ,sizeof(int));
+    int *__rank = (int *)calloc(__t->__ncpu ,sizeof(int));
+    if(__t->__cpus == NULL || __t->__spread == NULL || __t->__compact == NULL || __rank == NULL)
+    {
+        free(__rank);
+        __topo_release(__t);
+        return -1;
+    }
+
+    /* 逐个 CPU 读取封装、物理核、SMT 与 LLC */
+    int __n = 0;
+    for(int __c = 0; __c < CPU_SETSIZE && __n < __t->__ncpu; __c++)
+    {
+        if(!CPU_ISSET(__c ,&__online))
+            continue;
+
+        struct __topo_cpu *__cpu = &__t->__cpus[__n++];
+        cpu_set_t __sib;
+
+        __cpu->__cpu = __c;
+        snprintf(__path ,sizeof(__path) ,"%s/cpu%d/topology/physical_package_id" ,__root ,__c);
+        __cpu->__pkg = __topo_read_int(__path ,0);
+
+        snprintf(__path ,sizeof(__path) ,"%s/cpu%d/topology/thread_siblings_list" ,__root ,__c);
+        if(__topo_read_list(__path ,&__sib) != 0 || !CPU_ISSET(__c ,&__sib))
+        {
+            CPU_ZERO(&__sib);
+            CPU_SET(__c ,&__sib);
+        }
+        __cpu->__core = __topo_first(&__sib);
+        for(int __s = 0; __s < __c; __s++)
+            if(CPU_ISSET(__s ,&__sib))
+                __cpu->__smt++;
+
+        __cpu->__llc = __topo_llc(__root ,__c);
+        if(__cpu->__llc < 0)
+            __cpu->__llc = __cpu->__pkg;
+    }
+
+    /* 统计物理核、LLC、封装数，并求每个核在其 LLC 内的序号 */
+    for(int __i = 0; __i < __n; __i++)
+    {
+        const struct __topo_cpu *__x = &__t->__cpus[__i];
+        int __new_core = 1 ,__new_llc = 1 ,__new_pkg = 1;
+        for(int __j = 0; __j < __i; __j++)
+        {
+            const struct __topo_cpu *__y = &__t->__cpus[__j];
+            if(__y->__core == __x->__core)  __new_core = 0;
+            if(__y->__llc == __x->__llc)    __new_llc = 0;
+            if(__y->__pkg == __x->__pkg)    __new_pkg = 0;
+        }
+        __t->__ncore += __new_core;
+        __t->__nllc += __new_llc;
+        __t->__npkg += __new_pkg;
+
+        for(int __j = 0; __j < __n; __j++)
+        {
+            const struct __topo_cpu *__y = &__t->__cpus[__j];
+            if(__y->__llc == __x->__llc && __y->__smt == 0 && __y->__core < __x->__core)
+                __rank[__i]++;
+        }
+        __t->__spread[__i] = __i;
+        __t->__compact[__i] = __i;
+    }
+
+    __topo_sort_cpus = __t->__cpus;
+    __topo_sort_rank = __rank;
+    qsort(__t->__spread ,__n ,sizeof(int) ,__topo_cmp_spread);
+    qsort(__t->__compact ,__n ,sizeof(int) ,__topo_cmp_compact);
+    __topo_sort_cpus = NULL;
+    __topo_sort_rank = NULL;
+    free(__rank);
+
+    __topo_split_rt(__t ,__root ,__rt_cores);
+
+    __topo_t *__old = __atomic_exchange_n(&__topo ,__t ,__ATOMIC_ACQ_REL);
+    __topo_release(__old);
+    return 0;
+}
+
+/**
+ * @func   __topo_get
+ * @brief  获取 CPU 拓扑（首次调用时从 sysfs 加载）
+ *
+ * @return 拓扑指针；加载失败返回 NULL。
+ */
+const __topo_t *__topo_get(void)
+{
+    __thread_once(&__topo_once);
+    return __atomic_load_n(&__topo ,__ATOMIC_ACQUIRE);
+}
+
+/**
+ * @func   __topo_place
+ * @brief  按放置策略为一个新线程计算亲和性掩码
+ *
+ * @param[in]     __policy    thread_place_t
+ * @param[in]     __realtime  非 0 表示该线程使用实时调度（仅 ISOLATE_RT 使用）
+ * @param[in,out] __set       PIN 时为调用者给定的掩码（只做校验），其余策略写入计算结果
+ *
+ * @return
+ *   -  0 ：__set 有效，应设置亲和性；
+ *   -  1 ：无需设置亲和性（ISOLATE_RT 无法划分实时集合，如单核）；
+ *   - -1 ：参数非法、PIN 掩码为空或拓扑加载失败。
+ *
+ * @details
+ *  SPREAD/COMPACT/ISOLATE_RT 的实时线程每次调用取下一个 CPU，依次循环；
+ *  ISOLATE_RT 的非实时线程得到整个杂务集合，由调度器在其中自由均衡。
+ */
+int __topo_place(int __policy ,int __realtime ,cpu_set_t *__set)
+{
+    if(__set == NULL)
+        return -1;
+    if(__policy == THREAD_PLACE_PIN)
+        return (CPU_COUNT(__set) > 0) ? 0 : -1;
+
+    __topo_t *__t = (__topo_t *)__topo_get();
+    if(__t == NULL)
+        return -1;
+
+    int __idx = -1;
+    switch(__policy)
+    {
+        case THREAD_PLACE_SPREAD:
+            __idx = __topo_next(__t ,__t->__spread ,&__t->__next_spread);
+            break;
+
+        case THREAD_PLACE_COMPACT:
+            __idx = __topo_next(__t ,__t->__compact ,&__t->__next_compact);
+            break;
+
+        case THREAD_PLACE_ISOLATE_RT:
+        {
+            int __nrt = CPU_COUNT(&__t->__rt);
+            if(__nrt == 0)
+                return 1;
+            if(!__realtime)
+            {
+                memcpy(__set ,&__t->__house ,sizeof(cpu_set_t));
+                return 0;
+            }
+
+            /* 实时线程按分散顺序依次取实时集合中的 CPU，优先占满各物理核的主线程 */
+            int __k = (int)(__atomic_fetch_add(&__t->__next_rt ,1 ,__ATOMIC_RELAXED) % (unsigned)__nrt);
+            for(int __i = 0; __i < __t->__ncpu; __i++)
+            {
+                int __j = __t->__spread[__i];
+                if(CPU_ISSET(__t->__cpus[__j].__cpu ,&__t->__rt) && __k-- == 0)
+                {
+                    __idx = __j;
+                    break;
+                }
+            }
+            break;
+        }
+
+        default:
+            return -1;
+    }
+
+    if(__idx < 0)
+        return -1;
+    CPU_ZERO(__set);
+    CPU_SET(__t->__cpus[__idx].__cpu ,__set);
+    return 0;
+}
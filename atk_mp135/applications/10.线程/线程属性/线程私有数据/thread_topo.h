@@ -0,0 +1,87 @@
+/**
+ * @file    thread_topo.h
+ * @brief   CPU 拓扑发现与线程放置策略接口定义
+ *
+ * @details
+ * 本模块读取 /sys/devices/system/cpu 下的拓扑信息（在线 CPU、物理封装、物理核、
+ * SMT 兄弟线程、最后一级缓存共享关系、内核隔离 CPU），为 __thread_create 的
+ * THREAD_OP_CPUAFFINITY 选项计算亲和性掩码。
+ *
+ * 放置策略（thread_place_t）：
+ *  - PIN        ：直接使用调用者填写的 __thd_t.__cpuset；
+ *  - SPREAD     ：依次绑定到尽量分散的 CPU（先跨 LLC/封装，再跨物理核，最后才用 SMT 兄弟）；
+ *  - COMPACT    ：依次绑定到尽量集中的 CPU（先用满同一物理核的 SMT 兄弟，再用同一 LLC 的其他核）；
+ *  - ISOLATE_RT ：把 CPU 划分为实时集合与杂务集合。实时线程（THREAD_OP_REALTIME）依次独占
+ *                 实时集合中的 CPU，其余线程（日志、线程池等）只允许运行在杂务集合上。
+ *                 实时集合优先取内核 isolcpus（/sys/devices/system/cpu/isolated），
+ *                 否则保留编号最大的 TOPO_RT_CORES 个物理核（含其全部 SMT 兄弟）。
+ *
+ * @note
+ * - 拓扑只在第一次使用时加载一次（__thread_once），覆盖全部在线 CPU；isolcpus 通常不在进程
+ *   默认亲和性内，实时集合直接取 isolated ∩ online，进程当时的亲和性只决定杂务集合与 SPREAD/COMPACT 可用的 CPU；
+ * - 单核或无法划分实时集合时，ISOLATE_RT 不设置亲和性，线程行为与未启用该选项相同。
+ */
+#ifndef __THREAD_TOPO_H
+#define __THREAD_TOPO_H
+
+#include "file.h"
+#include <sched.h>
+
+#define TOPO_SYSFS_ROOT     ("/sys/devices/system/cpu")  ///< 默认拓扑信息根目录
+#define TOPO_RT_CORES       (1)                          ///< 无 isolcpus 时为实时线程保留的物理核数
+
+/**
+ * @enum   thread_place_t
+ * @brief  THREAD_OP_CPUAFFINITY 的放置策略，写入 __thd_t.__placement
+ */
+typedef enum
+{
+    THREAD_PLACE_PIN        = 0,    ///< 使用 __cpuset 中给定的 CPU
+    THREAD_PLACE_SPREAD     = 1,    ///< 分散：每个线程尽量独占物理核/缓存
+    THREAD_PLACE_COMPACT    = 2,    ///< 集中：线程尽量共享物理核/缓存
+    THREAD_PLACE_ISOLATE_RT = 3     ///< 实时线程与杂务线程分离
+}thread_place_t;
+
+/**
+ * @struct __topo_cpu
+ * @brief  单个逻辑 CPU 的拓扑位置
+ */
+struct __topo_cpu
+{
+    int __cpu;          ///< 逻辑 CPU 编号
+    int __pkg;          ///< 物理封装编号（physical_package_id）
+    int __core;         ///< 物理核编号（全局唯一，取该核第一个 SMT 兄弟的 CPU 编号）
+    int __llc;          ///< 最后一级缓存域编号（取共享该缓存的第一个 CPU 编号）
+    int __smt;          ///< 在所属物理核内的序号，0 为主线程
+};
+
+/**
+ * @struct __topo_t
+ * @brief  CPU 拓扑（内部使用，通过 __topo_get 只读访问）
+ */
+typedef struct
+{
+    int __ncpu;                     ///< 在线逻辑 CPU 数
+    int __ncore;                    ///< 物理核数
+    int __nllc;                     ///< 最后一级缓存域数
+    int __npkg;                     ///< 物理封装数
+    struct __topo_cpu *__cpus;      ///< 按 CPU 编号排列的在线 CPU
+    int *__spread;                  ///< 分散放置顺序（__cpus 下标）
+    int *__compact;                 ///< 集中放置顺序（__cpus 下标）
+
+    cpu_set_t __allowed;            ///< 可用 CPU（在线 ∩ 进程初始亲和性）
+    cpu_set_t __rt;                 ///< ISOLATE_RT 的实时集合，空表示无法隔离
+    cpu_set_t __house;              ///< ISOLATE_RT 的杂务集合
+
+    unsigned __next_spread;         ///< 各策略的分配游标
+    unsigned __next_compact;
+    unsigned __next_rt;
+}__topo_t;
+
+/* 接口函数声明 */
+int __topo_parse_list(const char *__str ,cpu_set_t *__set);
+int __topo_load(const char *__root ,int __rt_cores ,const cpu_set_t *__aff);
+const __topo_t *__topo_get(void);
+int __topo_place(int __policy ,int __realtime ,cpu_set_t *__set);
+
+#endif /* __THREAD_TOPO_H */